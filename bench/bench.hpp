@@ -0,0 +1,225 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/utility/stats.hpp"
+#include <boost/format.hpp>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+namespace bench {
+
+// keeps compiler from dropping computation of value
+template<typename T>
+inline void do_not_optimize(T const& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "g"(&value) : "memory");
+#else
+	static volatile char const* sink;
+	sink = reinterpret_cast<char const volatile*>(&value);
+#endif
+}
+
+struct Config
+{
+	// number of timed samples per benchmark, every sample runs benchmark repeatedly for at least sample_time
+	std::size_t samples = 15;
+	std::chrono::nanoseconds sample_time = std::chrono::milliseconds{ 20 };
+	// only benchmarks which names contain filter are run
+	std::string filter;
+};
+
+struct Statistics
+{
+	double mean;
+	double stddev;
+	double min;
+	double median;
+};
+
+inline Statistics statistics(std::vector<double> values)
+{
+	auto res = Statistics{ 0, 0, 0, 0 };
+	if (values.empty())
+		return res;
+	std::sort(values.begin(), values.end());
+	res.mean = std::accumulate(values.begin(), values.end(), 0.) / values.size();
+	for (auto value : values)
+		res.stddev += (value - res.mean) * (value - res.mean);
+	res.stddev = values.size() > 1 ? std::sqrt(res.stddev / (values.size() - 1)) : 0.;
+	res.min = values.front();
+	res.median = values.size() % 2 != 0 ? values[values.size() / 2] : (values[values.size() / 2 - 1] + values[values.size() / 2]) / 2;
+	return res;
+}
+
+struct Result
+{
+	std::string name;
+	// encoded bytes and values processed by a single iteration
+	std::size_t bytes;
+	std::size_t items;
+	// iterations per sample
+	std::size_t iterations;
+	std::size_t samples;
+	Statistics nanoseconds;
+	Statistics bytes_per_second;
+	Statistics items_per_second;
+	// bobl::stats counters of a single iteration, all zeros unless built with BOBL_ENABLE_STATS
+	bobl::stats::Snapshot stats;
+};
+
+class Suite
+{
+	struct Benchmark
+	{
+		std::string name;
+		std::size_t bytes;
+		std::size_t items;
+		std::function<void()> f;
+	};
+public:
+	// f is a single iteration processing bytes of encoded data holding items values
+	void add(std::string name, std::size_t bytes, std::size_t items, std::function<void()> f)
+	{
+		benchmarks_.push_back(Benchmark{ std::move(name), bytes, items, std::move(f) });
+	}
+
+	std::vector<Result> run(Config const& config) const
+	{
+		auto res = std::vector<Result>{};
+		for (auto const& benchmark : benchmarks_)
+		{
+			if (benchmark.name.find(config.filter) != std::string::npos)
+				res.push_back(run(benchmark, config));
+		}
+		return res;
+	}
+private:
+	static Result run(Benchmark const& benchmark, Config const& config)
+	{
+		using Clock = std::chrono::steady_clock;
+		// warm up and find out how many iterations fill up a sample
+		auto iterations = std::size_t{ 1 };
+		for (;;)
+		{
+			auto start = Clock::now();
+			for (auto i = iterations; i != 0; --i)
+				benchmark.f();
+			auto elapsed = Clock::now() - start;
+			if (elapsed >= config.sample_time)
+				break;
+			iterations = elapsed.count() == 0 ? iterations * 10
+												: (std::max)(iterations + 1, std::size_t(double(iterations) * config.sample_time.count() / elapsed.count() * 1.1));
+		}
+		auto nanoseconds = std::vector<double>{};
+		auto bytes = std::vector<double>{};
+		auto items = std::vector<double>{};
+		for (auto sample = config.samples; sample != 0; --sample)
+		{
+			auto start = Clock::now();
+			for (auto i = iterations; i != 0; --i)
+				benchmark.f();
+			auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+			nanoseconds.push_back(elapsed);
+			bytes.push_back(benchmark.bytes / elapsed * 1e9);
+			items.push_back(benchmark.items / elapsed * 1e9);
+		}
+		// counted apart from timed samples, so instrumentation doesn't skew them any further
+		auto const before = bobl::stats::snapshot();
+		benchmark.f();
+		return Result{ benchmark.name, benchmark.bytes, benchmark.items, iterations, config.samples, statistics(nanoseconds), statistics(bytes), statistics(items), bobl::stats::snapshot() - before };
+	}
+private:
+	std::vector<Benchmark> benchmarks_;
+};
+
+inline void report_text(std::ostream& out, std::vector<Result> const& results)
+{
+	out << boost::format("%-40s %14s %8s %14s %14s") % "benchmark" % "ns/iteration" % "+-%" % "MB/s" % "items/s";
+	if (bobl::stats::enabled)
+		out << boost::format(" %10s %12s %10s %12s %10s") % "allocs" % "alloc bytes" % "exceptions" % "skipped" % "elements";
+	out << '\n';
+	for (auto const& result : results)
+	{
+		out << boost::format("%-40s %14.1f %8.2f %14.2f %14.0f")
+						% result.name
+						% result.nanoseconds.median
+						% (result.nanoseconds.mean != 0 ? 100 * result.nanoseconds.stddev / result.nanoseconds.mean : 0.)
+						% (result.bytes_per_second.median / (1024 * 1024))
+						% result.items_per_second.median;
+		if (bobl::stats::enabled)
+		{
+			out << boost::format(" %10d %12d %10d %12d %10d")
+							% result.stats.allocations
+							% result.stats.allocated_bytes
+							% result.stats.exceptions
+							% result.stats.bytes_skipped
+							% result.stats.elements;
+		}
+		out << '\n';
+	}
+}
+
+namespace details {
+
+inline std::string quoted(std::string const& value)
+{
+	auto res = std::string{ "\"" };
+	for (auto c : value)
+	{
+		if (c == '"' || c == '\\')
+			res += '\\';
+		if (static_cast<unsigned char>(c) < 0x20)
+			res += str(boost::format("\\u%04x") % int(c));
+		else
+			res += c;
+	}
+	return res + '"';
+}
+
+inline std::string json(Statistics const& value)
+{
+	return str(boost::format("{\"mean\": %1$.3f, \"stddev\": %2$.3f, \"min\": %3$.3f, \"median\": %4$.3f}") % value.mean % value.stddev % value.min % value.median);
+}
+
+inline std::string json(bobl::stats::Snapshot const& value)
+{
+	auto res = str(boost::format("{\"allocations\": %1%, \"allocated_bytes\": %2%, \"exceptions\": %3%, \"bytes_scanned\": %4%, \"bytes_skipped\": %5%, \"elements\": %6%, \"types\": {")
+						% value.allocations % value.allocated_bytes % value.exceptions % value.bytes_scanned % value.bytes_skipped % value.elements);
+	for (auto i = value.types.begin(); i != value.types.end(); ++i)
+		res += (i == value.types.begin() ? "" : ", ") + quoted(i->first) + ": " + std::to_string(i->second);
+	return res + "}}";
+}
+
+} /*namespace details*/
+
+// machine readable results, one object per benchmark, suitable for comparing runs
+inline void report_json(std::ostream& out, std::vector<Result> const& results)
+{
+	out << "{\n\t\"benchmarks\": [";
+	for (auto i = results.begin(); i != results.end(); ++i)
+	{
+		out << (i == results.begin() ? "\n" : ",\n")
+			<< "\t\t{\"name\": " << details::quoted(i->name)
+			<< ", \"bytes\": " << i->bytes
+			<< ", \"items\": " << i->items
+			<< ", \"iterations\": " << i->iterations
+			<< ", \"samples\": " << i->samples
+			<< ",\n\t\t \"ns_per_iteration\": " << details::json(i->nanoseconds)
+			<< ",\n\t\t \"bytes_per_second\": " << details::json(i->bytes_per_second)
+			<< ",\n\t\t \"items_per_second\": " << details::json(i->items_per_second);
+		if (bobl::stats::enabled)
+			out << ",\n\t\t \"stats\": " << details::json(i->stats);
+		out << '}';
+	}
+	out << "\n\t]\n}\n";
+}
+
+} /*namespace bench*/
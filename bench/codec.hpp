@@ -0,0 +1,44 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bench.hpp"
+#include "bobl/bson/encode.hpp"
+#include "bobl/bson/decode.hpp"
+#include "bobl/bson/cast.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/cbor/decode.hpp"
+#include "bobl/options.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace bench {
+
+// adds BSON and CBOR encode and decode benchmarks of value holding items values,
+// names are <protocol>/<encode|decode>/<name>
+template<typename T, typename DecodeOptions = bobl::options::None>
+void add_codecs(Suite& suite, std::string const& name, T const& value, std::size_t items)
+{
+	auto const bson = std::make_shared<std::vector<std::uint8_t>>(bobl::bson::encode(value));
+	auto const cbor = std::make_shared<std::vector<std::uint8_t>>(bobl::cbor::encode(value));
+	suite.add("bson/encode/" + name, bson->size(), items, [value]() { do_not_optimize(bobl::bson::encode(value)); });
+	suite.add("bson/decode/" + name, bson->size(), items, [bson]()
+	{
+		auto begin = static_cast<std::uint8_t const*>(bson->data());
+		do_not_optimize(bobl::bson::decode<T, DecodeOptions>(begin, begin + bson->size()));
+	});
+	suite.add("cbor/encode/" + name, cbor->size(), items, [value]() { do_not_optimize(bobl::cbor::encode(value)); });
+	suite.add("cbor/decode/" + name, cbor->size(), items, [cbor]()
+	{
+		auto begin = static_cast<std::uint8_t const*>(cbor->data());
+		do_not_optimize(bobl::cbor::decode<T, DecodeOptions>(begin, begin + cbor->size()));
+	});
+}
+
+// benchmarks registered by types.cpp and documents.cpp
+void add_types(Suite& suite);
+void add_documents(Suite& suite);
+
+} /*namespace bench*/
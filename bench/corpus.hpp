@@ -0,0 +1,187 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/utility/diversion.hpp"
+#include <boost/fusion/include/adapt_struct.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Synthetic corpus of whole documents benchmarks run on. Documents are generated from the fixed seed
+// using only raw std::mt19937_64 output (distributions are implementation specific), so the corpus is the same on every platform.
+namespace bench { namespace corpus {
+
+using TimePoint = std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds>;
+
+enum class Side { Buy, Sell };
+
+struct Fill
+{
+	double price;
+	std::int32_t quantity;
+	std::string venue;
+};
+
+// order book event, small flat document with short array
+struct Order
+{
+	std::int64_t id;
+	std::string symbol;
+	Side side;
+	double price;
+	std::int32_t quantity;
+	diversion::optional<std::string> account;
+	TimePoint time;
+	std::vector<Fill> fills;
+};
+
+struct Address
+{
+	std::string street;
+	std::string city;
+	std::string zip;
+};
+
+// user profile, nested document with strings, uuid and variant
+struct Profile
+{
+	boost::uuids::uuid uid;
+	std::string name;
+	std::string email;
+	std::int32_t age;
+	std::vector<std::string> tags;
+	diversion::variant<std::int32_t, std::string> reference;
+	Address address;
+	std::vector<Address> previous;
+	bool active;
+};
+
+// the whole corpus as a single document
+template<typename T>
+struct Documents
+{
+	std::vector<T> documents;
+};
+
+class Random
+{
+public:
+	explicit Random(std::uint64_t seed) : engine_{ seed } {}
+
+	std::uint64_t next() { return engine_(); }
+	// uniform enough for benchmark data, not exactly uniform
+	std::int64_t range(std::int64_t min, std::int64_t max) { return min + std::int64_t(next() % std::uint64_t(max - min + 1)); }
+	double real(double min, double max) { return min + (max - min) * double(next() >> 11) / double(std::uint64_t{ 1 } << 53); }
+	bool chance(unsigned percent) { return next() % 100 < percent; }
+
+	std::string string(std::size_t min, std::size_t max)
+	{
+		static char const alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 _-.";
+		auto res = std::string(std::size_t(range(std::int64_t(min), std::int64_t(max))), ' ');
+		for (auto& c : res)
+			c = alphabet[next() % (sizeof(alphabet) - 1)];
+		return res;
+	}
+private:
+	std::mt19937_64 engine_;
+};
+
+inline std::vector<Order> orders(std::size_t n, std::uint64_t seed = 0x0b0b1)
+{
+	static char const* const symbols[] = { "AAPL", "MSFT", "GOOG", "AMZN", "TSLA", "NVDA", "BRK.B", "JPM" };
+	static char const* const venues[] = { "XNAS", "XNYS", "BATS", "IEXG" };
+	auto random = Random{ seed };
+	auto res = std::vector<Order>{};
+	res.reserve(n);
+	for (std::size_t i = 0; i != n; ++i)
+	{
+		auto order = Order{};
+		order.id = std::int64_t(1000000 + i);
+		order.symbol = symbols[random.next() % (sizeof(symbols) / sizeof(symbols[0]))];
+		order.side = random.chance(50) ? Side::Buy : Side::Sell;
+		order.price = random.real(1, 1000);
+		order.quantity = std::int32_t(random.range(1, 10000));
+		if (random.chance(30))
+			order.account = random.string(6, 12);
+		order.time = TimePoint{ std::chrono::milliseconds{ 1500000000000 + std::int64_t(i) * 3 } };
+		for (auto fills = random.range(0, 4); fills != 0; --fills)
+			order.fills.push_back(Fill{ random.real(1, 1000), std::int32_t(random.range(1, 500)), venues[random.next() % (sizeof(venues) / sizeof(venues[0]))] });
+		res.push_back(std::move(order));
+	}
+	return res;
+}
+
+inline std::vector<Profile> profiles(std::size_t n, std::uint64_t seed = 0x0b0b2)
+{
+	auto random = Random{ seed };
+	auto address = [&random]() { return Address{ random.string(10, 30), random.string(4, 16), random.string(5, 5) }; };
+	auto res = std::vector<Profile>{};
+	res.reserve(n);
+	for (std::size_t i = 0; i != n; ++i)
+	{
+		auto profile = Profile{};
+		for (auto& byte : profile.uid)
+			byte = std::uint8_t(random.next());
+		profile.name = random.string(5, 24);
+		profile.email = random.string(5, 16) + '@' + random.string(4, 10) + ".com";
+		profile.age = std::int32_t(random.range(18, 90));
+		for (auto tags = random.range(0, 8); tags != 0; --tags)
+			profile.tags.push_back(random.string(3, 12));
+		if (random.chance(50))
+			profile.reference = std::int32_t(random.range(0, 1 << 30));
+		else
+			profile.reference = random.string(8, 20);
+		profile.address = address();
+		for (auto previous = random.range(0, 3); previous != 0; --previous)
+			profile.previous.push_back(address());
+		profile.active = random.chance(80);
+		res.push_back(std::move(profile));
+	}
+	return res;
+}
+
+} /*namespace corpus*/ } /*namespace bench*/
+
+BOOST_FUSION_ADAPT_TPL_STRUCT(
+	(T),
+	(bench::corpus::Documents)(T),
+	documents)
+
+BOOST_FUSION_ADAPT_STRUCT(
+	bench::corpus::Fill,
+	price,
+	quantity,
+	venue)
+
+BOOST_FUSION_ADAPT_STRUCT(
+	bench::corpus::Order,
+	id,
+	symbol,
+	side,
+	price,
+	quantity,
+	account,
+	time,
+	fills)
+
+BOOST_FUSION_ADAPT_STRUCT(
+	bench::corpus::Address,
+	street,
+	city,
+	zip)
+
+BOOST_FUSION_ADAPT_STRUCT(
+	bench::corpus::Profile,
+	uid,
+	name,
+	email,
+	age,
+	tags,
+	reference,
+	address,
+	previous,
+	active)
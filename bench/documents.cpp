@@ -0,0 +1,57 @@
+#include "codec.hpp"
+#include "corpus.hpp"
+#include "bobl/bson/stream.hpp"
+#include "bobl/cbor/sequence.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace {
+
+std::size_t const N = 1000;
+
+// documents one by one, as they are sent and received as messages, and as back to back stream
+template<typename Document>
+void add(bench::Suite& suite, std::string const& name, std::vector<Document> const& documents)
+{
+	auto const bson = std::make_shared<std::vector<std::uint8_t>>();
+	auto const cbor = std::make_shared<std::vector<std::uint8_t>>();
+	for (auto const& document : documents)
+	{
+		bobl::bson::encode(std::back_inserter(*bson), document);
+		bobl::cbor::encode(std::back_inserter(*cbor), document);
+	}
+	suite.add("bson/encode/" + name, bson->size(), documents.size(), [documents]()
+	{
+		for (auto const& document : documents)
+			bench::do_not_optimize(bobl::bson::encode(document));
+	});
+	suite.add("bson/decode/" + name, bson->size(), documents.size(), [bson]()
+	{
+		auto stream = bobl::bson::DocumentStream{ bson->data(), bson->data() + bson->size(), false };
+		while (auto document = stream.next())
+			bench::do_not_optimize(bobl::bson::cast<Document>(*document));
+	});
+	suite.add("cbor/encode/" + name, cbor->size(), documents.size(), [documents]()
+	{
+		for (auto const& document : documents)
+			bench::do_not_optimize(bobl::cbor::encode(document));
+	});
+	suite.add("cbor/decode/" + name, cbor->size(), documents.size(), [cbor]()
+	{
+		auto reader = bobl::cbor::SequenceReader<>{ cbor->data(), cbor->data() + cbor->size(), false };
+		while (auto document = reader.next<Document>())
+			bench::do_not_optimize(*document);
+	});
+	// the whole corpus as a single array document
+	bench::add_codecs(suite, name + "/array", bench::corpus::Documents<Document>{ documents }, documents.size());
+}
+
+} /*namespace*/
+
+void bench::add_documents(Suite& suite)
+{
+	add(suite, "documents/orders", bench::corpus::orders(N));
+	add(suite, "documents/profiles", bench::corpus::profiles(N));
+}
@@ -0,0 +1,545 @@
+// Generates synthetic BSON, CBOR and JSON corpora of documents shaped by a profile along with
+// Boost.Fusion adapted structures the documents can be decoded into.
+//	corpus --preset market --documents 10000 --out orders
+// produces orders.bson (back to back documents), orders.cbor (CBOR sequence), orders.json (JSON Lines) and orders.hpp
+#include "corpus.hpp"
+#include "bobl/transcode.hpp"
+#include "bobl/utility/diversion.hpp"
+#include <boost/format.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+
+struct Range
+{
+	std::int64_t min;
+	std::int64_t max;
+};
+
+// shape of generated documents, every document follows the same randomly generated schema
+struct Profile
+{
+	std::uint64_t seed = 1;
+	std::size_t documents = 1000;
+	std::string name = "Document";
+	// maximal nesting of structures
+	std::size_t depth = 2;
+	// members per structure
+	Range fanout = { 4, 12 };
+	Range key_length = { 3, 16 };
+	Range string_length = { 0, 64 };
+	Range array_size = { 0, 16 };
+	// values of 32 and 64 bits integer members and floating point members
+	Range integers = { -1000000, 1000000 };
+	Range big_integers = { -(std::int64_t{ 1 } << 60), std::int64_t{ 1 } << 60 };
+	Range doubles = { -1000000, 1000000 };
+	// percentage of members which are optional, and probability optional value is present
+	std::int64_t optional_ratio = 20;
+	std::int64_t optional_presence = 50;
+	// percentage of members which are variants and types they are made of
+	std::int64_t variant_ratio = 10;
+	std::string variant_types = "int32,double,string";
+	// percentage of members which are arrays and structures, the rest are scalars
+	std::int64_t array_ratio = 15;
+	std::int64_t struct_ratio = 15;
+};
+
+Range range(std::string const& value)
+{
+	auto separator = value.find(':');
+	if (separator == std::string::npos)
+		return Range{ std::stoll(value), std::stoll(value) };
+	auto res = Range{ std::stoll(value.substr(0, separator)), std::stoll(value.substr(separator + 1)) };
+	if (res.min > res.max)
+		throw std::invalid_argument{ "invalid range " + value };
+	return res;
+}
+
+void set(Profile& profile, std::string const& key, std::string const& value)
+{
+	if (key == "seed") profile.seed = std::stoull(value);
+	else if (key == "documents") profile.documents = std::stoul(value);
+	else if (key == "name") profile.name = value;
+	else if (key == "depth") profile.depth = std::stoul(value);
+	else if (key == "fanout") profile.fanout = range(value);
+	else if (key == "key-length") profile.key_length = range(value);
+	else if (key == "string-length") profile.string_length = range(value);
+	else if (key == "array-size") profile.array_size = range(value);
+	else if (key == "integers") profile.integers = range(value);
+	else if (key == "big-integers") profile.big_integers = range(value);
+	else if (key == "doubles") profile.doubles = range(value);
+	else if (key == "optional-ratio") profile.optional_ratio = std::stoll(value);
+	else if (key == "optional-presence") profile.optional_presence = std::stoll(value);
+	else if (key == "variant-ratio") profile.variant_ratio = std::stoll(value);
+	else if (key == "variant-types") profile.variant_types = value;
+	else if (key == "array-ratio") profile.array_ratio = std::stoll(value);
+	else if (key == "struct-ratio") profile.struct_ratio = std::stoll(value);
+	else
+		throw std::invalid_argument{ "unknown profile parameter " + key };
+}
+
+// profile file has a key = value pair per line, # starts a comment
+void load(Profile& profile, std::string const& filename)
+{
+	std::ifstream in{ filename };
+	if (!in)
+		throw std::runtime_error{ "can't open " + filename };
+	for (auto line = std::string{}; std::getline(in, line);)
+	{
+		line = line.substr(0, line.find('#'));
+		auto separator = line.find('=');
+		if (separator == std::string::npos)
+		{
+			if (line.find_first_not_of(" \t\r") != std::string::npos)
+				throw std::invalid_argument{ "invalid profile line : " + line };
+			continue;
+		}
+		auto trim = [](std::string value)
+		{
+			auto begin = value.find_first_not_of(" \t\r");
+			return begin == std::string::npos ? std::string{} : value.substr(begin, value.find_last_not_of(" \t\r") - begin + 1);
+		};
+		set(profile, trim(line.substr(0, separator)), trim(line.substr(separator + 1)));
+	}
+}
+
+void preset(Profile& profile, std::string const& name)
+{
+	if (name == "market")
+	{
+		// small flat messages
+		profile.depth = 1;
+		profile.fanout = { 6, 12 };
+		profile.key_length = { 2, 8 };
+		profile.string_length = { 2, 8 };
+		profile.array_size = { 0, 4 };
+		profile.array_ratio = 5;
+		profile.struct_ratio = 5;
+		profile.variant_ratio = 0;
+	}
+	else if (name == "document")
+	{
+		// nested documents with long strings
+		profile.depth = 3;
+		profile.fanout = { 3, 10 };
+		profile.key_length = { 4, 20 };
+		profile.string_length = { 0, 256 };
+		profile.array_size = { 0, 8 };
+	}
+	else if (name == "wide")
+	{
+		profile.depth = 1;
+		profile.fanout = { 50, 200 };
+		profile.optional_ratio = 50;
+	}
+	else if (name != "default")
+		throw std::invalid_argument{ "unknown preset " + name };
+}
+
+enum class Kind { Bool, Int32, Int64, Double, String, Uuid, TimePoint, Array, Optional, Variant, Struct };
+
+struct Node
+{
+	Kind kind;
+	// element of Array and Optional, alternatives of Variant
+	std::vector<std::size_t> elements;
+	// Struct members
+	std::vector<std::pair<std::string, std::size_t>> members;
+	std::string type_name;
+};
+
+bool keyword(std::string const& name)
+{
+	static std::set<std::string> const keywords = {
+		"alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch", "char", "class",
+		"compl", "const", "constexpr", "const_cast", "continue", "decltype", "default", "delete", "do", "double", "dynamic_cast",
+		"else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline", "int", "long",
+		"mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or", "or_eq", "private", "protected",
+		"public", "register", "reinterpret_cast", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast",
+		"struct", "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef", "typeid", "typename", "union",
+		"unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq" };
+	return keywords.count(name) != 0;
+}
+
+class Schema
+{
+public:
+	Schema(Profile const& profile, bench::corpus::Random& random) : profile_( profile ), random_( random )
+	{
+		std::istringstream types{ profile.variant_types };
+		for (auto type = std::string{}; std::getline(types, type, ',');)
+		{
+			static std::map<std::string, Kind> const kinds = { { "bool", Kind::Bool }, { "int32", Kind::Int32 }, { "double", Kind::Double }, { "string", Kind::String } };
+			auto kind = kinds.find(type);
+			if (kind == kinds.end())
+				throw std::invalid_argument{ "unsupported variant type " + type };
+			variant_.push_back(kind->second);
+		}
+		// alternatives are probed in order, so more specific types go first
+		std::sort(variant_.begin(), variant_.end(), [](Kind x, Kind y) { return order(x) < order(y); });
+		variant_.erase(std::unique(variant_.begin(), variant_.end()), variant_.end());
+		root_ = structure(profile.depth);
+		nodes_[root_].type_name = profile.name;
+	}
+
+	Node const& node(std::size_t i) const { return nodes_[i]; }
+	std::size_t root() const { return root_; }
+
+	std::string cpp_type(std::size_t i) const
+	{
+		auto const& node = nodes_[i];
+		switch (node.kind)
+		{
+			case Kind::Bool: return "bool";
+			case Kind::Int32: return "std::int32_t";
+			case Kind::Int64: return "std::int64_t";
+			case Kind::Double: return "double";
+			case Kind::String: return "std::string";
+			case Kind::Uuid: return "boost::uuids::uuid";
+			case Kind::TimePoint: return "std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds>";
+			case Kind::Array: return "std::vector<" + cpp_type(node.elements.front()) + '>';
+			case Kind::Optional: return "diversion::optional<" + cpp_type(node.elements.front()) + '>';
+			case Kind::Variant:
+			{
+				auto res = std::string{ "diversion::variant<" };
+				for (auto element : node.elements)
+					res += (element == node.elements.front() ? "" : ", ") + cpp_type(element);
+				return res + '>';
+			}
+			case Kind::Struct: return node.type_name;
+		}
+		return {};
+	}
+
+	// structures in order they can be declared, members before structures containing them
+	void structures(std::size_t i, std::vector<std::size_t>& res) const
+	{
+		auto const& node = nodes_[i];
+		for (auto element : node.elements)
+			structures(element, res);
+		for (auto const& member : node.members)
+			structures(member.second, res);
+		if (node.kind == Kind::Struct)
+			res.push_back(i);
+	}
+private:
+	static int order(Kind kind) { return kind == Kind::Bool ? 0 : kind == Kind::Int32 ? 1 : kind == Kind::Double ? 2 : 3; }
+
+	std::size_t add(Node node)
+	{
+		nodes_.push_back(std::move(node));
+		return nodes_.size() - 1;
+	}
+
+	std::size_t scalar()
+	{
+		static Kind const kinds[] = { Kind::Bool, Kind::Int32, Kind::Int32, Kind::Int64, Kind::Double, Kind::Double, Kind::String, Kind::String, Kind::String, Kind::Uuid, Kind::TimePoint };
+		return add(Node{ kinds[random_.next() % (sizeof(kinds) / sizeof(kinds[0]))], {}, {}, {} });
+	}
+
+	std::size_t structure(std::size_t depth)
+	{
+		auto res = add(Node{ Kind::Struct, {}, {}, str(boost::format("struct_%1%") % nodes_.size()) });
+		auto names = std::set<std::string>{};
+		for (auto n = random_.range(profile_.fanout.min, profile_.fanout.max); n > 0; --n)
+		{
+			auto name = std::string{};
+			do
+			{
+				name = key();
+			} while (names.count(name) != 0 || keyword(name));
+			names.insert(name);
+			auto member = this->member(depth);
+			nodes_[res].members.emplace_back(name, member);
+		}
+		return res;
+	}
+
+	std::size_t member(std::size_t depth)
+	{
+		auto dice = random_.range(0, 99);
+		if ((dice -= profile_.struct_ratio) < 0 && depth > 1)
+			return structure(depth - 1);
+		if ((dice -= profile_.array_ratio) < 0)
+		{
+			// std::vector<bool> isn't supported
+			auto element = depth > 1 && random_.chance(30) ? structure(depth - 1) : scalar();
+			while (nodes_[element].kind == Kind::Bool)
+				nodes_[element].kind = Kind::Int32;
+			return add(Node{ Kind::Array, { element }, {}, {} });
+		}
+		if ((dice -= profile_.variant_ratio) < 0 && variant_.size() > 1)
+		{
+			auto res = add(Node{ Kind::Variant, {}, {}, {} });
+			for (auto kind : variant_)
+			{
+				auto alternative = add(Node{ kind, {}, {}, {} });
+				nodes_[res].elements.push_back(alternative);
+			}
+			return res;
+		}
+		if ((dice -= profile_.optional_ratio) < 0)
+		{
+			auto value = depth > 1 && random_.chance(20) ? structure(depth - 1) : scalar();
+			return add(Node{ Kind::Optional, { value }, {}, {} });
+		}
+		return scalar();
+	}
+
+	std::string key()
+	{
+		static char const first[] = "abcdefghijklmnopqrstuvwxyz";
+		static char const rest[] = "abcdefghijklmnopqrstuvwxyz0123456789_";
+		auto res = std::string(std::size_t((std::max)(std::int64_t{ 1 }, random_.range(profile_.key_length.min, profile_.key_length.max))), 'a');
+		res[0] = first[random_.next() % (sizeof(first) - 1)];
+		for (std::size_t i = 1; i < res.size(); ++i)
+			res[i] = rest[random_.next() % (sizeof(rest) - 1)];
+		return res;
+	}
+private:
+	Profile const& profile_;
+	bench::corpus::Random& random_;
+	std::vector<Kind> variant_;
+	std::vector<Node> nodes_;
+	std::size_t root_;
+};
+
+struct Corpora
+{
+	std::vector<std::uint8_t> bson;
+	std::vector<std::uint8_t> cbor;
+	std::string json;
+};
+
+// passes every event to BSON, CBOR and JSON writers, so all the corpora hold the same documents
+class Writers
+{
+public:
+	explicit Writers(Corpora& corpora) : bson_{ corpora.bson }, cbor_{ corpora.cbor }, json_{ corpora.json } {}
+
+	void boolean(bool value) { bson_.boolean(value); cbor_.boolean(value); json_.boolean(value); }
+	void integer(std::int64_t value) { bson_.integer(value); cbor_.integer(value); json_.integer(value); }
+	void floating_point(double value) { bson_.floating_point(value); cbor_.floating_point(value); json_.floating_point(value); }
+	void string(diversion::string_view value) { bson_.string(value); cbor_.string(value); json_.string(value); }
+	void uuid(std::uint8_t const* data) { bson_.uuid(data); cbor_.uuid(data); json_.uuid(data); }
+	void time_point(std::int64_t milliseconds) { bson_.time_point(milliseconds); cbor_.time_point(milliseconds); json_.time_point(milliseconds); }
+	void begin_array(std::size_t size) { bson_.begin_array(size); cbor_.begin_array(size); json_.begin_array(size); }
+	void end_array() { bson_.end_array(); cbor_.end_array(); json_.end_array(); }
+	void begin_object(std::size_t size) { bson_.begin_object(size); cbor_.begin_object(size); json_.begin_object(size); }
+	void name(diversion::string_view name) { bson_.name(name); cbor_.name(name); json_.name(name); }
+	void end_object() { bson_.end_object(); cbor_.end_object(); json_.end_object(); }
+private:
+	bobl::transcoder::Writer<bobl::bson::NsTag, std::vector<std::uint8_t>> bson_;
+	bobl::transcoder::Writer<bobl::cbor::NsTag, std::vector<std::uint8_t>> cbor_;
+	bobl::transcoder::Writer<bobl::json::NsTag, std::string> json_;
+};
+
+class Generator
+{
+public:
+	Generator(Profile const& profile, Schema const& schema, bench::corpus::Random& random) : profile_( profile ), schema_( schema ), random_( random ) {}
+
+	void document(Corpora& corpora)
+	{
+		auto writers = Writers{ corpora };
+		value(schema_.root(), writers);
+		corpora.json += '\n';
+	}
+private:
+	void value(std::size_t i, Writers& writers)
+	{
+		auto const& node = schema_.node(i);
+		switch (node.kind)
+		{
+			case Kind::Bool:
+				writers.boolean(random_.chance(50));
+				break;
+			case Kind::Int32:
+				writers.integer(clamp(random_.range(profile_.integers.min, profile_.integers.max), INT32_MIN, INT32_MAX));
+				break;
+			case Kind::Int64:
+				writers.integer(random_.range(profile_.big_integers.min, profile_.big_integers.max));
+				break;
+			case Kind::Double:
+				writers.floating_point(random_.real(double(profile_.doubles.min), double(profile_.doubles.max)));
+				break;
+			case Kind::String:
+				writers.string(random_.string(std::size_t((std::max)(std::int64_t{ 0 }, profile_.string_length.min)), std::size_t((std::max)(std::int64_t{ 0 }, profile_.string_length.max))));
+				break;
+			case Kind::Uuid:
+			{
+				std::uint8_t uuid[16];
+				for (auto& byte : uuid)
+					byte = std::uint8_t(random_.next());
+				writers.uuid(uuid);
+				break;
+			}
+			case Kind::TimePoint:
+				writers.time_point(1500000000000 + random_.range(0, std::int64_t{ 1 } << 36));
+				break;
+			case Kind::Array:
+			{
+				auto size = std::size_t((std::max)(std::int64_t{ 0 }, random_.range(profile_.array_size.min, profile_.array_size.max)));
+				writers.begin_array(size);
+				for (auto n = size; n != 0; --n)
+					value(node.elements.front(), writers);
+				writers.end_array();
+				break;
+			}
+			case Kind::Optional:
+				value(node.elements.front(), writers);
+				break;
+			case Kind::Variant:
+				value(node.elements[random_.next() % node.elements.size()], writers);
+				break;
+			case Kind::Struct:
+			{
+				// absent optionals are skipped, as bobl encodes them by default
+				auto present = std::vector<bool>{};
+				for (auto const& member : node.members)
+					present.push_back(schema_.node(member.second).kind != Kind::Optional || random_.chance(unsigned(profile_.optional_presence)));
+				writers.begin_object(std::size_t(std::count(present.begin(), present.end(), true)));
+				for (std::size_t m = 0; m != node.members.size(); ++m)
+				{
+					if (!present[m])
+						continue;
+					writers.name(node.members[m].first);
+					value(node.members[m].second, writers);
+				}
+				writers.end_object();
+				break;
+			}
+		}
+	}
+
+	static std::int64_t clamp(std::int64_t value, std::int64_t min, std::int64_t max) { return (std::min)((std::max)(value, min), max); }
+private:
+	Profile const& profile_;
+	Schema const& schema_;
+	bench::corpus::Random& random_;
+};
+
+void header(std::ostream& out, Profile const& profile, Schema const& schema)
+{
+	auto structures = std::vector<std::size_t>{};
+	schema.structures(schema.root(), structures);
+	out << "// generated by bobl corpus generator (seed " << profile.seed << ")\n"
+			"#pragma once\n"
+			"#include \"bobl/utility/diversion.hpp\"\n"
+			"#include \"bobl/options.hpp\"\n"
+			"#include <boost/fusion/include/adapt_struct.hpp>\n"
+			"#include <boost/uuid/uuid.hpp>\n"
+			"#include <chrono>\n"
+			"#include <string>\n"
+			"#include <vector>\n"
+			"#include <cstdint>\n\n"
+			"// corpora are encoded as compact as possible (e.g. integers and floats take the least space their values fit in)\n"
+			"using " << profile.name << "DecodeOptions = bobl::Options<bobl::options::RelaxedIntegers, bobl::options::RelaxedFloats>;\n";
+	for (auto i : structures)
+	{
+		auto const& node = schema.node(i);
+		out << "\nstruct " << node.type_name << "\n{\n";
+		for (auto const& member : node.members)
+			out << '\t' << schema.cpp_type(member.second) << ' ' << member.first << ";\n";
+		out << "};\n";
+	}
+	for (auto i : structures)
+	{
+		auto const& node = schema.node(i);
+		// variadic form is limited to 64 arguments, wide structures need (auto, member) sequence
+		auto const wide = node.members.size() >= 64;
+		out << "\nBOOST_FUSION_ADAPT_STRUCT(\n\t" << node.type_name << (wide ? ",\n\t" : "");
+		for (auto const& member : node.members)
+			out << (wide ? "(BOOST_FUSION_ADAPT_AUTO, " + member.first + ')' : ",\n\t" + member.first);
+		out << ")\n";
+	}
+}
+
+void write(std::string const& filename, char const* data, std::size_t size)
+{
+	std::ofstream out{ filename, std::ios::binary };
+	out.write(data, std::streamsize(size));
+	if (!out)
+		throw std::runtime_error{ "can't write " + filename };
+}
+
+void usage()
+{
+	std::cout << "corpus [options] [parameter=value...]\n"
+				"  --out <prefix>     output files prefix (corpus): <prefix>.bson, <prefix>.cbor, <prefix>.json, <prefix>.hpp\n"
+				"  --preset <name>    default, market, document or wide\n"
+				"  --profile <file>   profile file, parameter = value per line\n"
+				"  --documents <n>    number of documents\n"
+				"  --seed <n>         random seed\n"
+				"parameters: seed, documents, name, depth, fanout, key-length, string-length, array-size, integers, big-integers, doubles,\n"
+				"            optional-ratio, optional-presence, variant-ratio, variant-types, array-ratio, struct-ratio\n"
+				"ranges are given as min:max, ratios in percents, variant-types as comma separated list of bool, int32, double, string\n";
+}
+
+} /*namespace*/
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		auto profile = Profile{};
+		auto out = std::string{ "corpus" };
+		for (auto i = 1; i < argc; ++i)
+		{
+			auto const arg = std::string{ argv[i] };
+			auto value = [&]() -> std::string
+			{
+				if (++i == argc)
+					throw std::invalid_argument{ arg + " requires value" };
+				return argv[i];
+			};
+			if (arg == "--out")
+				out = value();
+			else if (arg == "--preset")
+				preset(profile, value());
+			else if (arg == "--profile")
+				load(profile, value());
+			else if (arg == "--documents" || arg == "--seed")
+				set(profile, arg.substr(2), value());
+			else if (arg.find('=') != std::string::npos && arg.compare(0, 2, "--") != 0)
+				set(profile, arg.substr(0, arg.find('=')), arg.substr(arg.find('=') + 1));
+			else
+			{
+				usage();
+				return arg == "--help" || arg == "-h" ? EXIT_SUCCESS : EXIT_FAILURE;
+			}
+		}
+
+		auto random = bench::corpus::Random{ profile.seed };
+		auto const schema = Schema{ profile, random };
+		auto generator = Generator{ profile, schema, random };
+		auto corpora = Corpora{};
+		for (auto n = profile.documents; n != 0; --n)
+			generator.document(corpora);
+		write(out + ".bson", reinterpret_cast<char const*>(corpora.bson.data()), corpora.bson.size());
+		write(out + ".cbor", reinterpret_cast<char const*>(corpora.cbor.data()), corpora.cbor.size());
+		write(out + ".json", corpora.json.data(), corpora.json.size());
+		std::ofstream hpp{ out + ".hpp" };
+		header(hpp, profile, schema);
+		if (!hpp)
+			throw std::runtime_error{ "can't write " + out + ".hpp" };
+		std::cout << boost::format("%1% documents : %2% bytes BSON, %3% bytes CBOR, %4% bytes JSON\n") % profile.documents % corpora.bson.size() % corpora.cbor.size() % corpora.json.size();
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << "error : " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include "bench.hpp"
+#include "codec.hpp"
+#include "bobl/utility/profile.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <cstdlib>
+
+// counts heap allocations when built with BOBL_ENABLE_STATS (bench_stats target)
+BOBL_STATS_COUNT_ALLOCATIONS()
+
+namespace {
+
+void usage()
+{
+	std::cout << "bench [options]\n"
+				"  --filter <text>     run only benchmarks which names contain text\n"
+				"  --samples <n>       timed samples per benchmark (15)\n"
+				"  --sample-time <ms>  minimal duration of a sample (20)\n"
+				"  --json <file>       write results as JSON to file, - for stdout\n"
+				"  --list              list benchmarks\n";
+}
+
+} /*namespace*/
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		auto config = bench::Config{};
+		auto json = std::string{};
+		auto list = false;
+		for (auto i = 1; i < argc; ++i)
+		{
+			auto const arg = std::string{ argv[i] };
+			auto value = [&]() -> std::string
+			{
+				if (++i == argc)
+					throw std::invalid_argument{ arg + " requires value" };
+				return argv[i];
+			};
+			if (arg == "--filter")
+				config.filter = value();
+			else if (arg == "--samples")
+				config.samples = std::stoul(value());
+			else if (arg == "--sample-time")
+				config.sample_time = std::chrono::milliseconds{ std::stoul(value()) };
+			else if (arg == "--json")
+				json = value();
+			else if (arg == "--list")
+				list = true;
+			else
+			{
+				usage();
+				return arg == "--help" || arg == "-h" ? EXIT_SUCCESS : EXIT_FAILURE;
+			}
+		}
+
+		auto suite = bench::Suite{};
+		bench::add_types(suite);
+		bench::add_documents(suite);
+		if (list)
+		{
+			config.samples = 0;
+			config.sample_time = std::chrono::nanoseconds{ 0 };
+			for (auto const& result : suite.run(config))
+				std::cout << result.name << '\n';
+			return EXIT_SUCCESS;
+		}
+		auto results = suite.run(config);
+		if (json == "-")
+		{
+			bench::report_json(std::cout, results);
+			return EXIT_SUCCESS;
+		}
+		bench::report_text(std::cout, results);
+		if (bobl::profile::enabled)
+		{
+			std::cout << '\n';
+			bobl::profile::report_text(std::cout, bobl::profile::snapshot());
+		}
+		if (!json.empty())
+		{
+			std::ofstream out{ json };
+			bench::report_json(out, results);
+			if (!out)
+				throw std::runtime_error{ "can't write " + json };
+		}
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << "error : " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
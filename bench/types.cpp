@@ -0,0 +1,137 @@
+#include "codec.hpp"
+#include "corpus.hpp"
+#include "bobl/utility/diversion.hpp"
+#include <boost/fusion/include/adapt_struct.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace {
+
+template<typename T>
+struct Values
+{
+	std::vector<T> values;
+};
+
+struct Point
+{
+	std::int32_t x;
+	double y;
+	std::string tag;
+};
+
+struct Nested
+{
+	std::int64_t id;
+	Point point;
+	std::vector<std::int32_t> ids;
+};
+
+struct Optionals
+{
+	diversion::optional<std::int32_t> first;
+	diversion::optional<std::string> second;
+	std::int32_t last;
+};
+
+} /*namespace*/
+
+BOOST_FUSION_ADAPT_TPL_STRUCT(
+	(T),
+	(Values)(T),
+	values)
+
+BOOST_FUSION_ADAPT_STRUCT(
+	Point,
+	x,
+	y,
+	tag)
+
+BOOST_FUSION_ADAPT_STRUCT(
+	Nested,
+	id,
+	point,
+	ids)
+
+BOOST_FUSION_ADAPT_STRUCT(
+	Optionals,
+	first,
+	second,
+	last)
+
+namespace {
+
+std::size_t const N = 1000;
+
+template<typename T, typename Generator>
+void add(bench::Suite& suite, std::string const& name, Generator generator)
+{
+	auto value = Values<T>{};
+	value.values.reserve(N);
+	auto random = bench::corpus::Random{ 42 };
+	for (std::size_t i = 0; i != N; ++i)
+		value.values.push_back(generator(random, i));
+	bench::add_codecs(suite, name, value, N);
+}
+
+} /*namespace*/
+
+// every benchmark processes an array of N values of the type
+void bench::add_types(Suite& suite)
+{
+	using bench::corpus::Random;
+	add<std::int32_t>(suite, "ints/int32", [](Random& random, std::size_t) { return std::int32_t(random.next()); });
+	add<std::int64_t>(suite, "ints/int64", [](Random& random, std::size_t) { return std::int64_t(random.next()); });
+	add<std::int32_t>(suite, "ints/small", [](Random& random, std::size_t) { return std::int32_t(random.range(0, 23)); });
+	add<double>(suite, "floats/double", [](Random& random, std::size_t) { return random.real(-1e6, 1e6); });
+	add<std::string>(suite, "strings/short", [](Random& random, std::size_t) { return random.string(4, 16); });
+	add<std::string>(suite, "strings/long", [](Random& random, std::size_t) { return random.string(200, 1000); });
+	add<std::vector<std::int32_t>>(suite, "vectors/int32x8", [](Random& random, std::size_t)
+	{
+		auto res = std::vector<std::int32_t>(8);
+		for (auto& i : res)
+			i = std::int32_t(random.range(0, 1 << 20));
+		return res;
+	});
+	add<Nested>(suite, "structs/nested", [](Random& random, std::size_t i)
+	{
+		return Nested{ std::int64_t(i), Point{ std::int32_t(random.range(-100, 100)), random.real(0, 1), random.string(2, 8) }, { 1, 2, 3 } };
+	});
+	add<Optionals>(suite, "optionals/half_empty", [](Random& random, std::size_t i)
+	{
+		auto res = Optionals{ {}, {}, std::int32_t(i) };
+		if (random.chance(50))
+			res.first = std::int32_t(i);
+		if (random.chance(50))
+			res.second = random.string(4, 8);
+		return res;
+	});
+	add<diversion::variant<std::int32_t, std::string, double>>(suite, "variants/int_string_double", [](Random& random, std::size_t i)
+	{
+		auto res = diversion::variant<std::int32_t, std::string, double>{ std::int32_t(i) };
+		switch (random.next() % 3)
+		{
+			case 1:
+				res = random.string(4, 12);
+				break;
+			case 2:
+				res = random.real(0, 1);
+				break;
+		}
+		return res;
+	});
+	add<boost::uuids::uuid>(suite, "uuids", [](Random& random, std::size_t)
+	{
+		auto res = boost::uuids::uuid{};
+		for (auto& byte : res)
+			byte = std::uint8_t(random.next());
+		return res;
+	});
+	add<bench::corpus::TimePoint>(suite, "time_points", [](Random& random, std::size_t)
+	{
+		return bench::corpus::TimePoint{ std::chrono::milliseconds{ 1500000000000 + random.range(0, 1 << 30) } };
+	});
+}
@@ -0,0 +1,128 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/asio/protocol.hpp"
+#include "bobl/utility/diversion.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <boost/format.hpp>
+#include <limits>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace asio {
+
+// Encodes many small messages framed by Protocol (bobl::asio::Bson or bobl::asio::Cbor) back to back into a single reusable buffer,
+// so the whole batch can be sent by one write/send. Sink is called as void(std::uint8_t const* data, std::size_t size, std::vector<std::size_t> const& offsets)
+// with the batch and offsets of its frames once it holds at least capacity bytes or count messages.
+// flush() has to be called to pass on the rest, it isn't done on destruction.
+//	auto batch = bobl::asio::make_batch_encoder<bobl::asio::Cbor>([&socket](std::uint8_t const* data, std::size_t size, std::vector<std::size_t> const&)
+//						{ boost::asio::write(socket, boost::asio::buffer(data, size)); });
+//	for (auto const& tick : ticks) batch.write(tick);
+//	batch.flush();
+template<typename Protocol, typename Sink>
+class BatchEncoder
+{
+public:
+	explicit BatchEncoder(Sink sink, std::size_t capacity = 64 * 1024, std::size_t count = (std::numeric_limits<std::size_t>::max)())
+		: sink_( std::move(sink) ), capacity_{ capacity }, count_{ count }
+	{
+		buffer_.reserve(capacity);
+	}
+
+	template<typename ...Options, typename T>
+	void write(T const& value)
+	{
+		offsets_.push_back(buffer_.size());
+		try
+		{
+			Protocol::template append<Options...>(buffer_, value);
+		}
+		catch (...)
+		{
+			// batch keeps messages encoded so far
+			buffer_.resize(offsets_.back());
+			offsets_.pop_back();
+			throw;
+		}
+		if (buffer_.size() >= capacity_ || offsets_.size() >= count_)
+			flush();
+	}
+
+	void flush()
+	{
+		if (offsets_.empty())
+			return;
+		sink_(static_cast<std::uint8_t const*>(buffer_.data()), buffer_.size(), static_cast<std::vector<std::size_t> const&>(offsets_));
+		buffer_.clear();
+		offsets_.clear();
+	}
+
+	// bytes and messages not passed on yet
+	std::size_t buffered() const { return buffer_.size(); }
+	std::size_t size() const { return offsets_.size(); }
+private:
+	Sink sink_;
+	std::size_t capacity_;
+	std::size_t count_;
+	std::vector<std::uint8_t> buffer_;
+	std::vector<std::size_t> offsets_;
+};
+
+template<typename Protocol, typename Sink>
+BatchEncoder<Protocol, Sink> make_batch_encoder(Sink sink, std::size_t capacity = 64 * 1024, std::size_t count = (std::numeric_limits<std::size_t>::max)())
+{
+	return BatchEncoder<Protocol, Sink>{ std::move(sink), capacity, count };
+}
+
+// Messages of a batch received as a whole, messages are returned as views into the batch, nothing is copied.
+// Views can be decoded right away by next<T>() or collected and handed to bobl::cbor/bson::decode_batch.
+template<typename Protocol>
+class BatchReader
+{
+public:
+	BatchReader(std::uint8_t const* begin, std::uint8_t const* end) : begin_{ begin }, current_{ begin }, end_{ end } {}
+
+	// next message without its frame header, nullopt at the end of the batch
+	diversion::optional<boost::iterator_range<std::uint8_t const*>> next()
+	{
+		if (current_ == end_)
+			return diversion::nullopt;
+		auto header = std::size_t{ 0 };
+		auto size = Protocol::frame(current_, end_, header);
+		if (size != 0 && size < header)
+			throw bobl::InvalidObject{ str(boost::format("invalid frame at offset %1% of %2% bytes batch") % (current_ - begin_) % (end_ - begin_)) };
+		if (size == 0 || size > std::size_t(end_ - current_))
+			throw bobl::InputToShort{ str(boost::format("truncated message at offset %1% of %2% bytes batch") % (current_ - begin_) % (end_ - begin_)) };
+		auto begin = current_;
+		current_ += size;
+		return boost::make_iterator_range(begin + header, current_);
+	}
+
+	template<typename T, typename Options = bobl::options::None>
+	diversion::optional<T> next()
+	{
+		auto message = next();
+		if (!message)
+			return diversion::nullopt;
+		return Protocol::template decode<T, Options>(message->begin(), message->end());
+	}
+
+	// byte offset of the next message, offsets passed to BatchEncoder sink can be used to jump straight to any message
+	std::size_t offset() const { return std::size_t(current_ - begin_); }
+
+	void seek(std::size_t offset)
+	{
+		if (offset > std::size_t(end_ - begin_))
+			throw bobl::RangeError{ str(boost::format("offset %1% is out of %2% bytes batch") % offset % (end_ - begin_)) };
+		current_ = begin_ + offset;
+	}
+private:
+	std::uint8_t const* begin_;
+	std::uint8_t const* current_;
+	std::uint8_t const* end_;
+};
+
+}/*namespace asio*/ } /*namespace bobl*/
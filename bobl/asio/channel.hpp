@@ -0,0 +1,257 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/asio/protocol.hpp"
+#include "bobl/utility/buffer_pool.hpp"
+#include "bobl/options.hpp"
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/system/error_code.hpp>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace asio {
+
+// process wide pool channels take their buffers from by default
+inline bobl::utility::BufferPool& buffer_pool()
+{
+	static bobl::utility::BufferPool res;
+	return res;
+}
+
+// Messages framed by Protocol (bobl::asio::Bson or bobl::asio::Cbor) over Asio byte stream.
+//	auto channel = bobl::asio::Channel<bobl::asio::Cbor>{ std::move(socket) };
+//	channel.async_read<Event>([](boost::system::error_code ec, Event event) { ... });
+//	channel.async_write(event, [](boost::system::error_code ec, std::size_t size) { ... });
+// Any Asio completion token (use_future, yield_context, ...) can be used instead of callbacks.
+// Messages are received into single reusable buffer and sent from buffers taken from lock free BufferPool, so steady traffic doesn't allocate.
+// async_write can be called from any thread at any time, messages queued while previous write is in progress are sent by a single gather write;
+// only one async_read may be outstanding at a time. Channel has to outlive its operations.
+template<typename Protocol, typename Stream = boost::asio::ip::tcp::socket>
+class Channel
+{
+	using Buffer = bobl::utility::BufferPool::Buffer;
+	using ReadHandler = std::function<void(boost::system::error_code, std::uint8_t const*, std::uint8_t const*)>;
+	struct Message
+	{
+		Buffer buffer;
+		std::size_t offset;
+		std::function<void(boost::system::error_code, std::size_t)> handler;
+	};
+
+	// calls handler with stored arguments, lets to dispatch handler to its associated executor
+	template<typename Handler, typename Value>
+	struct Completion
+	{
+		void operator()() { (*handler)(error, std::move(value)); }
+
+		std::shared_ptr<Handler> handler;
+		boost::system::error_code error;
+		Value value;
+	};
+public:
+	using executor_type = typename Stream::executor_type;
+
+	explicit Channel(Stream stream, std::size_t capacity = 64 * 1024, std::size_t max_message = 64 * 1024 * 1024, bobl::utility::BufferPool& pool = buffer_pool())
+		: stream_( std::move(stream) ), strand_( stream_.get_executor() ), max_message_{ max_message }, pool_( pool ), input_{ pool.acquire() }
+	{
+		input_->resize((std::max)(capacity, std::size_t{ 1 }));
+	}
+	Channel(Channel const&) = delete;
+	Channel& operator=(Channel const&) = delete;
+
+	executor_type get_executor() { return stream_.get_executor(); }
+	Stream& next_layer() { return stream_; }
+
+	// completes with the next decoded message, with boost::system::errc::bad_message if it can't be decoded
+	// or with boost::asio::error::message_size if it is larger than max_message
+	template<typename T, typename Options = bobl::options::None, typename ReadToken>
+	BOOST_ASIO_INITFN_RESULT_TYPE(ReadToken, void(boost::system::error_code, T))
+	async_read(ReadToken&& token)
+	{
+		static_assert(std::is_default_constructible<T>::value, "bobl::asio::Channel::async_read requires default constructible type, it is passed on errors");
+		return boost::asio::async_initiate<ReadToken, void(boost::system::error_code, T)>(InitiateRead<T, Options>{ this }, token);
+	}
+
+	// value is encoded right away, encoding errors are thrown by async_write itself; completes with number of bytes the message took
+	template<typename ...Options, typename T, typename WriteToken>
+	BOOST_ASIO_INITFN_RESULT_TYPE(WriteToken, void(boost::system::error_code, std::size_t))
+	async_write(T const& value, WriteToken&& token)
+	{
+		auto buffer = pool_.acquire();
+		auto offset = Protocol::template encode<Options...>(*buffer, value);
+		return boost::asio::async_initiate<WriteToken, void(boost::system::error_code, std::size_t)>(InitiateWrite{ this, std::move(buffer), offset }, token);
+	}
+private:
+	template<typename T, typename Options>
+	struct InitiateRead
+	{
+		template<typename Handler>
+		void operator()(Handler&& handler) const
+		{
+			auto channel = self;
+			auto shared = std::make_shared<typename std::decay<Handler>::type>(std::forward<Handler>(handler));
+			boost::asio::post(channel->strand_, [channel, shared]()
+			{
+				channel->read_message([channel, shared](boost::system::error_code error, std::uint8_t const* begin, std::uint8_t const* end)
+				{
+					auto value = T{};
+					if (!error)
+					{
+						try
+						{
+							value = Protocol::template decode<T, Options>(begin, end);
+						}
+						catch (std::exception const&)
+						{
+							error = boost::system::errc::make_error_code(boost::system::errc::bad_message);
+						}
+					}
+					channel->complete(shared, error, std::move(value));
+				});
+			});
+		}
+
+		Channel* self;
+	};
+
+	// owns encoded message, lazy tokens (use_awaitable, deferred, ...) initiate operation after async_write has returned
+	struct InitiateWrite
+	{
+		template<typename Handler>
+		void operator()(Handler&& handler)
+		{
+			auto channel = self;
+			auto shared = std::make_shared<typename std::decay<Handler>::type>(std::forward<Handler>(handler));
+			channel->enqueue(Message{ std::move(buffer), offset, [channel, shared](boost::system::error_code error, std::size_t size)
+			{
+				channel->complete(shared, error, size);
+			} });
+		}
+
+		Channel* self;
+		Buffer buffer;
+		std::size_t offset;
+	};
+
+	template<typename Handler, typename Value>
+	void complete(std::shared_ptr<Handler> const& handler, boost::system::error_code error, Value value)
+	{
+		auto executor = boost::asio::get_associated_executor(*handler, stream_.get_executor());
+		boost::asio::dispatch(executor, Completion<Handler, Value>{ handler, error, std::move(value) });
+	}
+
+	// runs on the strand, calls f with the next message, message bytes remain valid until the following read
+	void read_message(ReadHandler f)
+	{
+		auto& input = *input_;
+		auto header = std::size_t{ 0 };
+		auto size = std::size_t{ 0 };
+		try
+		{
+			size = Protocol::frame(input.data() + begin_, input.data() + end_, header);
+		}
+		catch (std::exception const&)
+		{
+			return f(boost::system::errc::make_error_code(boost::system::errc::bad_message), nullptr, nullptr);
+		}
+		if (size > max_message_)
+			return f(boost::asio::error::message_size, nullptr, nullptr);
+		if (size != 0 && size < header)
+			return f(boost::system::errc::make_error_code(boost::system::errc::bad_message), nullptr, nullptr);
+		if (size != 0 && end_ - begin_ >= size)
+		{
+			auto begin = input.data() + begin_;
+			begin_ += size;
+			return f(boost::system::error_code{}, begin + header, begin + size);
+		}
+		// keeps the incomplete message and reuses the buffer, grows it only for messages larger than the buffer
+		if (begin_ != 0)
+		{
+			std::memmove(input.data(), input.data() + begin_, end_ - begin_);
+			end_ -= begin_;
+			begin_ = 0;
+		}
+		if (input.size() < (std::max)(size, end_ + 1))
+			input.resize((std::max)(size, input.size() * 2));
+		stream_.async_read_some(boost::asio::buffer(input.data() + end_, input.size() - end_), boost::asio::bind_executor(strand_, [this, f](boost::system::error_code error, std::size_t n)
+		{
+			if (error)
+				return f(error, nullptr, nullptr);
+			end_ += n;
+			read_message(std::move(f));
+		}));
+	}
+
+	void enqueue(Message message)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ guard_ };
+			queue_.push_back(std::move(message));
+			if (writing_)
+				return;
+			writing_ = true;
+		}
+		boost::asio::post(strand_, [this]() { write_queued(); });
+	}
+
+	// runs on the strand, sends everything queued so far by one gather write
+	void write_queued()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ guard_ };
+			sending_.swap(queue_);
+		}
+		gather_.clear();
+		for (auto const& message : sending_)
+			gather_.emplace_back(message.buffer->data() + message.offset, message.buffer->size() - message.offset);
+		boost::asio::async_write(stream_, gather_, boost::asio::bind_executor(strand_, [this](boost::system::error_code error, std::size_t /*n*/)
+		{
+			for (auto& message : sending_)
+				message.handler(error, error ? 0 : message.buffer->size() - message.offset);
+			// buffers go back to the pool
+			sending_.clear();
+			{
+				std::lock_guard<std::mutex> lock{ guard_ };
+				if (queue_.empty())
+				{
+					writing_ = false;
+					return;
+				}
+			}
+			write_queued();
+		}));
+	}
+private:
+	Stream stream_;
+	boost::asio::strand<executor_type> strand_;
+	std::size_t max_message_;
+	bobl::utility::BufferPool& pool_;
+	Buffer input_;
+	std::size_t begin_ = 0;
+	std::size_t end_ = 0;
+	std::mutex guard_;
+	std::vector<Message> queue_;
+	bool writing_ = false;
+	std::vector<Message> sending_;
+	std::vector<boost::asio::const_buffer> gather_;
+};
+
+}/*namespace asio*/ } /*namespace bobl*/
@@ -0,0 +1,152 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/bson/encode.hpp"
+#include "bobl/bson/decode.hpp"
+#include "bobl/bson/cast.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/cbor/decode.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/fusion/support/is_sequence.hpp>
+#include <boost/fusion/adapted/std_tuple.hpp>
+#include <boost/endian/conversion.hpp>
+#include <boost/format.hpp>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace asio {
+
+// Framing of messages sent over byte streams, Protocol used by bobl::asio::Channel provides:
+//	frame(begin, end, header) - size of the frame starting at begin including its header, 0 if more bytes are required to tell;
+//								header is set to the number of prefix bytes preceding the message
+//	encode<Options...>(buffer, value) - encodes framed value into empty buffer, returns offset the frame starts at
+//	append<Options...>(buffer, value) - appends framed value to buffer right after its last byte
+//	decode<T, Options>(begin, end) - decodes message (frame without its header)
+
+// BSON documents are framed by their own length prefix
+struct Bson
+{
+	static std::size_t frame(std::uint8_t const* begin, std::uint8_t const* end, std::size_t& header)
+	{
+		header = 0;
+		if (std::size_t(end - begin) < sizeof(std::uint32_t))
+			return 0;
+		auto size = std::uint32_t{};
+		std::memcpy(&size, begin, sizeof(size));
+		size = boost::endian::little_to_native(size);
+		if (size < sizeof(std::uint32_t) + sizeof(std::uint8_t))
+			throw bobl::InvalidObject{ str(boost::format("invalid BSON document size : %1%") % size) };
+		return size;
+	}
+
+	template<typename ...Options, typename T>
+	static std::size_t encode(std::vector<std::uint8_t>& buffer, T const& value)
+	{
+		append<Options...>(buffer, value);
+		return 0;
+	}
+
+	// documents are encoded straight into the buffer
+	template<typename ...Options, typename T>
+	static auto append(std::vector<std::uint8_t>& buffer, T const& value)
+		-> typename std::enable_if<boost::fusion::traits::is_sequence<T>::value>::type
+	{
+		bobl::bson::encoder::details::Handler<T, bobl::Options<Options...>>::encode(buffer, value);
+	}
+
+	template<typename ...Options, typename T>
+	static auto append(std::vector<std::uint8_t>& buffer, T const& value)
+		-> typename std::enable_if<!boost::fusion::traits::is_sequence<T>::value>::type
+	{
+		append<Options...>(buffer, std::make_tuple(value));
+	}
+
+	template<typename T, typename Options>
+	static T decode(std::uint8_t const* begin, std::uint8_t const* end)
+	{
+		return bobl::bson::decode<T, Options>(begin, end);
+	}
+};
+
+// CBOR items prefixed by their size as unsigned LEB128 varint
+struct Cbor
+{
+	static constexpr std::size_t MaxHeader = (sizeof(std::uint64_t) * 8 + 6) / 7;
+
+	static std::size_t frame(std::uint8_t const* begin, std::uint8_t const* end, std::size_t& header)
+	{
+		auto size = std::uint64_t{ 0 };
+		for (header = 0; begin + header != end; )
+		{
+			auto byte = begin[header];
+			// the last byte holds bit 63 only
+			if (header == MaxHeader - 1 && byte > 1)
+				throw bobl::InvalidObject{ "invalid CBOR frame size prefix" };
+			size |= std::uint64_t(byte & 0x7f) << (7 * header);
+			if ((byte & 0x80) == 0)
+			{
+				if (size > (std::numeric_limits<std::size_t>::max)() - ++header)
+					throw bobl::InvalidObject{ str(boost::format("CBOR frame size %1% is too large") % size) };
+				return std::size_t(size) + header;
+			}
+			if (++header == MaxHeader)
+				throw bobl::InvalidObject{ "invalid CBOR frame size prefix" };
+		}
+		return 0;
+	}
+
+	// item is encoded after the space reserved for the longest prefix, then the prefix is written right before it
+	template<typename ...Options, typename T>
+	static std::size_t encode(std::vector<std::uint8_t>& buffer, T const& value)
+	{
+		buffer.resize(std::size_t{ MaxHeader });
+		bobl::cbor::encode<Options...>(std::back_inserter(buffer), value);
+		std::uint8_t prefix[MaxHeader];
+		auto header = std::size_t{ 0 };
+		for (auto size = std::uint64_t(buffer.size() - MaxHeader); ; size >>= 7)
+		{
+			prefix[header++] = std::uint8_t(size & 0x7f) | (size > 0x7f ? 0x80 : 0);
+			if (size <= 0x7f)
+				break;
+		}
+		std::memcpy(buffer.data() + MaxHeader - header, prefix, header);
+		return MaxHeader - header;
+	}
+
+	// item is encoded after the space reserved for the longest prefix and moved back to the actual prefix, typically by a few bytes
+	template<typename ...Options, typename T>
+	static void append(std::vector<std::uint8_t>& buffer, T const& value)
+	{
+		auto const first = buffer.size();
+		buffer.resize(first + MaxHeader);
+		bobl::cbor::encode<Options...>(std::back_inserter(buffer), value);
+		auto const size = buffer.size() - first - MaxHeader;
+		auto header = std::size_t{ 0 };
+		for (auto n = std::uint64_t(size); ; n >>= 7)
+		{
+			buffer[first + header++] = std::uint8_t(n & 0x7f) | (n > 0x7f ? 0x80 : 0);
+			if (n <= 0x7f)
+				break;
+		}
+		std::memmove(buffer.data() + first + header, buffer.data() + first + MaxHeader, size);
+		buffer.resize(first + header + size);
+	}
+
+	template<typename T, typename Options>
+	static T decode(std::uint8_t const* begin, std::uint8_t const* end)
+	{
+		auto res = bobl::cbor::decode<T, Options>(begin, end);
+		if (begin != end)
+			throw bobl::InvalidObject{ str(boost::format("unexpected %1% bytes after CBOR item") % (end - begin)) };
+		return res;
+	}
+};
+
+}/*namespace asio*/ } /*namespace bobl*/
@@ -0,0 +1,45 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+
+#include "bobl/bson/decode.hpp"
+#include "bobl/utility/batch.hpp"
+#include "bobl/utility/parallel.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/range/size.hpp>
+#include <vector>
+#include <cstddef>
+
+namespace bobl{ namespace bson {
+
+namespace details {
+
+template<typename T, typename Options>
+struct BatchDecoder
+{
+	// document size has to match span size, it's checked by Document::decode
+	template<typename Iterator>
+	static T decode(Iterator begin, Iterator end) { return bobl::bson::decode<T, Options>(begin, end); }
+};
+
+} /*namespace details*/
+
+// decodes independent BSON documents on pool workers keeping their order, out is random access iterator to bobl::utility::Result<T>
+//	bobl::utility::ThreadPool pool;
+//	auto results = bobl::bson::decode_batch<Message>(spans, pool); // spans - e.g. std::vector<boost::iterator_range<std::uint8_t const*>>
+template<typename T, typename Options = bobl::options::None, typename Spans, typename Iterator>
+void decode_batch(Spans const& spans, Iterator out, bobl::utility::ThreadPool& pool, std::size_t batch = 64)
+{
+	bobl::utility::decode_batch<details::BatchDecoder<T, Options>>(spans, out, pool, batch);
+}
+
+template<typename T, typename Options = bobl::options::None, typename Spans>
+std::vector<bobl::utility::Result<T>> decode_batch(Spans const& spans, bobl::utility::ThreadPool& pool, std::size_t batch = 64)
+{
+	auto res = std::vector<bobl::utility::Result<T>>(std::size_t(boost::size(spans)));
+	decode_batch<T, Options>(spans, res.begin(), pool, batch);
+	return res;
+}
+
+}/*namespace bson*/ } /*namespace bobl*/
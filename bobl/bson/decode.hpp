@@ -7,6 +7,8 @@
 #include "bobl/bson/flyweight.hpp"
 #include "bobl/bson/bson.hpp"
 #include "bobl/utility/any.hpp"
+#include "bobl/utility/stats.hpp"
+#include "bobl/utility/profile.hpp"
 #include "bobl/bobl.hpp"
 
 namespace bobl{ namespace bson { 
@@ -67,7 +69,10 @@ bobl::Type type(bobl::flyweight::lite::Any<Iterator> const& any)
 template<typename ...Args, typename Iterator>
 auto decode(Iterator& begin, Iterator end) -> typename bobl::utility::DecodeParameters<bobl::bson::NsTag, Args...>::Result
 {
+	bobl::profile::DecodeProbe<typename bobl::utility::DecodeParameters<bobl::bson::NsTag, Args...>::Result> probe;
+	auto position = bobl::stats::position(begin);
 	auto doc = bobl::bson::flyweight::Document::decode(begin, end);
+	bobl::stats::scanned(position, begin);
 	return cast<Args...>(doc);
 }
 
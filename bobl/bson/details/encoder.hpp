@@ -10,10 +10,14 @@
 #include "bobl/utility/nvariant.hpp"
 #include "bobl/utility/timepoint.hpp"
 #include "bobl/utility/options.hpp"
+#include "bobl/utility/utf8.hpp"
+#include "bobl/utility/intern.hpp"
 #include "bobl/utility/parameters.hpp"
 #include "bobl/utility/float.hpp"
 #include "bobl/utility/names.hpp"
 #include "bobl/utility/diversion.hpp"
+#include "bobl/utility/parallel.hpp"
+#include "bobl/utility/profile.hpp"
 #include "bobl/names.hpp"
 #include "bobl/bobl.hpp"
 #include <boost/fusion/include/at.hpp>
@@ -31,6 +35,8 @@
 #include <algorithm>
 #include <iterator>
 #include <type_traits>
+#include <utility>
+#include <cstddef>
 #include <cstdint>
 #include <cassert>
 
@@ -86,6 +92,9 @@ public:
 	template<typename Iterator>
 	static Iterator encode(Iterator out, diversion::string_view name, std::string const& value)
 	{
+		if (bobl::utility::options::Contains<typename bobl::bson::EffectiveOptions<std::string, Options>::type, bobl::options::ValidateUtf8>::value
+			&& !bobl::utility::utf8::valid(value.data(), value.size()))
+			throw bobl::InvalidObject{ "string isn't valid UTF-8 and can't be encoded as BSON UTF-8 string" };
 		Handler<Header, Options>::encode(out, std::make_pair(bobl::bson::Utf8String, std::move(name)));
 		out = encode_integer(out, std::uint32_t(value.size() + 1));  // size 
 		out = std::copy(std::begin(value), std::end(value), out);	 // value
@@ -94,6 +103,17 @@ public:
 	}
 };
 
+template</*typename T,*/ typename Options>
+class Handler<bobl::utility::InternedString, Options, boost::mpl::true_>
+{
+public:
+	template<typename Iterator>
+	static Iterator encode(Iterator out, diversion::string_view name, bobl::utility::InternedString const& value)
+	{
+		return Handler<std::string, Options>::encode(std::move(out), std::move(name), value.str());
+	}
+};
+
 template<typename T, typename Options>
 class Handler<std::vector<T>, Options, typename bobl::utility::IsByteType<T, Options>::type>
 {
@@ -191,6 +211,7 @@ template<typename Options, typename Iterator, typename T>
 inline Iterator encode(Iterator out, diversion::string_view name, T const& value)
 {
 	using Type = typename std::conditional<bobl::utility::Adaptable<T, bobl::bson::Adapter<T>>::value, bobl::bson::Adapter<T>, T>::type;
+	bobl::profile::EncodeProbe<T> probe;
 	return Handler<Type, typename bobl::bson::EffectiveOptions<T, Options>::type>::encode(std::move(out), std::move(name), value);
 }
 
@@ -306,7 +327,7 @@ public:
 	{
 		auto first = buffer.size();
 		buffer.resize(first + sizeof(std::uint32_t) / sizeof(std::uint8_t));
-		encode<0>(std::back_inserter(buffer), sequence);
+		encode_members(std::back_inserter(buffer), sequence, Members{});
 		buffer.push_back(0);
 		encode_integer(std::next(std::begin(buffer), first), std::uint32_t(buffer.size() - first));		
 	}
@@ -327,22 +348,39 @@ public:
 		return encode(out, sequence);
 	}
 private:
-	template<std::size_t N, typename U, typename Iterator>
-	static typename std::enable_if<boost::fusion::result_of::size<U>::value != N, Iterator>::type encode(Iterator out, U const& sequence)
+#if __cplusplus >= 201703L
+	using Members = std::make_index_sequence<boost::fusion::result_of::size<T>::value>;
+
+	template<typename Iterator, std::size_t ...N>
+	static Iterator encode_members(Iterator out, T const& sequence, std::index_sequence<N...>)
+	{
+		((out = encode_member<N>(std::move(out), sequence)), ...);
+		return out;
+	}
+#else
+	using Members = std::integral_constant<std::size_t, 0>;
+
+	template<typename Iterator, std::size_t N>
+	static Iterator encode_members(Iterator out, T const& sequence, std::integral_constant<std::size_t, N>)
+	{
+		return encode_members(encode_member<N>(std::move(out), sequence), sequence, std::integral_constant<std::size_t, N + 1>{});
+	}
+
+	template<typename Iterator>
+	static Iterator encode_members(Iterator out, T const& /*sequence*/, std::integral_constant<std::size_t, boost::fusion::result_of::size<T>::value>) { return out; }
+#endif
+
+	template<std::size_t N, typename Iterator>
+	static Iterator encode_member(Iterator out, T const& sequence)
 	{
-		using Type = typename boost::fusion::result_of::value_at_c<U, N>::type;
+		using Type = typename boost::fusion::result_of::value_at_c<T, N>::type;
 		struct PositionAsName { static auto name() -> decltype(diversion::to_string(N)) { return diversion::to_string(N); } };
 		using MemberName = typename std::conditional<HeterogeneousArray::value
 													, PositionAsName
 													, typename bobl::utility::GetNameType<bobl::MemberName<T, Type, N, typename bobl::bson::EffectiveOptions<T, Options>::type>>::type>::type;
 
-		out = details::encode<Options, Iterator, Type>(out, diversion::string_view{ MemberName::name() }, boost::fusion::at_c<N>(sequence));
-		return encode<N + 1>(std::move(out), sequence);
+		return details::encode<Options, Iterator, Type>(out, diversion::string_view{ MemberName::name() }, boost::fusion::at_c<N>(sequence));
 	}
-
-
-	template<std::size_t N, typename U, typename Iterator>
-	static typename std::enable_if<boost::fusion::result_of::size<U>::value == N, Iterator>::type encode(Iterator out, U const& /*sequence*/) { return out; }
 };
 
 template<typename T, typename Options>
@@ -353,16 +391,43 @@ public:
 	static Iterator encode(Iterator out, diversion::string_view name, std::vector<T> const& values)
 	{
 		Handler<Header, Options>::encode(out, std::make_pair(bobl::bson::Array, std::move(name)));
+		if (Threshold != 0 && values.size() * sizeof(T) >= Threshold)
+			return encode_chunks(out, values);
 		std::vector<std::uint8_t> buffer;
+		encode_elements(buffer, values, 0, values.size());
+		out = encode_integer(out, std::uint32_t(buffer.size() + sizeof(std::uint32_t) / sizeof(std::uint8_t) + 1));
+		out = std::copy(std::begin(buffer), std::end(buffer), out);
+		out = 0;
+		return ++out;
+	}
+private:
+	static constexpr std::size_t Threshold = bobl::utility::options::ParallelArrays<Options>::value;
+
+	// element names are their positions in the whole array, so any range of elements can be encoded on its own
+	static void encode_elements(std::vector<std::uint8_t>& buffer, std::vector<T> const& values, std::size_t first, std::size_t last)
+	{
 		auto bi = std::back_inserter(buffer);
-		auto n = values.size();
-		for (decltype(n) i = 0; i != n; ++i)
+		for (auto i = first; i != last; ++i)
 		{
 			auto item_name = diversion::to_string(i);
-			bi = details::encode<Options, Iterator, T>(bi, diversion::string_view{ item_name }, values[i]);
+			bi = details::encode<Options, decltype(bi), T>(bi, diversion::string_view{ item_name }, values[i]);
 		}
-		out = encode_integer(out, std::uint32_t(buffer.size() + sizeof(std::uint32_t) / sizeof(std::uint8_t) + 1));
-		out = std::copy(std::begin(buffer), std::end(buffer), out);
+	}
+
+	// chunks are encoded on shared pool workers, array length is their total size, then chunks are written in order
+	template<typename Iterator>
+	static Iterator encode_chunks(Iterator out, std::vector<T> const& values)
+	{
+		auto chunks = bobl::utility::encode_chunks(bobl::utility::shared_pool(), values.size(), [&values](std::size_t first, std::size_t last, std::vector<std::uint8_t>& buffer)
+		{
+			encode_elements(buffer, values, first, last);
+		});
+		auto size = std::size_t{ sizeof(std::uint32_t) / sizeof(std::uint8_t) + 1 };
+		for (auto const& chunk : chunks)
+			size += chunk.size();
+		out = encode_integer(out, std::uint32_t(size));
+		for (auto const& chunk : chunks)
+			out = std::copy(std::begin(chunk), std::end(chunk), out);
 		out = 0;
 		return ++out;
 	}
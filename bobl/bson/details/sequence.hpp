@@ -8,6 +8,7 @@
 #include "bobl/utility/options.hpp"
 #include "bobl/utility/adapter.hpp"
 #include "bobl/utility/decoders.hpp"
+#include "bobl/utility/stats.hpp"
 #include "bobl/utility/diversion.hpp"
 #include "bobl/bobl.hpp"
 #include <boost/fusion/support/is_sequence.hpp>
@@ -86,6 +87,8 @@ public:
 				throw bobl::IncorrectObjectType{ str(boost::format("BSON document contains unexpected extra object %1% type : %2% (%3$#x)") % header.name() % to_string(type) % int(type)) };
 			}
 		}
+		// members following the last one decoded
+		bobl::stats::skipped(bobl::stats::position(begin), end);
 		return res;
 	}
 };
@@ -12,8 +12,12 @@
 #include "bobl/utility/has_is.hpp"
 #include "bobl/utility/type_name.hpp"
 #include "bobl/utility/utils.hpp"
+#include "bobl/utility/utf8.hpp"
+#include "bobl/utility/intern.hpp"
 #include "bobl/utility/diversion.hpp"
 #include "bobl/utility/timepoint.hpp"
+#include "bobl/utility/parallel.hpp"
+#include "bobl/utility/stats.hpp"
 #include "bobl/bobl.hpp"
 #include <boost/format.hpp>
 #include <boost/fusion/adapted/std_tuple.hpp>
@@ -27,6 +31,9 @@
 #include <boost/variant/static_visitor.hpp>
 #include <boost/endian/conversion.hpp>
 #include <chrono>
+#include <algorithm>
+#include <exception>
+#include <iterator>
 #include <vector>
 #include <string>
 #include <tuple>
@@ -217,9 +224,37 @@ public:
 	 static ValueHandler decode(ObjectHeader&& header, bobl::bson::flyweight::Iterator& begin, bobl::bson::flyweight::Iterator end)
 	 {
 		 begin = header.validate<BsonType>(end);
-		 return ValueHandler(std::move(header));
+		 auto res = ValueHandler(std::move(header));
+		 if (bobl::utility::options::Contains<typename bobl::bson::EffectiveOptions<std::string, Options>::type, bobl::options::ValidateUtf8>::value)
+			 res.validate();
+		 return res;
 	 }
 	 static bool is(details::ObjectHeader const& header) { return header.type() == BsonType; }
+ private:
+	 void validate() const
+	 {
+		 if (length() == 0)
+			 throw bobl::InvalidObject{ "BSON UTF-8 string has no terminating zero" };
+		 auto data = value() + sizeof(std::uint32_t) /*size*/;
+		 auto end = data + length() - 1;
+		 auto invalid = bobl::utility::utf8::find_invalid(data, end);
+		 if (invalid != end)
+			 throw bobl::InvalidObject{ str(boost::format("BSON UTF-8 string isn't valid UTF-8, invalid sequence at offset %1%") % (invalid - data)) };
+	 }
+ };
+
+ // repeated strings are interned straight from the buffer without being allocated
+ template<typename Options>
+ class ValueHandler<bobl::utility::InternedString, Options, boost::mpl::true_> : public ValueHandler<std::string, Options>
+ {
+	 using Base = ValueHandler<std::string, Options>;
+	 ValueHandler(Base&& base) : Base{ std::move(base) } {}
+ public:
+	 bobl::utility::InternedString operator()() const { return bobl::utility::intern(diversion::string_view{ reinterpret_cast<char const*>(this->value() + sizeof(std::uint32_t) /*size*/), this->length() - 1 }); }
+	 static ValueHandler decode(ObjectHeader&& header, bobl::bson::flyweight::Iterator& begin, bobl::bson::flyweight::Iterator end)
+	 {
+		 return ValueHandler{ Base::decode(std::move(header), begin, end) };
+	 }
  };
 
  class Binary : public ValueHandlerBase
@@ -315,11 +350,9 @@ public:
 	 using EmbeddedDocument::name;
 	 std::vector<T> operator()() const
 	 {	
-		 std::vector<T> res;
 		 auto const& val = value();
-		 auto end = val.end();
-		 for (auto begin = val.begin(); begin != end;)
-			 res.emplace_back(NameValue<T, Options>::decode(begin, end).value());
+		 auto res = decode_elements(val.begin(), val.end(), std::integral_constant<bool, (Threshold != 0 && std::is_default_constructible<T>::value)>{});
+		 bobl::stats::elements<T>(res.size());
 		 return res;
 	 }
 
@@ -328,6 +361,47 @@ public:
 		 begin = header.validate<BsonType>(end);
 		 return ValueHandler(std::move(header));
 	 }
+ private:
+	 static constexpr std::size_t Threshold = bobl::utility::options::ParallelArrays<Options>::value;
+
+	 static std::vector<T> decode_elements(bobl::bson::flyweight::Iterator begin, bobl::bson::flyweight::Iterator end, std::false_type)
+	 {
+		 std::vector<T> res;
+		 while (begin != end)
+			 res.emplace_back(NameValue<T, Options>::decode(begin, end).value());
+		 return res;
+	 }
+
+	 // every element is located by its type and length prefix first, then elements are decoded in place on shared pool workers
+	 static std::vector<T> decode_elements(bobl::bson::flyweight::Iterator begin, bobl::bson::flyweight::Iterator end, std::true_type)
+	 {
+		 if (std::size_t(std::distance(begin, end)) < Threshold)
+			 return decode_elements(begin, end, std::false_type{});
+		 auto positions = std::vector<bobl::bson::flyweight::Iterator>{};
+		 try
+		 {
+			 for (auto i = begin; i != end; i = ObjectHeader{ i, end }.validate(end))
+				 positions.push_back(i);
+		 }
+		 catch (std::exception const&)
+		 {
+			 // malformed array, sequential decoder reports the error exactly as it would without the option
+			 return decode_elements(begin, end, std::false_type{});
+		 }
+		 auto res = std::vector<T>(positions.size());
+		 auto& pool = bobl::utility::shared_pool();
+		 // failure of the lowest batch is rethrown and batches are consecutive, so the first invalid element is reported as sequential decoder does
+		 pool.parallel_for(positions.size(), (std::max)(std::size_t{ 1 }, positions.size() / (pool.size() * 8)),
+			 [&res, &positions, end](std::size_t /*worker*/, std::size_t /*batch*/, std::size_t first, std::size_t last)
+			 {
+				 for (auto i = first; i != last; ++i)
+				 {
+					 auto position = positions[i];
+					 res[i] = NameValue<T, Options>::decode(position, end).value();
+				 }
+			 });
+		 return res;
+	 }
  };
 
 
@@ -413,6 +487,7 @@ private:
 		}
 		catch (bobl::IncorrectObjectType&)
 		{
+			bobl::stats::exception();
 		}
 		begin = i;
 		return try_decode<Args...>(std::move(header), begin, end);
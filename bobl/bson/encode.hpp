@@ -4,6 +4,7 @@
 #include "bobl/bson/details/encoder.hpp"
 #include "bobl/utility/names.hpp"
 #include "bobl/utility/options.hpp"
+#include "bobl/utility/profile.hpp"
 #include "bobl/options.hpp"
 #include <boost/fusion/support/is_sequence.hpp>
 #include <boost/fusion/adapted/std_tuple.hpp>
@@ -22,6 +23,7 @@ auto encode(T const& value)
 								bobl::utility::NamedSequence<T, typename bobl::bson::EffectiveOptions<T, Options...>::type>>::value,
 										std::vector<std::uint8_t>>::type
 {
+	bobl::profile::EncodeProbe<T> probe;
 	std::vector<std::uint8_t> buffer;
 	encoder::details::Handler<T, bobl::Options<Options...>>::encode(buffer, value);
 	return buffer;
@@ -52,6 +54,7 @@ auto encode(Iterator out, T const& value)
 									boost::fusion::traits::is_sequence<T>, 
 									bobl::utility::NamedSequence<T, typename bobl::bson::EffectiveOptions<T, Options...>::type>>::value, Iterator>::type
 {
+	bobl::profile::EncodeProbe<T> probe;
 	return encoder::details::Handler<T, bobl::Options<Options...>>::encode(out, value);
 }
 
@@ -12,6 +12,7 @@
 #include "bobl/utility/adapter.hpp"
 #include "bobl/utility/diversion.hpp"
 #include "bobl/utility/names.hpp"
+#include "bobl/utility/stats.hpp"
 #include "bobl/names.hpp"
 #include <boost/mpl/remove.hpp>
 #include <boost/mpl/bool_fwd.hpp>
@@ -19,6 +20,7 @@
 #include <boost/variant/static_visitor.hpp>
 #include <boost/endian/conversion.hpp>
 #include <type_traits>
+#include <utility>
 #include <cstdint>
 
 namespace bobl{ namespace bson { namespace flyweight{ 
@@ -113,6 +115,7 @@ private:
 		}
 		catch (bobl::IncorrectObjectType&)
 		{
+			bobl::stats::exception();
 		}
 		begin = header.position();
 		return { diversion::nullopt };
@@ -163,9 +166,35 @@ public:
 	static NameValue decode(bobl::bson::flyweight::Iterator& begin, bobl::bson::flyweight::Iterator end, NameType const& /*ename*/)
 	{
 		auto header = bobl::bson::flyweight::details::ObjectHeader{ begin, end };
+#if __cplusplus >= 201703L
+		return decode_as(std::move(header), begin, end, std::make_index_sequence<std::tuple_size<TypesTuple>::value>{});
+#else
 		return decode_as<0>(std::move(header), begin, end);
+#endif
 	}
 private:
+#if __cplusplus >= 201703L
+	template<std::size_t ...N>
+	static NameValue decode_as(details::ObjectHeader&& header, bobl::bson::flyweight::Iterator& begin, bobl::bson::flyweight::Iterator end, std::index_sequence<N...>)
+	{
+		auto handler = diversion::optional<ValueHandler>{};
+		if (!(decode_as<N>(header, begin, end, handler) || ...))
+			throw bobl::IncorrectObjectName{ str(boost::format("unexpected BSON object name : \"%1%\"") % header.name()) };
+		return NameValue{ std::move(*handler) };
+	}
+
+	// decodes alternative N if header names its type
+	template<std::size_t N>
+	static bool decode_as(details::ObjectHeader& header, bobl::bson::flyweight::Iterator& begin, bobl::bson::flyweight::Iterator end, diversion::optional<ValueHandler>& handler)
+	{
+		using Type = std::tuple_element_t<N, TypesTuple>;
+		using Handler = typename details::EffectiveValueHandler<Type, Options>::type;
+		if (header.name().compare(bobl::TypeName<Type>{}()) != 0)
+			return false;
+		handler.emplace(Handler::decode(std::move(header), begin, end));
+		return true;
+	}
+#else
 	template<std::size_t N>
 	static auto decode_as(details::ObjectHeader&& header, bobl::bson::flyweight::Iterator& begin, bobl::bson::flyweight::Iterator end) 
 		-> typename std::enable_if<std::tuple_size<TypesTuple>::value != N, NameValue>::type
@@ -183,6 +212,7 @@ private:
 	{
 		throw bobl::IncorrectObjectName{ str(boost::format("unexpected BSON object name : \"%1%\"") % header.name()) };
 	}
+#endif
 private:
 	ValueHandler handler_;
 };
@@ -0,0 +1,128 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/bson/details/header.hpp"
+#include "bobl/bson/details/value.hpp"
+#include "bobl/bson/flyweight.hpp"
+#include "bobl/bson/bson.hpp"
+#include "bobl/utility/arena.hpp"
+#include "bobl/utility/hash.hpp"
+#include "bobl/utility/any.hpp"
+#include "bobl/utility/diversion.hpp"
+#include "bobl/bobl.hpp"
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace bson { 
+
+// Open addressing name to element table built by a single walk over the document, find(name) is O(1).
+// Recursive index also holds nested elements under their dotted path: "header.seq", "values.1.name".
+// All the memory comes from the arena, the document and the arena have to outlive the index.
+// If the document contains the same name more than once the first one is found.
+class IndexedDocument
+{
+	struct Entry
+	{
+		std::uint32_t hash;
+		std::uint32_t begin;	// element offset
+		std::uint32_t end;
+		std::uint32_t parent;	// enclosing element entry or NoParent
+	};
+	static constexpr std::uint32_t NoParent = (std::numeric_limits<std::uint32_t>::max)();
+public:
+	using Any = bobl::flyweight::lite::Any<bobl::bson::flyweight::Iterator>;
+	enum class Mode { TopLevel, Recursive };
+
+	IndexedDocument(flyweight::Document const& document, bobl::utility::Arena& arena, Mode mode = Mode::TopLevel)
+	{
+		auto value = document.value();
+		build(value.begin(), value.end(), arena, mode);
+	}
+
+	IndexedDocument(bobl::flyweight::lite::Object<bobl::bson::flyweight::Iterator> const& object, bobl::utility::Arena& arena, Mode mode = Mode::TopLevel)
+	{
+		auto begin = bobl::flyweight::lite::utility::details::begin_raw(object);
+		auto value = flyweight::details::EmbeddedDocument::decode_as<bobl::bson::EmbeddedDocument>(begin, bobl::flyweight::lite::utility::details::end_raw(object)).value();
+		build(value.begin(), value.end(), arena, mode);
+	}
+
+	std::size_t size() const { return size_; }
+
+	diversion::optional<Any> find(diversion::string_view name) const
+	{
+		auto hash = bobl::utility::hash::fnv1a(name.data(), name.data() + name.size());
+		for (auto i = hash & mask_; slots_[i] != 0; i = (i + 1) & mask_)
+		{
+			auto const& entry = entries_[slots_[i] - 1];
+			if (entry.hash == hash && match(entry, name))
+				return Any{ base_ + entry.begin, base_ + entry.end };
+		}
+		return diversion::nullopt;
+	}
+private:
+	void build(flyweight::Iterator begin, flyweight::Iterator end, bobl::utility::Arena& arena, Mode mode)
+	{
+		base_ = begin;
+		auto space = arena.available<Entry>();
+		index(begin, end, NoParent, bobl::utility::hash::FnvOffsetBasis, mode, space.first, space.second);
+		entries_ = arena.allocate<Entry>(size_);
+
+		auto capacity = std::size_t{ 1 };
+		while (capacity < size_ * 2)
+			capacity <<= 1;
+		mask_ = std::uint32_t(capacity - 1);
+		auto slots = arena.allocate<std::uint32_t>(capacity);
+		std::fill_n(slots, capacity, std::uint32_t(0));
+		for (auto n = std::size_t{ 0 }; n != size_; ++n)
+		{
+			auto i = entries_[n].hash & mask_;
+			while (slots[i] != 0)
+				i = (i + 1) & mask_;
+			slots[i] = std::uint32_t(n + 1);
+		}
+		slots_ = slots;
+	}
+
+	void index(flyweight::Iterator begin, flyweight::Iterator end, std::uint32_t parent, std::uint32_t hash, Mode mode, Entry* entries, std::size_t capacity)
+	{
+		while (begin != end)
+		{
+			auto header = flyweight::details::ObjectHeader{ begin, end };
+			auto next = header.validate(end);
+			if (size_ == capacity)
+				throw std::bad_alloc{};
+			auto name = header.name();
+			auto n = std::uint32_t(size_++);
+			entries[n] = Entry{ bobl::utility::hash::fnv1a(name.data(), name.data() + name.size(), hash), offset(header.position()), offset(next), parent };
+			if (mode == Mode::Recursive && (header.type() == bobl::bson::EmbeddedDocument || header.type() == bobl::bson::Array))
+				index(header.value() + sizeof(std::uint32_t), next - 1/*end of document*/, n, bobl::utility::hash::fnv1a('.', entries[n].hash), mode, entries, capacity);
+			begin = next;
+		}
+	}
+
+	bool match(Entry const& entry, diversion::string_view path) const
+	{
+		for (auto e = &entry;; e = &entries_[e->parent])
+		{
+			auto name = flyweight::details::ObjectHeader{ base_ + e->begin, base_ + e->end }.name();
+			if (e->parent == NoParent)
+				return path.compare(name) == 0;
+			if (path.size() <= name.size() || path[path.size() - name.size() - 1] != '.' || path.substr(path.size() - name.size()).compare(name) != 0)
+				return false;
+			path = path.substr(0, path.size() - name.size() - 1);
+		}
+	}
+
+	std::uint32_t offset(flyweight::Iterator i) const { return std::uint32_t(i - base_); }
+private:
+	flyweight::Iterator base_ = nullptr;
+	Entry const* entries_ = nullptr;
+	std::size_t size_ = 0;
+	std::uint32_t const* slots_ = nullptr;
+	std::uint32_t mask_ = 0;
+};
+
+}/*namespace bson*/ } /*namespace bobl*/
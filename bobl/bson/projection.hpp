@@ -0,0 +1,119 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/bson/details/sequence.hpp"
+#include "bobl/bson/details/header.hpp"
+#include "bobl/bson/details/options.hpp"
+#include "bobl/bson/flyweight.hpp"
+#include "bobl/utility/projection.hpp"
+#include "bobl/options.hpp"
+#include <vector>
+#include <string>
+#include <initializer_list>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace bson {
+
+namespace flyweight { namespace details {
+
+template<typename Projection, typename Options>
+class Projector;
+
+template<typename Projection, typename ...Options>
+class Projector<Projection, bobl::Options<Options...>>
+{
+	class LeafDecoder
+	{
+	public:
+		LeafDecoder(ObjectHeader const& header, flyweight::Iterator end) : header_( header ), end_{ end } {}
+		template<typename T>
+		T decode() const
+		{
+			auto begin = header_.position();
+			return DictionaryObjectDecoder<flyweight::Iterator, Options...>::template decode<T>(ObjectHeader{ header_ }, begin, end_);
+		}
+	private:
+		ObjectHeader const& header_;
+		flyweight::Iterator end_;
+	};
+public:
+	static void project(Document const& document, Projection& projection)
+	{
+		auto active = std::vector<std::size_t>(projection.size());
+		for (auto i = std::size_t{ 0 }; i != active.size(); ++i)
+			active[i] = i;
+		auto value = document.value();
+		project(value.begin(), value.end(), 0, active, projection);
+	}
+private:
+	// every path is matched against the first element with the same name only, the walk is over as soon as all active paths are matched
+	static void project(flyweight::Iterator begin, flyweight::Iterator end, std::size_t depth, std::vector<std::size_t> const& active, Projection& projection)
+	{
+		auto pending = active.size();
+		auto matched = std::vector<bool>(active.size());
+		auto nested = std::vector<std::size_t>{};
+		while (begin != end && pending != 0)
+		{
+			auto header = ObjectHeader{ begin, end };
+			// embedded documents and arrays are skipped by their length prefix
+			auto next = header.validate(end);
+			auto name = header.name();
+			nested.clear();
+			for (auto i = std::size_t{ 0 }; i != active.size(); ++i)
+			{
+				auto const& path = projection.path(active[i]);
+				if (matched[i] || name.compare(path[depth]) != 0)
+					continue;
+				matched[i] = true;
+				--pending;
+				if (path.size() == depth + 1)
+					projection.decode(active[i], LeafDecoder{ header, next });
+				else
+					nested.push_back(active[i]);
+			}
+			if (!nested.empty() && (header.type() == bobl::bson::EmbeddedDocument || header.type() == bobl::bson::Array))
+				project(header.value() + sizeof(std::uint32_t), next - 1/*end of document*/, depth + 1, nested, projection);
+			begin = next;
+		}
+	}
+};
+
+template<typename Result, typename Options, typename Iterator>
+Result project(Iterator& begin, Iterator end, std::vector<bobl::utility::projection::Segments> const& paths)
+{
+	using Projection = bobl::utility::projection::Projection<Result>;
+	auto document = bobl::bson::flyweight::Document::decode(begin, end);
+	auto projection = Projection{ paths };
+	Projector<Projection, Options>::project(document, projection);
+	return std::move(projection).value();
+}
+
+} /*namespace details*/ } /*namespace flyweight*/
+
+// decodes only members referred by Paths (bobl::Path<...>) of T, the rest of the document is skipped
+//	auto res = bobl::bson::project<Message, bobl::Path<0, 1>, bobl::Path<0, 2>>(begin, end); // std::tuple<seq type, ts type>
+template<typename T, typename ...Args, typename Iterator>
+auto project(Iterator& begin, Iterator end)
+	-> typename bobl::utility::projection::PathsTraits<T, typename bobl::utility::projection::Parameters<std::tuple<>, Args...>::type,
+																	typename bobl::utility::projection::Parameters<std::tuple<>, Args...>::Options>::type
+{
+	using Parameters = bobl::utility::projection::Parameters<std::tuple<>, Args...>;
+	using Traits = bobl::utility::projection::PathsTraits<T, typename Parameters::type, typename Parameters::Options>;
+	return bobl::bson::flyweight::details::project<typename Traits::type, typename Parameters::Options>(begin, end, Traits::paths());
+}
+
+// decodes only values referred by dotted paths, the rest of the document is skipped
+//	auto res = bobl::bson::project<int, std::string>(begin, end, {"header.seq", "header.ts"});
+template<typename ...Args, typename Iterator>
+auto project(Iterator& begin, Iterator end, std::initializer_list<diversion::string_view> paths)
+		-> typename bobl::utility::projection::Parameters<std::tuple<>, Args...>::type
+{
+	auto segments = std::vector<bobl::utility::projection::Segments>{};
+	for (auto const& path : paths)
+		segments.push_back(bobl::utility::projection::split(path));
+	using Parameters = bobl::utility::projection::Parameters<std::tuple<>, Args...>;
+	return bobl::bson::flyweight::details::project<typename Parameters::type, typename Parameters::Options>(begin, end, segments);
+}
+
+}/*namespace bson*/ } /*namespace bobl*/
@@ -0,0 +1,197 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/bson/details/encoder.hpp"
+#include "bobl/bson/flyweight.hpp"
+#include "bobl/utility/memory.hpp"
+#include "bobl/utility/file.hpp"
+#include "bobl/utility/iterator.hpp"
+#include "bobl/utility/diversion.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/fusion/support/is_sequence.hpp>
+#include <boost/endian/conversion.hpp>
+#include <boost/format.hpp>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace bson {
+
+namespace details {
+
+// size of the document starting at begin, documents are framed by their 4 bytes length prefix
+inline std::size_t document_size(flyweight::Iterator begin, flyweight::Iterator end)
+{
+	auto size = std::size_t(boost::endian::little_to_native(bobl::utility::read<std::uint32_t>(begin, end)));
+	if (size < sizeof(std::uint32_t) + sizeof(std::uint8_t))
+		throw bobl::InvalidObject{ str(boost::format("invalid BSON document size : %1%") % size) };
+	return size;
+}
+
+} /*namespace details*/
+
+// Sequence of back to back BSON documents in contiguous memory, typically memory mapped file (mongodump .bson).
+// Documents are views into the memory, nothing is copied.
+//	boost::iostreams::mapped_file_source mmap{ path };
+//	auto stream = bobl::bson::DocumentStream{ mmap.data(), mmap.data() + mmap.size() };
+//	while (auto document = stream.next()) ...
+class DocumentStream
+{
+public:
+	template<typename Iterator>
+	DocumentStream(Iterator begin, Iterator end, bool sequential = true)
+		: current_{ reinterpret_cast<flyweight::Iterator>(begin) }, end_{ reinterpret_cast<flyweight::Iterator>(end) }
+	{
+		static_assert(std::is_pointer<Iterator>::value && sizeof(typename std::iterator_traits<Iterator>::value_type) == sizeof(std::uint8_t), "bobl::bson::DocumentStream expects pointers to sizeof(std::uint8_t)");
+		if (sequential)
+			bobl::utility::advise_sequential(current_, std::size_t(end_ - current_));
+	}
+
+	// next document or nullopt at the end of the stream
+	diversion::optional<flyweight::Document> next()
+	{
+		if (current_ == end_)
+			return diversion::nullopt;
+		if (std::size_t(end_ - current_) < sizeof(std::uint32_t))
+			throw bobl::InputToShort{ "truncated BSON document size" };
+		auto size = details::document_size(current_, end_);
+		if (size > std::size_t(end_ - current_))
+			throw bobl::InputToShort{ str(boost::format("truncated BSON document : %1% bytes expected, %2% available") % size % (end_ - current_)) };
+		auto begin = current_;
+		current_ += size;
+		// next document header is going to be touched next
+		if (current_ != end_)
+			bobl::utility::prefetch(current_);
+		return flyweight::Document::decode(begin, current_);
+	}
+
+	flyweight::Iterator position() const { return current_; }
+	bool empty() const { return current_ == end_; }
+private:
+	flyweight::Iterator current_;
+	flyweight::Iterator end_;
+};
+
+// Sequence of back to back BSON documents read from Source in chunks.
+// Source is called as std::size_t(std::uint8_t* buffer, std::size_t size) and returns number of bytes read, 0 at the end of input.
+// Document returned by next() refers reader's buffer and remains valid until the following call.
+template<typename Source>
+class DocumentReader
+{
+public:
+	explicit DocumentReader(Source source, std::size_t capacity = 64 * 1024)
+		: source_( std::move(source) ), buffer_( std::max(capacity, sizeof(std::uint32_t)) ) {}
+
+	diversion::optional<flyweight::Document> next()
+	{
+		if (!fill(sizeof(std::uint32_t)))
+		{
+			if (begin_ != end_)
+				throw bobl::InputToShort{ "truncated BSON document size" };
+			return diversion::nullopt;
+		}
+		auto size = details::document_size(buffer_.data() + begin_, buffer_.data() + end_);
+		if (!fill(size))
+			throw bobl::InputToShort{ str(boost::format("truncated BSON document : %1% bytes expected, %2% available") % size % (end_ - begin_)) };
+		auto begin = buffer_.data() + begin_;
+		begin_ += size;
+		return flyweight::Document::decode(begin, begin + size);
+	}
+private:
+	// makes sure there are at least n bytes buffered, returns false if input is over before that
+	bool fill(std::size_t n)
+	{
+		if (end_ - begin_ >= n)
+			return true;
+		// keeps the tail and reuses the buffer, grows it only for documents larger than the buffer
+		if (begin_ != 0)
+		{
+			std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+			end_ -= begin_;
+			begin_ = 0;
+		}
+		if (buffer_.size() < n)
+			buffer_.resize(n);
+		while (end_ < n)
+		{
+			auto read = source_(buffer_.data() + end_, buffer_.size() - end_);
+			if (read == 0)
+				return false;
+			end_ += read;
+		}
+		return true;
+	}
+private:
+	Source source_;
+	std::vector<std::uint8_t> buffer_;
+	std::size_t begin_ = 0;
+	std::size_t end_ = 0;
+};
+
+template<typename Source>
+DocumentReader<Source> make_document_reader(Source source, std::size_t capacity = 64 * 1024)
+{
+	return DocumentReader<Source>{ std::move(source), capacity };
+}
+
+// Encodes documents back to back into a single reusable buffer, Sink is called as void(std::uint8_t const* data, std::size_t size)
+// once at least capacity bytes are accumulated. flush() has to be called to pass on the rest, it isn't done on destruction.
+template<typename Sink>
+class DocumentWriter
+{
+public:
+	explicit DocumentWriter(Sink sink, std::size_t capacity = 64 * 1024) : sink_( std::move(sink) ), capacity_{ capacity }
+	{
+		buffer_.reserve(capacity);
+	}
+
+	template<typename ...Options, typename T>
+	auto write(T const& value)
+		-> typename std::enable_if<boost::mpl::and_<boost::fusion::traits::is_sequence<T>,
+									bobl::utility::NamedSequence<T, typename bobl::bson::EffectiveOptions<T, Options...>::type>>::value>::type
+	{
+		encoder::details::Handler<T, bobl::Options<Options...>>::encode(buffer_, value);
+		if (buffer_.size() >= capacity_)
+			flush();
+	}
+
+	// appends already encoded document as is
+	void write(flyweight::Document const& document)
+	{
+		auto begin = document.value().begin() - sizeof(std::uint32_t);
+		buffer_.insert(buffer_.end(), begin, begin + document.size());
+		if (buffer_.size() >= capacity_)
+			flush();
+	}
+
+	void flush()
+	{
+		if (buffer_.empty())
+			return;
+		sink_(static_cast<std::uint8_t const*>(buffer_.data()), buffer_.size());
+		buffer_.clear();
+	}
+
+	std::size_t buffered() const { return buffer_.size(); }
+private:
+	Sink sink_;
+	std::size_t capacity_;
+	std::vector<std::uint8_t> buffer_;
+};
+
+template<typename Sink>
+DocumentWriter<Sink> make_document_writer(Sink sink, std::size_t capacity = 64 * 1024)
+{
+	return DocumentWriter<Sink>{ std::move(sink), capacity };
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+using bobl::utility::FileSource;
+using bobl::utility::FileSink;
+#endif
+
+}/*namespace bson*/ } /*namespace bobl*/
@@ -0,0 +1,280 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/bson/details/header.hpp"
+#include "bobl/bson/details/options.hpp"
+#include "bobl/bson/bson.hpp"
+#include "bobl/utility/transcoder.hpp"
+#include "bobl/utility/iterator.hpp"
+#include "bobl/utility/float.hpp"
+#include "bobl/utility/diversion.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/endian/conversion.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace transcoder{
+
+template<>
+class Reader<bobl::bson::NsTag>
+{
+	using Iterator = bobl::bson::flyweight::Iterator;
+	using ObjectHeader = bobl::bson::flyweight::details::ObjectHeader;
+public:
+	template<typename Writer>
+	static void read(Iterator& begin, Iterator end, Writer& writer)
+	{
+		document(begin, end, writer, false);
+	}
+
+	template<typename Writer>
+	static void read(char const*& begin, char const* end, Writer& writer)
+	{
+		auto first = reinterpret_cast<Iterator>(begin);
+		read(first, reinterpret_cast<Iterator>(end), writer);
+		begin = reinterpret_cast<char const*>(first);
+	}
+private:
+	template<typename T>
+	static T read_little(Iterator begin, Iterator end) { return boost::endian::little_to_native(bobl::utility::read<T>(begin, end)); }
+
+	static std::size_t count(Iterator begin, Iterator end)
+	{
+		auto res = std::size_t{ 0 };
+		for (; begin != end; ++res)
+			begin = ObjectHeader{ begin, end }.validate(end);
+		return res;
+	}
+
+	template<typename Writer>
+	static void document(Iterator& begin, Iterator end, Writer& writer, bool array)
+	{
+		auto size = read_little<std::uint32_t>(begin, end);
+		if (size < sizeof(std::uint32_t) + 1 || std::size_t(std::distance(begin, end)) < size)
+			throw bobl::InvalidObject{ "not enough data provided to construct BSON document" };
+		auto last = begin + size - 1;
+		if (*last != 0)
+			throw bobl::InvalidObject{ "BSON document is not terminated" };
+		begin += sizeof(std::uint32_t);
+		auto n = count(begin, last);
+		if (array)
+			writer.begin_array(n);
+		else
+			writer.begin_object(n);
+		while (begin != last)
+		{
+			auto header = ObjectHeader{ begin, last };
+			auto next = header.validate(last);
+			if (!array)
+				writer.name(header.name());
+			value(header, next, writer);
+			begin = next;
+		}
+		++begin;
+		if (array)
+			writer.end_array();
+		else
+			writer.end_object();
+	}
+
+	template<typename Writer>
+	static void value(ObjectHeader const& header, Iterator end, Writer& writer)
+	{
+		auto begin = header.value();
+		switch (auto type = header.type())
+		{
+			case bobl::bson::Double:
+				writer.floating_point(bobl::utility::FloatConverter<sizeof(std::uint64_t)>{}(read_little<std::uint64_t>(begin, end)));
+				break;
+			case bobl::bson::Utf8String:
+			case bobl::bson::Symbol:
+			{
+				auto size = read_little<std::uint32_t>(begin, end);
+				begin += sizeof(std::uint32_t);
+				if (size == 0 || std::size_t(std::distance(begin, end)) != size || begin[size - 1] != 0)
+					throw bobl::InvalidObject{ str(boost::format("BSON string \"%1%\" is malformed") % header.name()) };
+				writer.string(diversion::string_view{ reinterpret_cast<char const*>(begin), size - 1 });
+				break;
+			}
+			case bobl::bson::EmbeddedDocument:
+			case bobl::bson::Array:
+				document(begin, end, writer, type == bobl::bson::Array);
+				if (begin != end)
+					throw bobl::InvalidObject{ str(boost::format("BSON embedded document \"%1%\" is malformed") % header.name()) };
+				break;
+			case bobl::bson::Binary:
+			{
+				auto size = read_little<std::uint32_t>(begin, end);
+				begin += sizeof(std::uint32_t);
+				auto subtype = *begin++;
+				if (std::size_t(std::distance(begin, end)) != size)
+					throw bobl::InvalidObject{ str(boost::format("BSON binary \"%1%\" is malformed") % header.name()) };
+				if ((subtype == bobl::bson::Uuid || subtype == bobl::bson::UuidOld) && size == 16)
+					writer.uuid(begin);
+				else
+					writer.binary(begin, end);
+				break;
+			}
+			case bobl::bson::Bool:
+				writer.boolean(*begin != 0);
+				break;
+			case bobl::bson::UTCDateTime:
+				writer.time_point(read_little<std::int64_t>(begin, end));
+				break;
+			case bobl::bson::Int32:
+				writer.integer(read_little<std::int32_t>(begin, end));
+				break;
+			case bobl::bson::Timestamp:
+				writer.unsigned_integer(read_little<std::uint64_t>(begin, end));
+				break;
+			case bobl::bson::Int64:
+				writer.integer(read_little<std::int64_t>(begin, end));
+				break;
+			case bobl::bson::Null:
+				writer.null();
+				break;
+			default:
+				throw bobl::TypeNotSupported{ str(boost::format("BSON type %1% (%2$#x) can't be transcoded") % to_string(type) % int(type)) };
+		}
+	}
+};
+
+template<typename Sink>
+class Writer<bobl::bson::NsTag, Sink>
+{
+	struct Frame
+	{
+		std::size_t size;	// position of the document size
+		std::size_t index;	// next array index or NotArray for documents
+	};
+	static constexpr std::size_t NotArray = (std::numeric_limits<std::size_t>::max)();
+public:
+	explicit Writer(Sink& sink) : sink_{ sink } {}
+
+	void null() { header(bobl::bson::Null); }
+	void boolean(bool value)
+	{
+		header(bobl::bson::Bool);
+		put(std::uint8_t(value ? 1 : 0));
+	}
+	void integer(std::int64_t value)
+	{
+		if (value < (std::numeric_limits<std::int32_t>::min)() || value > (std::numeric_limits<std::int32_t>::max)())
+		{
+			header(bobl::bson::Int64);
+			little(value);
+		}
+		else
+		{
+			header(bobl::bson::Int32);
+			little(std::int32_t(value));
+		}
+	}
+	void unsigned_integer(std::uint64_t value)
+	{
+		if (value > std::uint64_t((std::numeric_limits<std::int64_t>::max)()))
+			throw bobl::Overflow{ str(boost::format("%1% is too big to be encoded as BSON Int64") % value) };
+		integer(std::int64_t(value));
+	}
+	void floating_point(double value)
+	{
+		header(bobl::bson::Double);
+		little(bobl::utility::FloatConverter<sizeof(std::uint64_t)>{}(value));
+	}
+	void string(diversion::string_view value)
+	{
+		header(bobl::bson::Utf8String);
+		little(std::uint32_t(value.size() + 1));
+		append(value.data(), value.data() + value.size());
+		put(std::uint8_t(0));
+	}
+	void binary(std::uint8_t const* begin, std::uint8_t const* end)
+	{
+		header(bobl::bson::Binary);
+		little(std::uint32_t(std::distance(begin, end)));
+		put(std::uint8_t(bobl::bson::Generic));
+		append(begin, end);
+	}
+	void uuid(std::uint8_t const* data)
+	{
+		header(bobl::bson::Binary);
+		little(std::uint32_t(16));
+		put(std::uint8_t(bobl::bson::Uuid));
+		append(data, data + 16);
+	}
+	void time_point(std::int64_t milliseconds)
+	{
+		header(bobl::bson::UTCDateTime);
+		little(milliseconds);
+	}
+	void begin_array(std::size_t /*size*/) { open(bobl::bson::Array, 0); }
+	void end_array() { close(); }
+	void begin_object(std::size_t /*size*/) { open(bobl::bson::EmbeddedDocument, NotArray); }
+	void name(diversion::string_view name)
+	{
+		if (name.find('\0') != diversion::string_view::npos)
+			throw bobl::InvalidObject{ "BSON element name can't contain '\\0'" };
+		name_ = name;
+	}
+	void end_object() { close(); }
+private:
+	void put(std::uint8_t value) { sink_.push_back(typename Sink::value_type(value)); }
+
+	template<typename T>
+	void append(T const* begin, T const* end)
+	{
+		auto first = reinterpret_cast<typename Sink::value_type const*>(begin);
+		sink_.insert(std::end(sink_), first, first + std::distance(begin, end) * sizeof(T));
+	}
+
+	template<typename T>
+	void little(T value)
+	{
+		value = boost::endian::native_to_little(value);
+		auto begin = reinterpret_cast<std::uint8_t const*>(&value);
+		append(begin, begin + sizeof(value));
+	}
+
+	void header(bobl::bson::Type type)
+	{
+		if (stack_.empty())
+			throw bobl::TypeNotSupported{ str(boost::format("BSON document root must be an object, not %1%") % to_string(type)) };
+		put(std::uint8_t(type));
+		auto& frame = stack_.back();
+		if (frame.index != NotArray)
+		{
+			details::Decimal index{ frame.index++ };
+			append(index.view().data(), index.view().data() + index.view().size());
+		}
+		else
+			append(name_.data(), name_.data() + name_.size());
+		put(std::uint8_t(0));
+	}
+
+	void open(bobl::bson::Type type, std::size_t index)
+	{
+		if (!stack_.empty())
+			header(type);
+		stack_.push_back(Frame{ sink_.size(), index });
+		little(std::uint32_t(0));
+	}
+
+	void close()
+	{
+		put(std::uint8_t(0));
+		auto size = boost::endian::native_to_little(std::uint32_t(sink_.size() - stack_.back().size));
+		std::copy_n(reinterpret_cast<std::uint8_t const*>(&size), sizeof(size), reinterpret_cast<std::uint8_t*>(&sink_[stack_.back().size]));
+		stack_.pop_back();
+	}
+private:
+	Sink& sink_;
+	diversion::string_view name_;
+	std::vector<Frame> stack_;
+};
+
+}/*namespace transcoder*/} /*namespace bobl*/
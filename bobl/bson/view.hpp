@@ -0,0 +1,35 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/bson/details/sequence.hpp"
+#include "bobl/bson/details/options.hpp"
+#include "bobl/bson/flyweight.hpp"
+#include "bobl/utility/view.hpp"
+#include "bobl/options.hpp"
+#include <functional>
+
+namespace bobl{ namespace bson { 
+
+// typed view over BSON document, members are decoded on access, see bobl::utility::LazyDictionary
+//	auto view = bobl::bson::view<T>(begin, end);
+//	auto price = view.get<2>(); /*or*/ view.get(&T::price); /*or c++17*/ view.get<&T::price>();
+// document has to outlive the view
+template<typename T, typename Options = bobl::options::None> class View;
+
+template<typename T, typename ...Options>
+class View<T, bobl::Options<Options...>> 
+	: public bobl::utility::LazyDictionary<T, flyweight::Iterator, flyweight::details::DictionaryObjectDecoder<flyweight::Iterator, Options...>, std::equal_to<flyweight::Iterator>, Options...>
+{
+	using Base = bobl::utility::LazyDictionary<T, flyweight::Iterator, flyweight::details::DictionaryObjectDecoder<flyweight::Iterator, Options...>, std::equal_to<flyweight::Iterator>, Options...>;
+public:
+	explicit View(flyweight::Document const& document) : Base{ document.value().begin(), document.value().end() } {}
+};
+
+// begin is not advanced, same as bobl::cbor::view
+template<typename T, typename Options = bobl::options::None, typename Iterator>
+View<T, Options> view(Iterator begin, Iterator end)
+{
+	return View<T, Options>{ bobl::bson::flyweight::Document::decode(begin, end) };
+}
+
+}/*namespace bson*/ } /*namespace bobl*/
@@ -27,6 +27,7 @@ enum Type : std::uint8_t
 	False = SimpleValue | 20,
 	True = SimpleValue | 21,
 	Null = SimpleValue | 22,
+	Undefined = SimpleValue | 23,
 	Float16 = SimpleValue | 25,
 	Float32 = SimpleValue | 26,
 	Float64 = SimpleValue | 27,
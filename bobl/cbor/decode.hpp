@@ -7,6 +7,8 @@
 #include "bobl/cbor/cbor.hpp"
 #include "bobl/utility/flyweight.hpp"
 #include "bobl/utility/parameters.hpp"
+#include "bobl/utility/stats.hpp"
+#include "bobl/utility/profile.hpp"
 #include <type_traits>
 
 namespace bobl{ namespace cbor { 
@@ -130,7 +132,14 @@ auto decode(Iterator& begin, Iterator end) -> typename bobl::utility::DecodePara
 {
 	using Parameters = bobl::utility::DecodeParameters<bobl::cbor::NsTag, Args...>;
 	using Decoder = typename decoder::details::Decoder<typename Parameters::Result, typename Parameters::Options>::type;
-	return Decoder::decode(begin, end);
+	auto position = bobl::stats::position(begin);
+	auto res = bobl::profile::measure<typename Parameters::Result, bobl::profile::Operation::Decode>([&begin, end]()
+	{
+		bobl::cbor::stringref::Namespace<Iterator, bobl::cbor::stringref::Enabled<typename Parameters::Options>::value> strings{ begin, end };
+		return Decoder::decode(begin, end);
+	});
+	bobl::stats::scanned(position, begin);
+	return res;
 }
 
 }/*namespace cbor*/ } /*namespace bobl*/
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "bobl/cbor/details/utility.hpp"
 #include "bobl/cbor/details/options.hpp"
+#include "bobl/cbor/details/stringref.hpp"
 #include "bobl/cbor/options.hpp"
 #include "bobl/cbor/adapter.hpp"
 #include "bobl/cbor/cbor.hpp"
@@ -12,10 +13,13 @@
 #include "bobl/utility/options.hpp"
 #include "bobl/utility/has_is.hpp"
 #include "bobl/utility/utils.hpp"
+#include "bobl/utility/utf8.hpp"
+#include "bobl/utility/intern.hpp"
 #include "bobl/utility/type_name.hpp"
 #include "bobl/utility/names.hpp"
 #include "bobl/utility/adapter.hpp"
 #include "bobl/utility/decoders.hpp"
+#include "bobl/utility/stats.hpp"
 #include "bobl/utility/parameters.hpp"
 #include "bobl/utility/diversion.hpp"
 #include "bobl/options.hpp"
@@ -35,6 +39,7 @@
 #include <vector>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <cstdint>
 #include <cassert>
 
@@ -79,35 +84,116 @@ public:
 template<typename T, typename Options>
 class Handler<std::basic_string<T>, Options, boost::mpl::true_> 
 {
+	using StringRefs = bobl::cbor::stringref::Enabled<typename bobl::cbor::EffectiveOptions<std::basic_string<T>, Options>::type>;
 public:
 	constexpr static bool is(cbor::Type type)
 	{
-		return bobl::cbor::utility::decode::major_type(type) == cbor::MajorType::TextString;
+		return bobl::cbor::utility::decode::major_type(type) == cbor::MajorType::TextString || bobl::cbor::stringref::maybe_reference(type, StringRefs{});
 	}
 
 	template<typename Iterator> 
 	static std::basic_string<T> decode(Iterator& begin, Iterator end)
 	{
+		auto res = decode_string(begin, end);
+		if (sizeof(T) == 1 && bobl::utility::options::Contains<typename bobl::cbor::EffectiveOptions<std::basic_string<T>, Options>::type, bobl::options::ValidateUtf8>::value)
+			validate(reinterpret_cast<std::uint8_t const*>(res.data()), res.size());
+		return res;
+	}
+private:
+	template<typename Iterator>
+	static std::basic_string<T> decode_string(Iterator& begin, Iterator end)
+	{
+		auto referenced = bobl::cbor::stringref::resolve<cbor::MajorType::TextString>(begin, end, StringRefs{});
+		if (referenced.first != referenced.second)
+			return { referenced.first, referenced.second };
 		bobl::cbor::utility::decode::validate<cbor::MajorType::TextString>(begin, end);
-		assert(is(bobl::cbor::utility::decode::type(*begin)) && "cbor string::is is broken");
-		return bobl::cbor::utility::decode::string<std::basic_string<T>>(begin, end);
+		assert(bobl::cbor::utility::decode::major_type(*begin) == cbor::MajorType::TextString && "cbor string::is is broken");
+		auto header = begin;
+		auto res = bobl::cbor::utility::decode::string<std::basic_string<T>>(begin, end);
+		bobl::cbor::stringref::record(header, begin, StringRefs{});
+		return res;
+	}
+
+	static void validate(std::uint8_t const* data, std::size_t size)
+	{
+		auto invalid = bobl::utility::utf8::find_invalid(data, data + size);
+		if (invalid != data + size)
+			throw bobl::InvalidObject{ str(boost::format("CBOR text string isn't valid UTF-8, invalid sequence at offset %1%") % (invalid - data)) };
+	}
+};
+
+template<typename Options>
+class Handler<bobl::utility::InternedString, Options, boost::mpl::true_>
+{
+	using String = Handler<std::string, Options>;
+	using StringRefs = bobl::cbor::stringref::Enabled<typename bobl::cbor::EffectiveOptions<bobl::utility::InternedString, Options>::type>;
+public:
+	constexpr static bool is(cbor::Type type) { return String::is(type); }
+
+	template<typename Iterator>
+	static bobl::utility::InternedString decode(Iterator& begin, Iterator end)
+	{
+		return decode(begin, end, std::is_pointer<Iterator>{});
+	}
+private:
+	// definite length string is interned straight from the buffer, so repeated strings aren't allocated
+	template<typename Iterator>
+	static bobl::utility::InternedString decode(Iterator& begin, Iterator end, std::true_type)
+	{
+		auto referenced = bobl::cbor::stringref::resolve<cbor::MajorType::TextString>(begin, end, StringRefs{});
+		if (referenced.first != referenced.second)
+			return intern(referenced.first, referenced.second);
+		bobl::cbor::utility::decode::validate<cbor::MajorType::TextString>(begin, end);
+		auto header = begin;
+		auto len = bobl::cbor::utility::decode::length(begin, end);
+		if (len == bobl::cbor::utility::decode::IndefiniteLength)
+			return decode(begin = header, end, std::false_type{});
+		if (decltype(len)(std::distance(begin, end)) < len)
+			throw bobl::InvalidObject{ "not enough data provided to decode CBOR string" };
+		auto first = begin;
+		std::advance(begin, len);
+		bobl::cbor::stringref::record(header, begin, StringRefs{});
+		return intern(first, begin);
+	}
+
+	template<typename Iterator>
+	static bobl::utility::InternedString intern(Iterator first, Iterator last)
+	{
+		auto value = diversion::string_view{ reinterpret_cast<char const*>(first), std::size_t(last - first) };
+		if (bobl::utility::options::Contains<typename bobl::cbor::EffectiveOptions<bobl::utility::InternedString, Options>::type, bobl::options::ValidateUtf8>::value
+			&& !bobl::utility::utf8::valid(value.data(), value.size()))
+			throw bobl::InvalidObject{ "CBOR text string isn't valid UTF-8" };
+		return bobl::utility::intern(value);
+	}
+
+	template<typename Iterator>
+	static bobl::utility::InternedString decode(Iterator& begin, Iterator end, std::false_type)
+	{
+		return bobl::utility::intern(String::decode(begin, end));
 	}
 };
 
 template<typename T, typename Options>
 class Handler<std::vector<T>, Options, typename bobl::utility::IsByteType<T, Options>::type>
 {
+	using StringRefs = bobl::cbor::stringref::Enabled<typename bobl::cbor::EffectiveOptions<std::vector<T>, Options>::type>;
 public:
 	constexpr static bool is(cbor::Type type)
 	{
-		return bobl::cbor::utility::decode::major_type(type) == cbor::MajorType::ByteString;
+		return bobl::cbor::utility::decode::major_type(type) == cbor::MajorType::ByteString || bobl::cbor::stringref::maybe_reference(type, StringRefs{});
 	}
 	template<typename Iterator>
 	static std::vector<T> decode(Iterator& begin, Iterator end)
 	{
+		auto referenced = bobl::cbor::stringref::resolve<cbor::MajorType::ByteString>(begin, end, StringRefs{});
+		if (referenced.first != referenced.second)
+			return { referenced.first, referenced.second };
 		bobl::cbor::utility::decode::validate<cbor::MajorType::ByteString>(begin, end);
-		assert(is(bobl::cbor::utility::decode::type(*begin)) && "cbor byte string::is is broken");
-		return bobl::cbor::utility::decode::string<std::vector<T>>(begin, end);
+		assert(bobl::cbor::utility::decode::major_type(*begin) == cbor::MajorType::ByteString && "cbor byte string::is is broken");
+		auto header = begin;
+		auto res = bobl::cbor::utility::decode::string<std::vector<T>>(begin, end);
+		bobl::cbor::stringref::record(header, begin, StringRefs{});
+		return res;
 	}
 };
 
@@ -145,6 +231,7 @@ public:
 				res.emplace_back(Handler<T, Options>::decode(begin, end));
 			}
 		}
+		bobl::stats::elements<T>(res.size());
 		return res;
 	}
 };
@@ -169,10 +256,10 @@ public:
 	{
 		if(begin == end)
 			throw bobl::InputToShort{ "not enought data to decode CBOR value type" };
-		auto type = bobl::cbor::utility::decode::major_type(*begin);
-		if(!is(type))
-			throw bobl::IncorrectObjectType{ str(boost::format("CBOR value has unexpected type: %1$#x insted of expected integer type") % int(type)) };
-		return cast_result<T>(type, utility::decode::integer(begin, end));
+		auto const& initial = bobl::cbor::utility::decode::initial_byte(*begin);
+		if(!is(initial.major_type))
+			throw bobl::IncorrectObjectType{ str(boost::format("CBOR value has unexpected type: %1$#x insted of expected integer type") % int(initial.major_type)) };
+		return cast_result<T>(initial.major_type, utility::decode::integer(initial, begin, end));
 	}
 private:
 	template<typename U>
@@ -233,13 +320,23 @@ public:
 	}
 };
 
+// member key, either text or unsigned integer one (bobl::options::IndexKeys)
 class Name
 {
 public:
 	explicit Name(std::string name) : name_{ name } {}
+	explicit Name(std::uint64_t id) : id_{ id }, indexed_{ true } {}
 	diversion::string_view operator()() const { return name_; }
+	bool indexed() const { return indexed_; }
+	std::uint64_t id() const { return id_; }
+	std::string to_string() const { return indexed_ ? std::to_string(id_) : name_; }
+
+	template<typename NameType>
+	bool matches(NameType const& ename) const { return indexed_ ? ename.compare(id_) : ename.compare(operator()()); }
 private:
 	std::string name_;
+	std::uint64_t id_ = 0;
+	bool indexed_ = false;
 };
 
 
@@ -255,25 +352,27 @@ public:
 			throw bobl::InputToShort{ "not enought data to decode CBOR type" };
 
 		auto i = begin;
-		auto type = bobl::cbor::utility::decode::type(*begin);
-		switch (auto major_type = bobl::cbor::utility::decode::major_type(type))
+		auto const& initial = bobl::cbor::utility::decode::initial_byte(*begin);
+		switch (auto major_type = initial.major_type)
 		{
 			case bobl::cbor::MajorType::SimpleValue:
-				if(type == bobl::cbor::Break)
+				if(initial.is_break)
 					throw bobl::InvalidObject{"unexpected break"};
 			case bobl::cbor::MajorType::UnsignedInt:
 			case bobl::cbor::MajorType::NegativeInt:
-				bobl::cbor::utility::decode::integer(begin, end);
+				bobl::cbor::utility::decode::integer(initial, begin, end);
 				break;
 			case bobl::cbor::MajorType::ByteString:
 			case bobl::cbor::MajorType::TextString:
 			{
-				auto len = bobl::cbor::utility::decode::length(begin, end);
+				auto len = bobl::cbor::utility::decode::length(initial, begin, end);
 				if (len != bobl::cbor::utility::decode::IndefiniteLength)
 				{
 					if (decltype(len)(std::distance(begin, end)) < len)
 						throw bobl::InputToShort(str(boost::format("not enought data to decode CBOR \"%1%\"") % to_string(major_type)));
 					std::advance(begin, len);
+					// skipped strings are numbered too, later references count them
+					bobl::cbor::stringref::record(i, begin, bobl::cbor::stringref::Enabled<Options>{});
 				}
 				else
 				{
@@ -291,11 +390,11 @@ public:
 				decode_array(begin, end, &Handler::decode_pair<Iterator>);
 				break;
 			case bobl::cbor::MajorType::Tag:
-				bobl::cbor::utility::decode::integer(begin, end);
+				bobl::cbor::utility::decode::integer(initial, begin, end);
 				decode(begin, end);
 				break;
 			default:
-				throw bobl::InvalidObject(str(boost::format("CBOR bobl::flyweight::lite::Any decoder does not supported \"%1%\" yet!") % to_string(type)));
+				throw bobl::InvalidObject(str(boost::format("CBOR bobl::flyweight::lite::Any decoder does not supported \"%1%\" yet!") % to_string(bobl::cbor::utility::decode::type(*i))));
 		}
 		return {i, begin};
 	}
@@ -393,7 +492,7 @@ public:
 	static boost::uuids::uuid decode(Iterator& begin, Iterator end)
 	{
 		bobl::cbor::utility::decode::validate_tag<bobl::cbor::UUID>(begin, end);
-		auto data = Handler<std::vector<uint8_t>, bobl::options::None>::decode(begin, end);
+		auto data = Handler<std::vector<uint8_t>, bobl::cbor::stringref::NamespaceOptions<Options>>::decode(begin, end);
 		boost::uuids::uuid res;
 		if (data.size() != sizeof(res.data))
 			throw bobl::InputToShort(str(boost::format("invalid data size of CBOR UUID object (%1 insted of expected %2") % data.size() % sizeof(res.data)));
@@ -432,7 +531,12 @@ class Handler<Name, Options, boost::mpl::true_>
 {
 public:
 	template<typename Iterator>
-	static Name decode(Iterator& begin, Iterator end) { return Name{ Handler<std::string, bobl::options::None>::decode(begin, end) }; }
+	static Name decode(Iterator& begin, Iterator end)
+	{
+		if (begin != end && bobl::cbor::utility::decode::initial_byte(*begin).major_type == cbor::MajorType::UnsignedInt)
+			return Name{ bobl::cbor::utility::decode::integer(begin, end) };
+		return Name{ Handler<std::string, bobl::cbor::stringref::NamespaceOptions<Options>>::decode(begin, end) };
+	}
 };
 
 template<typename T, typename Options>
@@ -458,9 +562,9 @@ public:
 	template<typename Iterator, typename NameType>
 	static NameValue decode(Iterator& begin, Iterator end, NameType const& ename)
 	{
-		auto name = Handler<Name, bobl::options::None>::decode(begin, end);
-		if(!ename.compare(name()))
-			throw bobl::IncorrectObjectName{ str(boost::format("unexpected CBOR object name : \"%1%\" (expected \"%2%\")") % name() % ename.name()) };
+		auto name = Handler<Name, Options>::decode(begin, end);
+		if(!name.matches(ename))
+			throw bobl::IncorrectObjectName{ str(boost::format("unexpected CBOR object name : \"%1%\" (expected \"%2%\")") % name.to_string() % ename.name()) };
 
 		using Decoder = typename Decoder<T, Options>::type;
 		return {std::move(name), Decoder::decode(begin, end) };
@@ -487,8 +591,8 @@ public:
 			return { };
 
 		auto tmp = begin;
-		auto name = Handler<Name, bobl::options::None>::decode(begin, end);
-		return ename.compare(name()) ? NameValue{ std::move(name), decode_null(begin, end) ? diversion::optional<T>{} : diversion::make_optional(Decoder::decode(begin, end)) }
+		auto name = Handler<Name, Options>::decode(begin, end);
+		return name.matches(ename) ? NameValue{ std::move(name), decode_null(begin, end) ? diversion::optional<T>{} : diversion::make_optional(Decoder::decode(begin, end)) }
 									: (begin = tmp, NameValue{});
 	}
 
@@ -514,7 +618,7 @@ private:
 		if (begin != end)
 		{
 			Iterator tmp = begin;
-			auto name = Handler<Name, bobl::options::None>::decode(begin, end);
+			auto name = Handler<Name, Options>::decode(begin, end);
 			try
 			{
 				if (!is_null(begin, end))
@@ -523,6 +627,7 @@ private:
 			}
 			catch (IncorrectObjectType&)
 			{
+				bobl::stats::exception();
 				begin = tmp;
 			}
 		}
@@ -535,7 +640,7 @@ private:
 		if (begin != end)
 		{
 			Iterator tmp = begin;
-			auto name = Handler<Name, bobl::options::None>::decode(begin, end);
+			auto name = Handler<Name, Options>::decode(begin, end);
 			if (Decoder::is(bobl::cbor::utility::decode::type(*begin)))
 				return { std::move(name), Decoder::decode(begin, end) };
 			if(is_null(begin, end))
@@ -583,13 +688,38 @@ public:
 	template<typename Iterator>
 	static NameValue decode(Iterator& begin, Iterator end)
 	{
-		return decode_as<0>(Handler<Name, bobl::options::None>::decode(begin, end), begin, end);
+#if __cplusplus >= 201703L
+		return decode_as(Handler<Name, Options>::decode(begin, end), begin, end, std::make_index_sequence<std::tuple_size<TypesTuple>::value>{});
+#else
+		return decode_as<0>(Handler<Name, Options>::decode(begin, end), begin, end);
+#endif
 	}
 
 	template<typename Iterator, typename NameType>
 	static NameValue decode(Iterator& begin, Iterator end, NameType const& /*ename*/) { return decode(begin, end); }
 private:
-private:
+#if __cplusplus >= 201703L
+	template<typename Iterator, std::size_t ...N>
+	static NameValue decode_as(Name const& name, Iterator& begin, Iterator end, std::index_sequence<N...>)
+	{
+		auto value = diversion::optional<Value>{};
+		if (!(decode_as<N>(name, begin, end, value) || ...))
+			throw bobl::IncorrectObjectName{ str(boost::format("unexpected CBOR object name : \"%1%\"") % name.to_string()) };
+		return NameValue{ std::move(*value) };
+	}
+
+	// decodes alternative N if name is its type name
+	template<std::size_t N, typename Iterator>
+	static bool decode_as(Name const& name, Iterator& begin, Iterator end, diversion::optional<Value>& value)
+	{
+		using Type = std::tuple_element_t<N, TypesTuple>;
+		using Decoder = typename Decoder<Type, Options>::type;
+		if (name().compare(bobl::TypeName<Type>{}()) != 0)
+			return false;
+		value.emplace(Decoder::decode(begin, end));
+		return true;
+	}
+#else
 	template<std::size_t N, typename Iterator>
 	static auto decode_as(Name const& name, Iterator& begin, Iterator end) 
 		-> typename std::enable_if<std::tuple_size<TypesTuple>::value != N, NameValue>::type
@@ -605,8 +735,9 @@ private:
 	static auto decode_as(Name const& name, Iterator& /*begin*/, Iterator /*end*/)
 		-> typename std::enable_if<std::tuple_size<TypesTuple>::value == N, NameValue>::type
 	{
-		throw bobl::IncorrectObjectName{ str(boost::format("unexpected CBOR object name : \"%1%\"") % name()) };
+		throw bobl::IncorrectObjectName{ str(boost::format("unexpected CBOR object name : \"%1%\"") % name.to_string()) };
 	}
+#endif
 private:
 	Value value_;
 };
@@ -737,16 +868,44 @@ public:
 				throw bobl::InvalidObject{ "CBOR dictionary contains more objects than expected" };
 
 			using AnyTypeHandler = Handler<bobl::flyweight::lite::Any<Iterator>, typename cbor::EffectiveOptions<T, Options...>::type >;
+			auto position = bobl::stats::position(begin);
 			if (len == bobl::cbor::utility::decode::IndefiniteLength)
 				AnyTypeHandler::decode_sequence(begin, end, &AnyTypeHandler::decode_pair);
 			else
 				AnyTypeHandler::decode_sequence(n, begin, end, &AnyTypeHandler::decode_pair);
+			bobl::stats::skipped(position, begin);
 
 		}
 		return res;
 	}
 };
 
+// end of object predicate for both definite and indefinite length maps
+class EndOfMap
+{
+public:
+	explicit EndOfMap(std::uint64_t len) : len_{ len } {}
+	template<typename Iterator>
+	bool operator()(Iterator& begin, Iterator end)
+	{
+		if (len_ == 0)
+			return true;
+		if (begin == end)
+			throw bobl::InputToShort{ "not enought data to decode CBOR map type" };
+		if (len_ != bobl::cbor::utility::decode::IndefiniteLength)
+		{
+			--len_;
+			return false;
+		}
+		auto val = *begin == bobl::cbor::Break;
+		if (val)
+			++begin;
+		return val;
+	}
+private:
+	std::uint64_t len_;
+};
+
 template<typename Iterator, typename ...Options>
 class DictionaryValueDecoder
 {
@@ -759,6 +918,8 @@ public:
 
 
 	static diversion::string_view name(Name const& name) { return name(); }
+	static bool indexed(Name const& name) { return name.indexed(); }
+	static std::uint64_t id(Name const& name) { return name.id(); }
 	static Name decode_name(Iterator& begin, Iterator end) { return decode<Name>(begin, end); }
 
 	template<typename T>
@@ -779,44 +940,13 @@ class Handler<T, bobl::Options<Options...>, typename boost::mpl::and_<boost::fus
 																	bobl::utility::options::Contains<typename bobl::cbor::EffectiveOptions<T, Options...>::type, bobl::options::StructAsDictionary>,
 																	bobl::utility::DictionaryDecoderCompatible<T, typename bobl::cbor::EffectiveOptions<T, Options...>::type>>::type>
 {
-	struct Break
-	{
-		template<typename Iterator>
-		bool operator()(Iterator& begin, Iterator end) const
-		{
-			if (begin == end)
-				throw bobl::InputToShort{ "not enought data to decode CBOR map type" };
-			auto val = *begin == bobl::cbor::Break;
-			if (val)
-				++begin;
-			return val;
-		}
-	};
-
-	class Counter
-	{
-	public:
-		explicit Counter(std::size_t counter) : counter_{ counter } {}
-		template<typename Iterator>
-		bool operator()(Iterator begin, Iterator end)
-		{
-			bool res = counter_-- == 0;
-			if(!res && begin == end)
-				throw bobl::InputToShort{ "not enought data to decode CBOR map type" };
-			return res;
-		}
-	private:
-		std::size_t counter_;
-	};
 public:
 	template<typename Iterator>
 	static T decode(Iterator& begin, Iterator end)
 	{
 		bobl::cbor::utility::decode::validate<cbor::MajorType::Dictionary>(begin, end);
 		auto len = bobl::cbor::utility::decode::length(begin, end);
-		return  len != bobl::cbor::utility::decode::IndefiniteLength
-					? bobl::utility::DictionaryDecoder<T, bobl::cbor::decoder::details::DictionaryValueDecoder<Iterator>, Options...>{}(begin, end, Counter{ std::size_t(len) })
-					: bobl::utility::DictionaryDecoder<T, bobl::cbor::decoder::details::DictionaryValueDecoder<Iterator>, Options...>{}(begin, end, Break{});
+		return bobl::utility::DictionaryDecoder<T, bobl::cbor::decoder::details::DictionaryValueDecoder<Iterator>, Options...>{}(begin, end, EndOfMap{ len });
 	}
 };
 
@@ -852,6 +982,7 @@ private:
 			}
 			catch (bobl::IncorrectObjectType&)
 			{
+				bobl::stats::exception();
 			}
 			begin = i;
 		}
@@ -901,6 +1032,7 @@ private:
 		}
 		catch (bobl::IncorrectObjectType&)
 		{
+			bobl::stats::exception();
 		}
 		begin = i;
 		return try_decode<Iterator, Args...>(begin, end);
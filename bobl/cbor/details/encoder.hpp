@@ -3,6 +3,7 @@
 #pragma once
 #include "bobl/cbor/details/utility.hpp"
 #include "bobl/cbor/details/options.hpp"
+#include "bobl/cbor/details/stringref.hpp"
 #include "bobl/cbor/adapter.hpp"
 #include "bobl/cbor/cbor.hpp"
 #include "bobl/utility/encoders.hpp"
@@ -10,11 +11,15 @@
 #include "bobl/utility/nvariant.hpp"
 #include "bobl/utility/timepoint.hpp"
 #include "bobl/utility/options.hpp"
+#include "bobl/utility/utf8.hpp"
+#include "bobl/utility/intern.hpp"
 #include "bobl/utility/float.hpp"
 #include "bobl/utility/parameters.hpp"
 #include "bobl/utility/adapter.hpp"
 #include "bobl/utility/names.hpp"
+#include "bobl/utility/profile.hpp"
 #include "bobl/utility/diversion.hpp"
+#include "bobl/utility/parallel.hpp"
 #include "bobl/names.hpp"
 #include "bobl/bobl.hpp"
 #include <boost/fusion/include/at.hpp>
@@ -32,6 +37,8 @@
 #include <algorithm>
 #include <iterator>
 #include <type_traits>
+#include <utility>
+#include <cstddef>
 #include <cstdint>
 #include <cassert>
 
@@ -60,6 +67,11 @@ public:
 	template<typename Iterator>
 	static Iterator encode(Iterator out, diversion::string_view const& value)
 	{
+		if (bobl::utility::options::Contains<typename bobl::cbor::EffectiveOptions<diversion::string_view, Options>::type, bobl::options::ValidateUtf8>::value
+			&& !bobl::utility::utf8::valid(value.data(), value.size()))
+			throw bobl::InvalidObject{ "string isn't valid UTF-8 and can't be encoded as CBOR text string" };
+		if (bobl::cbor::stringref::encode_reference(out, bobl::cbor::MajorType::TextString, value.data(), value.size()))
+			return out;
 		out = bobl::cbor::utility::encode::unsigned_int(out, bobl::cbor::MajorType::TextString, value.length());
 		return std::copy(std::begin(value), std::end(value), out);
 	}
@@ -76,6 +88,23 @@ public:
 	}
 };
 
+template<typename Options>
+class Handler<bobl::utility::InternedString, Options, boost::mpl::true_>
+{
+public:
+	template<typename Iterator>
+	static Iterator encode(Iterator out, bobl::utility::InternedString const& value)
+	{
+		return Handler<diversion::string_view, Options>::encode(out, diversion::string_view{ value });
+	}
+};
+
+// struct member key, either its name or its bobl::MemberId if bobl::options::IndexKeys is set
+template<typename Iterator>
+Iterator encode_key(Iterator out, diversion::string_view name) { return Handler<diversion::string_view, bobl::options::None>::encode(std::move(out), name); }
+template<typename Iterator>
+Iterator encode_key(Iterator out, std::uint64_t id) { return bobl::cbor::utility::encode::unsigned_int(std::move(out), bobl::cbor::MajorType::UnsignedInt, id); }
+
 template<typename T, typename Options>
 class Handler<std::vector<T>, Options, typename bobl::utility::IsByteType<T, Options>::type>
 {
@@ -83,6 +112,8 @@ public:
 	template<typename Iterator>
 	static Iterator encode(Iterator out, std::vector<T> const& value)
 	{
+		if (bobl::cbor::stringref::encode_reference(out, bobl::cbor::MajorType::ByteString, reinterpret_cast<char const*>(value.data()), value.size()))
+			return out;
 		out = bobl::cbor::utility::encode::unsigned_int(out, bobl::cbor::MajorType::ByteString, value.size());
 		return std::copy(std::begin(value), std::end(value), out);
 	}
@@ -97,6 +128,8 @@ public:
 	static Iterator encode(Iterator out, boost::uuids::uuid const& value)
 	{
 		out = bobl::cbor::utility::encode::unsigned_int(out, bobl::cbor::MajorType::Tag, std::uint8_t(bobl::cbor::UUID));
+		if (bobl::cbor::stringref::encode_reference(out, bobl::cbor::MajorType::ByteString, reinterpret_cast<char const*>(value.data), sizeof(value.data)))
+			return out;
 		out = bobl::cbor::utility::encode::unsigned_int(out, bobl::cbor::MajorType::ByteString, value.size());
 		return std::copy(value.data, value.data + sizeof(value.data), out);
 	}
@@ -167,6 +200,7 @@ template<typename Options, typename Iterator, typename T>
 inline Iterator encode(Iterator out, T const& value)
 {
 	using Type = typename std::conditional<bobl::utility::Adaptable<T, bobl::cbor::Adapter<T>>::value, bobl::cbor::Adapter<T>, T>::type;
+	bobl::profile::EncodeProbe<T> probe;
 	return Handler<Type, typename bobl::cbor::EffectiveOptions<T, Options>::type>::encode(std::move(out), value);
 }
 
@@ -178,19 +212,37 @@ public:
 	static Iterator encode(Iterator out, T const& sequence)
 	{
 		out = bobl::cbor::utility::encode::unsigned_int(out, bobl::cbor::MajorType::Array, std::size_t(boost::fusion::result_of::size<T>::value));
-		return encode<0>(out, sequence);
+		return encode_members(out, sequence, Members{});
 	}
 private:
-	template<std::size_t N, typename U, typename Iterator>
-	static typename std::enable_if<boost::fusion::result_of::size<U>::value != N, Iterator>::type encode(Iterator out, U const& sequence)
+#if __cplusplus >= 201703L
+	using Members = std::make_index_sequence<boost::fusion::result_of::size<T>::value>;
+
+	template<typename Iterator, std::size_t ...N>
+	static Iterator encode_members(Iterator out, T const& sequence, std::index_sequence<N...>)
 	{
-		using Type = typename boost::fusion::result_of::value_at_c<U, N>::type;
-		out = details::encode<Options, Iterator, Type>(out, boost::fusion::at_c<N>(sequence));
-		return encode<N + 1>(std::move(out), sequence);
+		((out = encode_member<N>(std::move(out), sequence)), ...);
+		return out;
 	}
+#else
+	using Members = std::integral_constant<std::size_t, 0>;
 
-	template<std::size_t N, typename U, typename Iterator>
-	static typename std::enable_if<boost::fusion::result_of::size<U>::value == N, Iterator>::type encode(Iterator out, U const& /*sequence*/) { return out; }
+	template<typename Iterator, std::size_t N>
+	static Iterator encode_members(Iterator out, T const& sequence, std::integral_constant<std::size_t, N>)
+	{
+		return encode_members(encode_member<N>(std::move(out), sequence), sequence, std::integral_constant<std::size_t, N + 1>{});
+	}
+
+	template<typename Iterator>
+	static Iterator encode_members(Iterator out, T const& /*sequence*/, std::integral_constant<std::size_t, boost::fusion::result_of::size<T>::value>) { return out; }
+#endif
+
+	template<std::size_t N, typename Iterator>
+	static Iterator encode_member(Iterator out, T const& sequence)
+	{
+		using Type = typename boost::fusion::result_of::value_at_c<T, N>::type;
+		return details::encode<Options, Iterator, Type>(out, boost::fusion::at_c<N>(sequence));
+	}
 };
 
 template<typename T, typename Options>
@@ -204,37 +256,62 @@ public:
 	{
 		auto n = bobl::utility::CountMembers<bobl::cbor::NsTag, T, Options>{}(sequence);
 		out = bobl::cbor::utility::encode::unsigned_int(out, bobl::cbor::MajorType::Dictionary, n);
-		return encode<0>(out, sequence);
+		return encode_members(out, sequence, Members{});
 	}
 private:
-	template<std::size_t N, typename U, typename Iterator>
-	static typename std::enable_if<boost::fusion::result_of::size<U>::value != N, Iterator>::type encode(Iterator out, U const& sequence)
+#if __cplusplus >= 201703L
+	using Members = std::make_index_sequence<boost::fusion::result_of::size<T>::value>;
+
+	template<typename Iterator, std::size_t ...N>
+	static Iterator encode_members(Iterator out, T const& sequence, std::index_sequence<N...>)
+	{
+		((out = encode_member<N>(std::move(out), sequence)), ...);
+		return out;
+	}
+#else
+	using Members = std::integral_constant<std::size_t, 0>;
+
+	template<typename Iterator, std::size_t N>
+	static Iterator encode_members(Iterator out, T const& sequence, std::integral_constant<std::size_t, N>)
 	{
-		using Type = typename boost::fusion::result_of::value_at_c<U, N>::type;
-		using MemberName = typename bobl::utility::GetNameType<bobl::MemberName<U, Type, N, Options>>::type;
-		out = encode(out, MemberName::name(), boost::fusion::at_c<N>(sequence));
-		return encode<N + 1>(std::move(out), sequence);
+		return encode_members(encode_member<N>(std::move(out), sequence), sequence, std::integral_constant<std::size_t, N + 1>{});
 	}
 
-	template<std::size_t N, typename U, typename Iterator>
-	static typename std::enable_if<boost::fusion::result_of::size<U>::value == N, Iterator>::type encode(Iterator out, U const& /*sequence*/) { return out; }
+	template<typename Iterator>
+	static Iterator encode_members(Iterator out, T const& /*sequence*/, std::integral_constant<std::size_t, boost::fusion::result_of::size<T>::value>) { return out; }
+#endif
 
-	template<typename U, typename Iterator>
-	static Iterator encode(Iterator out, diversion::string_view name, U const& value)
+	using IndexKeys = bobl::utility::options::Contains<typename bobl::cbor::EffectiveOptions<T, Options>::type, bobl::options::IndexKeys>;
+
+	template<std::size_t N, typename Iterator>
+	static Iterator encode_member(Iterator out, T const& sequence)
+	{
+		using Type = typename boost::fusion::result_of::value_at_c<T, N>::type;
+		return encode(out, key<N, Type>(typename IndexKeys::type{}), boost::fusion::at_c<N>(sequence));
+	}
+
+	template<std::size_t N, typename Type>
+	static diversion::string_view key(boost::mpl::false_) { return bobl::utility::GetNameType<bobl::MemberName<T, Type, N, Options>>::type::name(); }
+	template<std::size_t N, typename Type>
+	static std::uint64_t key(boost::mpl::true_) { return bobl::MemberId<T, Type, N, Options>::value; }
+
+	template<typename U, typename Key, typename Iterator>
+	static Iterator encode(Iterator out, Key const& key, U const& value)
 	{
-		out = Handler<diversion::string_view, bobl::options::None>::encode(out, name);
+		out = encode_key(out, key);
 		return details::encode<Options, Iterator, U>(out, value);
 	}
 
-	template<typename U, typename Iterator>
-	static auto encode(Iterator out, diversion::string_view name, diversion::optional<U> const& value)
+	template<typename U, typename Key, typename Iterator>
+	static auto encode(Iterator out, Key const& key, diversion::optional<U> const& value)
 		-> typename std::enable_if<!bobl::utility::Adaptable<diversion::optional<U>, bobl::cbor::Adapter<diversion::optional<U>>>::value, Iterator>::type
 	{
-		return Handler<diversion::optional<U>, typename bobl::cbor::EffectiveOptions<diversion::optional<U>, Options>::type>::encode(out, name, value);
+		return Handler<diversion::optional<U>, typename bobl::cbor::EffectiveOptions<diversion::optional<U>, Options>::type>::encode(out, key, value);
 	}
 
-	template<typename ...Types, typename Iterator>
-	static auto encode(Iterator out, diversion::string_view /*name*/, diversion::variant<Types...> const& value)
+	// the key is the name of the type held
+	template<typename ...Types, typename Key, typename Iterator>
+	static auto encode(Iterator out, Key const& /*key*/, diversion::variant<Types...> const& value)
 		-> typename std::enable_if<bobl::utility::VariantUseTypeName<diversion::variant<Types...>,
 										typename bobl::cbor::EffectiveOptions<diversion::variant<Types...>, Options>::type>::value, Iterator>::type
 	{
@@ -250,22 +327,42 @@ public:
 	static Iterator encode(Iterator out, std::vector<T> const& value)
 	{
 		out = bobl::cbor::utility::encode::unsigned_int(out, bobl::cbor::MajorType::Array, value.size());
+		// strings of stringref namespace are numbered in order, so it is encoded on one thread
+		if (Threshold != 0 && value.size() * sizeof(T) >= Threshold && bobl::cbor::stringref::Encoder::current() == nullptr)
+			return encode_chunks(out, value);
 		for(auto const& i : value)
 			out = details::encode<Options, Iterator, T>(out, i);
 		return out;
 	}
+private:
+	static constexpr std::size_t Threshold = bobl::utility::options::ParallelArrays<Options>::value;
+
+	// array header holds number of elements only, so chunks encoded on shared pool workers are just written after it in order
+	template<typename Iterator>
+	static Iterator encode_chunks(Iterator out, std::vector<T> const& value)
+	{
+		auto chunks = bobl::utility::encode_chunks(bobl::utility::shared_pool(), value.size(), [&value](std::size_t first, std::size_t last, std::vector<std::uint8_t>& buffer)
+		{
+			auto bi = std::back_inserter(buffer);
+			for (auto i = first; i != last; ++i)
+				bi = details::encode<Options, decltype(bi), T>(bi, value[i]);
+		});
+		for (auto const& chunk : chunks)
+			out = std::copy(std::begin(chunk), std::end(chunk), out);
+		return out;
+	}
 };
 
 template<typename T, typename Options>
 class Handler<diversion::optional<T>, Options, boost::mpl::true_>
 {
 public:
-	template<typename Iterator>
-	static Iterator encode(Iterator out, diversion::string_view name, diversion::optional<T> const& value)
+	template<typename Key, typename Iterator>
+	static Iterator encode(Iterator out, Key const& key, diversion::optional<T> const& value)
 	{
 		if (!value == false || bobl::utility::options::Contains<Options, bobl::options::OptionalAsNull>::value)
 		{
-			out = Handler<diversion::string_view, bobl::options::None>::encode(std::move(out), name);
+			out = encode_key(std::move(out), key);
 			out = encode(std::move(out), value);
 		}
 		return out;
@@ -357,11 +454,38 @@ public:
 template<typename Options, typename Iterator, typename T, typename ...Args>
 Iterator encode(Iterator out, T const& value, Args&& ...args)
 {
-	details::Handler<T, Options>::encode(out, value);
+	{
+		bobl::profile::EncodeProbe<T> probe;
+		details::Handler<T, Options>::encode(out, value);
+	}
 	return encoder::details::encode<bobl::Options<Options>>(std::move(out), std::forward<Args>(args)...);
 }
 
 template<typename Options, typename Iterator> Iterator encode(Iterator out) { return out; }
 
+template<typename Options, typename Iterator, typename ...Args>
+Iterator encode_message(Iterator out, std::false_type, Args&& ...args)
+{
+	return details::encode<Options>(std::move(out), std::forward<Args>(args)...);
+}
+
+template<typename Options, typename Iterator, typename ...Args>
+Iterator encode_message(Iterator out, std::true_type, Args&& ...args)
+{
+	static_assert(sizeof...(Args) == 1, "stringref namespace holds single CBOR value");
+	bobl::cbor::stringref::Encoder strings;
+	bobl::cbor::stringref::Scope<bobl::cbor::stringref::Encoder> scope{ &strings };
+	out = bobl::cbor::utility::encode::unsigned_int(out, bobl::cbor::MajorType::Tag, bobl::cbor::stringref::NamespaceTag);
+	return details::encode<Options>(std::move(out), std::forward<Args>(args)...);
+}
+
+// top level value, it is stringref namespace of its own if bobl::options::StringRefs is set
+template<typename Options, typename Iterator, typename ...Args>
+Iterator encode_message(Iterator out, Args&& ...args)
+{
+	using StringRefs = std::integral_constant<bool, bobl::utility::options::Contains<Options, bobl::options::StringRefs>::value>;
+	return encode_message<Options>(std::move(out), StringRefs{}, std::forward<Args>(args)...);
+}
+
 } /*namespace details*/ } /*namespace encoder*/ } /*namespace cbor*/ } /*namespace bobl*/
 
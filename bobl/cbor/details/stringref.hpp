@@ -0,0 +1,278 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/cbor/details/utility.hpp"
+#include "bobl/cbor/cbor.hpp"
+#include "bobl/utility/hash.hpp"
+#include "bobl/utility/options.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/format.hpp>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// stringref extension (http://cbor.schmorp.de/stringref): strings of stringref namespace (tag 256) long enough for reference
+// to be shorter than them are numbered in order of appearance, repeated ones are encoded as tag 25 followed by the number.
+namespace bobl{ namespace cbor { namespace stringref {
+
+constexpr std::uint16_t NamespaceTag = 256;
+constexpr std::uint8_t ReferenceTag = 25;
+// initial bytes of the tags, their numbers follow in one and two bytes
+constexpr std::uint8_t NamespaceInitialByte = std::uint8_t(cbor::Tag) | 25;
+constexpr std::uint8_t ReferenceInitialByte = std::uint8_t(cbor::Tag) | 24;
+
+// decoding hooks below compile to nothing unless bobl::options::StringRefs is set
+template<typename Options>
+using Enabled = std::integral_constant<bool, bobl::utility::options::Contains<Options, bobl::options::StringRefs>::value>;
+
+// options of strings decoded on their own behalf (member names, uuid bytes), they only follow the namespace
+template<typename Options>
+using NamespaceOptions = typename std::conditional<Enabled<Options>::value, bobl::Options<bobl::options::StringRefs>, bobl::options::None>::type;
+
+// shortest string numbered when there are n numbered strings already
+inline std::size_t min_length(std::uint64_t n)
+{
+	return n < 24 ? 3 : n < 256 ? 4 : n < 65536 ? 5 : n < 4294967296ull ? 7 : 11;
+}
+
+// makes table current on this thread for the lifetime of the scope
+template<typename Table>
+class Scope
+{
+public:
+	explicit Scope(Table* table) : previous_{ Table::current() } { Table::current() = table; }
+	Scope(Scope const&) = delete;
+	Scope& operator=(Scope const&) = delete;
+	~Scope() { Table::current() = previous_; }
+private:
+	Table* previous_;
+};
+
+// strings of namespace being encoded, their bytes are copied, so values they came from don't have to outlive encoding
+class Encoder
+{
+	struct Slot
+	{
+		std::uint64_t index;
+		std::size_t offset;
+		std::size_t size; // 0 if slot is free, strings that short are never numbered
+		std::uint32_t hash;
+		cbor::MajorType type;
+	};
+public:
+	static constexpr std::uint64_t NoReference = ~std::uint64_t{ 0 };
+
+	Encoder() : slots_(64, Slot{ 0, 0, 0, 0, cbor::MajorType::TextString }) {}
+
+	// number of the same string encoded before or NoReference, string is numbered if it is long enough
+	std::uint64_t reference(cbor::MajorType type, char const* data, std::size_t size)
+	{
+		if (size < min_length(0))
+			return NoReference;
+		if ((count_ + 1) * 2 > slots_.size())
+			grow();
+		auto hash = bobl::utility::hash::fnv1a(data, data + size, bobl::utility::hash::fnv1a(char(type), bobl::utility::hash::FnvOffsetBasis));
+		auto mask = slots_.size() - 1;
+		for (auto i = hash & mask;; i = (i + 1) & mask)
+		{
+			auto& slot = slots_[i];
+			if (slot.size == 0)
+			{
+				if (size >= min_length(count_))
+				{
+					slot = Slot{ count_++, strings_.size(), size, hash, type };
+					strings_.append(data, size);
+				}
+				return NoReference;
+			}
+			if (slot.hash == hash && slot.size == size && slot.type == type && std::memcmp(strings_.data() + slot.offset, data, size) == 0)
+				return slot.index;
+		}
+	}
+
+	static Encoder*& current()
+	{
+		static thread_local Encoder* res = nullptr;
+		return res;
+	}
+private:
+	void grow()
+	{
+		auto slots = std::vector<Slot>(slots_.size() * 2, Slot{ 0, 0, 0, 0, cbor::MajorType::TextString });
+		auto mask = slots.size() - 1;
+		for (auto const& slot : slots_)
+		{
+			if (slot.size == 0)
+				continue;
+			auto i = slot.hash & mask;
+			while (slots[i].size != 0)
+				i = (i + 1) & mask;
+			slots[i] = slot;
+		}
+		slots_.swap(slots);
+	}
+private:
+	std::vector<Slot> slots_;
+	std::string strings_;
+	std::uint64_t count_ = 0;
+};
+
+// writes reference instead of string if the same one has been encoded in current namespace
+template<typename Iterator>
+bool encode_reference(Iterator& out, cbor::MajorType type, char const* data, std::size_t size)
+{
+	auto strings = Encoder::current();
+	if (strings == nullptr)
+		return false;
+	auto index = strings->reference(type, data, size);
+	if (index == Encoder::NoReference)
+		return false;
+	out = bobl::cbor::utility::encode::unsigned_int(out, cbor::MajorType::Tag, ReferenceTag);
+	out = bobl::cbor::utility::encode::unsigned_int(out, cbor::MajorType::UnsignedInt, index);
+	return true;
+}
+
+// true on the threads decoding stringref namespace
+inline bool& decoding()
+{
+	static thread_local bool res = false;
+	return res;
+}
+
+// strings of namespace being decoded, kept as views of the input
+template<typename Iterator>
+class Decoder
+{
+	using RandomAccess = std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>;
+	struct String
+	{
+		Iterator header;
+		Iterator first;
+		Iterator last;
+	};
+public:
+	// decoders rewind input at times, so string that is not past the last numbered one has been seen already
+	void record(Iterator header, Iterator last)
+	{
+		if (!strings_.empty() && !before(strings_.back().header, header, RandomAccess{}))
+			return;
+		auto const& initial = bobl::cbor::utility::decode::initial_byte(*header);
+		if (initial.is_indefinite)
+			return;
+		auto first = header;
+		if (bobl::cbor::utility::decode::integer(initial, first, last) >= min_length(strings_.size()))
+			strings_.push_back(String{ header, first, last });
+	}
+
+	template<cbor::MajorType Type>
+	std::pair<Iterator, Iterator> get(std::uint64_t index) const
+	{
+		if (index >= strings_.size())
+			throw bobl::InvalidObject{ str(boost::format("CBOR stringref %1% refers to none of %2% strings of the namespace") % index % strings_.size()) };
+		auto const& string = strings_[std::size_t(index)];
+		auto type = bobl::cbor::utility::decode::major_type(*string.header);
+		if (type != Type)
+			throw bobl::IncorrectObjectType{ str(boost::format("CBOR stringref %1% refers to %2% insted of expected %3%") % index % to_string(type) % to_string(Type)) };
+		return { string.first, string.last };
+	}
+
+	static Decoder*& current()
+	{
+		static thread_local Decoder* res = nullptr;
+		return res;
+	}
+private:
+	static bool before(Iterator x, Iterator y, std::true_type) { return x < y; }
+	// namespace is never opened for such input
+	static bool before(Iterator, Iterator, std::false_type) { return true; }
+private:
+	std::vector<String> strings_;
+};
+
+// value at begin is decoded in its own namespace if it is tagged with 256, in none otherwise
+template<typename Iterator, bool Enabled = true>
+class Namespace
+{
+	using RandomAccess = std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>;
+public:
+	Namespace(Iterator& begin, Iterator end) : open_{ open(begin, end) }, strings_{ open_ ? &table_ : nullptr }, decoding_{ decoding() }
+	{
+		decoding() = open_;
+	}
+	Namespace(Namespace const&) = delete;
+	Namespace& operator=(Namespace const&) = delete;
+	~Namespace() { decoding() = decoding_; }
+private:
+	static bool open(Iterator& begin, Iterator end)
+	{
+		if (begin == end || std::uint8_t(*begin) != NamespaceInitialByte)
+			return false;
+		auto i = begin;
+		if (bobl::cbor::utility::decode::integer(i, end) != NamespaceTag)
+			return false;
+		if (!RandomAccess::value)
+			throw bobl::TypeNotSupported{ "CBOR stringref namespace can be decoded from random access input only" };
+		begin = i;
+		return true;
+	}
+private:
+	Decoder<Iterator> table_;
+	bool open_;
+	Scope<Decoder<Iterator>> strings_;
+	bool decoding_;
+};
+
+template<typename Iterator>
+class Namespace<Iterator, false>
+{
+public:
+	Namespace(Iterator& /*begin*/, Iterator /*end*/) {}
+};
+
+// referenced string if there is reference at begin, empty range otherwise
+template<cbor::MajorType Type, typename Iterator>
+std::pair<Iterator, Iterator> resolve(Iterator& begin, Iterator end)
+{
+	auto strings = Decoder<Iterator>::current();
+	if (strings == nullptr || begin == end || std::uint8_t(*begin) != ReferenceInitialByte)
+		return { begin, begin };
+	auto i = begin;
+	if (bobl::cbor::utility::decode::integer(i, end) != ReferenceTag)
+		return { begin, begin };
+	bobl::cbor::utility::decode::validate<cbor::MajorType::UnsignedInt>(i, end);
+	auto res = strings->template get<Type>(bobl::cbor::utility::decode::integer(i, end));
+	begin = i;
+	return res;
+}
+
+// numbers string [header, last) just decoded, if it is in namespace
+template<typename Iterator>
+void record(Iterator header, Iterator last)
+{
+	if (auto strings = Decoder<Iterator>::current())
+		strings->record(header, last);
+}
+
+// initial byte of value which might be reference to string of current namespace
+inline bool maybe_reference(cbor::Type type) { return std::uint8_t(type) == ReferenceInitialByte && decoding(); }
+
+template<cbor::MajorType Type, typename Iterator>
+std::pair<Iterator, Iterator> resolve(Iterator& begin, Iterator end, std::true_type /*enabled*/) { return resolve<Type>(begin, end); }
+template<cbor::MajorType Type, typename Iterator>
+std::pair<Iterator, Iterator> resolve(Iterator& begin, Iterator /*end*/, std::false_type /*enabled*/) { return { begin, begin }; }
+
+template<typename Iterator>
+void record(Iterator header, Iterator last, std::true_type /*enabled*/) { record(header, last); }
+template<typename Iterator>
+void record(Iterator /*header*/, Iterator /*last*/, std::false_type /*enabled*/) {}
+
+inline bool maybe_reference(cbor::Type type, std::true_type /*enabled*/) { return maybe_reference(type); }
+constexpr bool maybe_reference(cbor::Type /*type*/, std::false_type /*enabled*/) { return false; }
+
+}/*namespace stringref*/ } /*namespace cbor*/ } /*namespace bobl*/
@@ -8,6 +8,8 @@
 #include <boost/format.hpp>
 #include <boost/endian/conversion.hpp>
 #include <boost/type_index.hpp>
+#include <boost/mp11/integer_sequence.hpp>
+#include <boost/config.hpp>
 #include <iterator>
 #include <limits>
 #include <cmath>
@@ -66,11 +68,57 @@ namespace utility { namespace decode {
 
 enum:std::uint64_t { IndefiniteLength = (std::numeric_limits<std::uint64_t>::max)() };
 
+// everything initial byte of CBOR data item tells about it
+struct InitialByte
+{
+	bobl::cbor::MajorType major_type;
+	// bytes of big endian argument following initial byte, 0 if argument is additional info itself
+	std::uint8_t width;
+	bool is_float;
+	bool is_break;
+	bool is_indefinite;
+	// reserved additional info (28-30) or indefinite length of type which can't have it
+	bool is_malformed;
+};
+
+namespace details {
+
+constexpr bool is_indefinite(std::uint8_t major, std::uint8_t info) { return info == 31 && major >= cbor::ByteString && major <= cbor::Dictionary; }
+
+constexpr InitialByte initial_byte(std::uint8_t major, std::uint8_t info)
+{
+	return InitialByte{ bobl::cbor::MajorType(major)
+						, std::uint8_t(info < 24 || info > 27 ? 0 : 1 << (info - 24))
+						, major == cbor::SimpleValue && info >= 25 && info <= 27
+						, major == cbor::SimpleValue && info == 31
+						, is_indefinite(major, info)
+						, (info > 27 && info < 31) || (info == 31 && major != cbor::SimpleValue && !is_indefinite(major, info)) };
+}
+
+template<typename Indices>
+struct InitialBytes;
+
+template<std::size_t ...I>
+struct InitialBytes<boost::mp11::index_sequence<I...>>
+{
+	static constexpr InitialByte table[sizeof...(I)] = { initial_byte(std::uint8_t(I & MajorTypeMask), std::uint8_t(I & AditionalInfoMask))... };
+};
+
+template<std::size_t ...I>
+constexpr InitialByte InitialBytes<boost::mp11::index_sequence<I...>>::table[sizeof...(I)];
+
+using InitialByteTable = InitialBytes<boost::mp11::make_index_sequence<256>>;
+
+} /*namespace details*/
+
+inline constexpr InitialByte const& initial_byte(std::uint8_t val) { return details::InitialByteTable::table[val]; }
+
 inline constexpr bobl::cbor::Type type(std::uint8_t val) { return bobl::cbor::Type(val); }
+// mask is cheaper than the table lookup
 inline constexpr bobl::cbor::MajorType major_type(bobl::cbor::Type type) { return bobl::cbor::MajorType(type&bobl::cbor::MajorTypeMask); }
 inline constexpr bobl::cbor::MajorType major_type(std::uint8_t val) { return major_type(type(val)); }
 inline constexpr bool is_integer(cbor::MajorType type) { return (std::uint8_t(type) & (~bobl::cbor::NegativeInt)) == 0; }
-inline constexpr bool is_float(bobl::cbor::Type type) { return ((type & (cbor::SimpleValue | 24)) == (cbor::SimpleValue | 24)) && (type & 3) != 0; }
+inline constexpr bool is_float(bobl::cbor::Type type) { return initial_byte(type).is_float; }
 
 template<bobl::cbor::MajorType Type, typename Iterator>
 void validate(Iterator& begin, Iterator end)
@@ -83,31 +131,47 @@ void validate(Iterator& begin, Iterator end)
 																							% to_string(type) % int(type) % to_string(Type) % int(Type)) };
 }
 
+namespace details {
+
+// kept out of line, so integer() stays small enough to be inlined
+BOOST_NOINLINE BOOST_NORETURN inline void malformed(std::uint8_t info)
+{
+	throw bobl::InvalidObject{ str(boost::format("CBOR data item has reserved or invalid additional info : %1%") % int(info)) };
+}
+
+} /*namespace details*/
+
+// argument of data item which initial byte is at begin
 template<typename Iterator>
-std::uint64_t integer(Iterator& begin, Iterator end)
+std::uint64_t integer(InitialByte const& initial, Iterator& begin, Iterator end)
 {
-    auto res = uint64_t(type(*begin)&cbor::AditionalInfoMask);
-    ++begin;
-    switch(res)
-    {
-		case TypeAdditionalInfo<sizeof(std::uint8_t)>::value:
-            res = uint64_t(boost::endian::big_to_native(bobl::utility::read<std::uint8_t>(begin, end)));
-            break;
-		case TypeAdditionalInfo<sizeof(std::uint16_t)>::value:
+	auto res = uint64_t(type(*begin)&cbor::AditionalInfoMask);
+	++begin;
+	switch (initial.width)
+	{
+		case 0:
+			if (initial.is_malformed)
+				details::malformed(std::uint8_t(res));
+			break;
+		case sizeof(std::uint8_t):
+			res = uint64_t(boost::endian::big_to_native(bobl::utility::read<std::uint8_t>(begin, end)));
+			break;
+		case sizeof(std::uint16_t):
 			res = uint64_t(boost::endian::big_to_native(bobl::utility::read<std::uint16_t>(begin, end)));
-            break;
-		case TypeAdditionalInfo<sizeof(std::uint32_t)>::value:
+			break;
+		case sizeof(std::uint32_t):
 			res = uint64_t(boost::endian::big_to_native(bobl::utility::read<std::uint32_t>(begin, end)));
-            break;
-		case TypeAdditionalInfo<sizeof(std::uint64_t)>::value:
+			break;
+		default:
 			res = uint64_t(boost::endian::big_to_native(bobl::utility::read<std::uint64_t>(begin, end)));
-            break;
-        case 31:
-            assert(!"should be delt beforehead");
-    }
-    return res;
+			break;
+	}
+	return res;
 }
 
+template<typename Iterator>
+std::uint64_t integer(Iterator& begin, Iterator end) { return integer(initial_byte(*begin), begin, end); }
+
 template<typename T, typename Iterator>
 auto integer(Iterator& begin, Iterator end) -> typename std::enable_if<std::is_signed<T>::value, T>::type
 {
@@ -120,10 +184,11 @@ template<typename T, typename Iterator>
 auto integer(Iterator& begin, Iterator end) -> typename std::enable_if<!std::is_signed<T>::value, T>::type
 {
 	assert((major_type(*begin) & (~bobl::cbor::NegativeInt)) == 0 && "must be validate beforehand");
-	auto info = type(*begin)&cbor::AditionalInfoMask;
-	if (info != TypeAdditionalInfo<sizeof(T)>::value)
+	if (initial_byte(*begin).width != sizeof(T))
+	{
+		auto info = type(*begin)&cbor::AditionalInfoMask;
 		throw bobl::IncorrectObjectType{ str(boost::format("CBOR value has additional info : %1% insted of expected %2% ") % int(info) % int(TypeAdditionalInfo<sizeof(T)>::value)) };
-
+	}
 	return boost::endian::big_to_native(bobl::utility::read<typename TypeAdditionalInfo<sizeof(T)>::type>(++begin, end));
 }
 
@@ -149,18 +214,20 @@ T floating_point(Iterator& begin, Iterator end)
 {
 	T res = 0;
 	static_assert(std::is_floating_point<T>::value, "T expected to be floating point type");
-    auto subtype =*begin&cbor::AditionalInfoMask;
-    ++begin;
-    switch(subtype)
-    {
-        case TypeAdditionalInfo<sizeof(std::uint16_t)>::value:
+	auto const& initial = initial_byte(*begin);
+	if (!initial.is_float)
+		throw bobl::IncorrectObjectType{ str(boost::format("CBOR floating point type has unexpected sub-type : %1%") % int(*begin&cbor::AditionalInfoMask)) };
+	++begin;
+	switch (initial.width)
+	{
+		case sizeof(std::uint16_t):
 		{
 			auto value = bobl::utility::FloatConverter<sizeof(std::uint16_t)>{}(boost::endian::big_to_native(bobl::utility::read<std::uint16_t>(begin, end)));
 			assert(!(value > (std::numeric_limits<T>::max)() || value < (std::numeric_limits<T>::lowest)()));
 			res = T(value);
 			break;
 		}
-		case TypeAdditionalInfo<sizeof(std::uint32_t)>::value:
+		case sizeof(std::uint32_t):
 		{
 			auto value = bobl::utility::FloatConverter<sizeof(std::uint32_t)>{}(boost::endian::big_to_native(bobl::utility::read<std::uint32_t>(begin, end)));
 			if (value > (std::numeric_limits<T>::max)() || value < (std::numeric_limits<T>::lowest)())
@@ -168,7 +235,7 @@ T floating_point(Iterator& begin, Iterator end)
 			res = T(value);
 			break;
 		}
-		case TypeAdditionalInfo<sizeof(std::uint64_t)>::value:
+		default:
 		{
 			auto value = bobl::utility::FloatConverter<sizeof(std::uint64_t)>{}(boost::endian::big_to_native(bobl::utility::read<std::uint64_t>(begin, end)));
 			if (value >(std::numeric_limits<T>::max)() || value < (std::numeric_limits<T>::lowest)())
@@ -176,26 +243,26 @@ T floating_point(Iterator& begin, Iterator end)
 			res = T(value);
 			break;
 		}
-		default:
-			throw bobl::IncorrectObjectType{ str(boost::format("CBOR floating point type has unexpected sub-type : %1%") % int(subtype)) };
-
-    }
-    return res;
+	}
+	return res;
 }
 template<typename Iterator>
-std::uint64_t length(Iterator& begin, Iterator end)
+std::uint64_t length(InitialByte const& initial, Iterator& begin, Iterator end)
 {
-	if ((type(*begin)&cbor::AditionalInfoMask) == 31)
+	if (initial.is_indefinite)
 	{
 		++begin;
 		return bobl::cbor::utility::decode::IndefiniteLength;
 	}
-	auto len = integer(begin, end);
+	auto len = integer(initial, begin, end);
 	if (len == bobl::cbor::utility::decode::IndefiniteLength)
 		throw bobl::InvalidObject{"CBOR: to many object to decode" };
 	return len;
 }
 
+template<typename Iterator>
+std::uint64_t length(Iterator& begin, Iterator end) { return length(initial_byte(*begin), begin, end); }
+
 template<typename T, typename Iterator>
 T string(Iterator& begin, Iterator end)
 {
@@ -346,6 +413,9 @@ inline const char* to_string(Type type)
 		case Type::Null:
 			res = "null";
 			break;
+		case Type::Undefined:
+			res = "undefined";
+			break;
 		case Type::Float16:
 			res = "float 16";
 			break;
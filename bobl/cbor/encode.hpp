@@ -15,7 +15,7 @@ template<typename ...Options, typename ...Args>
 std::vector<std::uint8_t> encode(Args&& ...args) 
 {
 	std::vector<std::uint8_t> buffer;
-	encoder::details::encode<bobl::Options<Options...>>(std::back_inserter(buffer), std::forward<Args>(args)...);
+	encoder::details::encode_message<bobl::Options<Options...>>(std::back_inserter(buffer), std::forward<Args>(args)...);
 	return buffer;
 }
 
@@ -23,7 +23,7 @@ template<typename ...Options, typename Iterator, typename ...Args>
 auto encode(Iterator out, Args&& ...args) ->
 	typename std::enable_if<!std::is_const<typename std::iterator_traits<Iterator>::value_type>::value, Iterator>::type
 {
-	return encoder::details::encode<bobl::Options<Options...>>(out, std::forward<Args>(args)...);
+	return encoder::details::encode_message<bobl::Options<Options...>>(out, std::forward<Args>(args)...);
 }
 
 }/*namespace cbor*/ } /*namespace bobl*/
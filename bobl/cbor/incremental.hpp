@@ -0,0 +1,375 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+
+#include "bobl/cbor/decode.hpp"
+#include "bobl/cbor/details/utility.hpp"
+#include "bobl/cbor/cbor.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/format.hpp>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <array>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace cbor { namespace incremental {
+
+enum class Status
+{
+	NeedMore,
+	ValueReady,
+	Error
+};
+
+// SAX events produced by Parser, all do nothing; derive and hide the ones of interest
+struct Callbacks
+{
+	void unsigned_int(std::uint64_t /*value*/) {}
+	// value is -1 - n
+	void negative_int(std::uint64_t /*n*/) {}
+	// tag applies to the following item
+	void tag(std::uint64_t /*tag*/) {}
+	void boolean(bool /*value*/) {}
+	void null() {}
+	void undefined() {}
+	void simple(std::uint8_t /*value*/) {}
+	void floating_point(double /*value*/) {}
+	// length is IndefiniteLength for chunked strings, string content is delivered piecewise as it arrives
+	void begin_string(bobl::cbor::MajorType /*type*/, std::uint64_t /*length*/) {}
+	template<typename Iterator>
+	void string(Iterator /*begin*/, Iterator /*end*/) {}
+	void end_string() {}
+	void begin_array(std::uint64_t /*length*/) {}
+	void end_array() {}
+	// length is number of pairs
+	void begin_map(std::uint64_t /*length*/) {}
+	void end_map() {}
+};
+
+// Push parser: bytes are fed as they arrive, split at any position. feed consumes input up to the end of
+// the first complete top level item and reports ValueReady, or consumes all of it and reports NeedMore.
+// Partial input is never rescanned, parser state is a few bytes of incomplete item header plus a frame per open container.
+// Malformed input puts parser into Error state until reset().
+template<typename Handler>
+class Parser
+{
+	struct Frame
+	{
+		std::uint64_t rest;	// items left for definite containers (keys and values are counted separately), items seen for indefinite ones
+		bool indefinite;
+		bool map;
+	};
+
+	struct String
+	{
+		bool active;
+		bool indefinite;
+		bobl::cbor::MajorType type;
+		std::uint64_t rest;
+	};
+public:
+	explicit Parser(Handler& handler) : handler_( handler ) {}
+	Parser(Parser const&) = delete;
+	Parser& operator= (Parser const&) = delete;
+
+	template<typename Iterator>
+	Status feed(Iterator& begin, Iterator end)
+	{
+		if (!error_.empty())
+			return Status::Error;
+		while (begin != end)
+		{
+			if (string_.rest != 0)
+			{
+				auto first = begin;
+				auto n = std::min(string_.rest, std::uint64_t(std::distance(begin, end)));
+				std::advance(begin, n);
+				string_.rest -= n;
+				handler_.string(first, begin);
+				if (string_.rest == 0 && !string_.indefinite && end_string())
+					return Status::ValueReady;
+				continue;
+			}
+			if (size_ == 0)
+			{
+				header_[size_++] = std::uint8_t(*begin++);
+				expected_ = header_size(header_[0]);
+				if (expected_ == 0)
+					return fail(str(boost::format("invalid CBOR item header %1$#x") % int(header_[0])));
+			}
+			for (; size_ != expected_ && begin != end; ++begin)
+				header_[size_++] = std::uint8_t(*begin);
+			if (size_ != expected_)
+				break;
+			size_ = 0;
+			auto complete = item();
+			if (!error_.empty())
+				return Status::Error;
+			if (complete)
+				return Status::ValueReady;
+		}
+		return Status::NeedMore;
+	}
+
+	std::string const& error() const { return error_; }
+	// number of open containers
+	std::size_t depth() const { return stack_.size(); }
+	// true if parser is between top level items
+	bool idle() const { return stack_.empty() && size_ == 0 && !string_.active && !tagged_; }
+
+	void reset()
+	{
+		stack_.clear();
+		string_ = String{};
+		size_ = 0;
+		tagged_ = false;
+		error_.clear();
+	}
+private:
+	// full header length including initial byte, 0 if additional info is reserved
+	static std::size_t header_size(std::uint8_t type)
+	{
+		auto const& initial = bobl::cbor::utility::decode::initial_byte(type);
+		return initial.is_malformed ? 0 : 1 + std::size_t(initial.width);
+	}
+
+	Status fail(std::string message)
+	{
+		error_ = std::move(message);
+		return Status::Error;
+	}
+
+	std::uint64_t integer() const
+	{
+		auto begin = header_.data();
+		return bobl::cbor::utility::decode::integer(begin, begin + expected_);
+	}
+
+	std::uint64_t length() const
+	{
+		auto begin = header_.data();
+		return bobl::cbor::utility::decode::length(begin, begin + expected_);
+	}
+
+	// handles complete item header, returns true if top level item is complete
+	bool item()
+	{
+		auto type = bobl::cbor::utility::decode::major_type(header_[0]);
+		auto indefinite = bobl::cbor::utility::decode::initial_byte(header_[0]).is_indefinite;
+		if (string_.active)
+		{
+			// chunk of indefinite length string
+			if (header_[0] == bobl::cbor::Break)
+				return end_string();
+			if (type != string_.type || indefinite)
+				fail(str(boost::format("unexpected CBOR item %1$#x in indefinite length \"%2%\"") % int(header_[0]) % to_string(string_.type)));
+			else
+				string_.rest = integer();
+			return false;
+		}
+		if (header_[0] == bobl::cbor::Break)
+			return end_container();
+		switch (type)
+		{
+			case bobl::cbor::MajorType::UnsignedInt:
+				handler_.unsigned_int(integer());
+				break;
+			case bobl::cbor::MajorType::NegativeInt:
+				handler_.negative_int(integer());
+				break;
+			case bobl::cbor::MajorType::Tag:
+				tagged_ = true;
+				handler_.tag(integer());
+				return false;
+			case bobl::cbor::MajorType::ByteString:
+			case bobl::cbor::MajorType::TextString:
+			{
+				auto len = length();
+				tagged_ = false;
+				handler_.begin_string(type, len);
+				string_ = String{ true, indefinite, type, indefinite ? 0 : len };
+				return !indefinite && len == 0 && end_string();
+			}
+			case bobl::cbor::MajorType::Array:
+			case bobl::cbor::MajorType::Dictionary:
+			{
+				auto len = length();
+				auto map = type == bobl::cbor::MajorType::Dictionary;
+				if (!indefinite && map && len > (bobl::cbor::utility::decode::IndefiniteLength - 1) / 2)
+				{
+					fail("CBOR: to many object to decode");
+					return false;
+				}
+				tagged_ = false;
+				if (map)
+					handler_.begin_map(len);
+				else
+					handler_.begin_array(len);
+				if (!indefinite && len == 0)
+				{
+					if (map)
+						handler_.end_map();
+					else
+						handler_.end_array();
+					break;
+				}
+				stack_.push_back(Frame{ indefinite ? 0 : (map ? len * 2 : len), indefinite, map });
+				return false;
+			}
+			case bobl::cbor::MajorType::SimpleValue:
+				switch (header_[0])
+				{
+					case bobl::cbor::False:
+					case bobl::cbor::True:
+						handler_.boolean(header_[0] == bobl::cbor::True);
+						break;
+					case bobl::cbor::Null:
+						handler_.null();
+						break;
+					case bobl::cbor::Undefined:
+						handler_.undefined();
+						break;
+					case bobl::cbor::Float16:
+					case bobl::cbor::Float32:
+					case bobl::cbor::Float64:
+					{
+						auto begin = header_.data();
+						handler_.floating_point(bobl::cbor::utility::decode::floating_point<double>(begin, begin + expected_));
+						break;
+					}
+					default:
+						handler_.simple(expected_ == 1 ? std::uint8_t(header_[0] & bobl::cbor::AditionalInfoMask) : header_[1]);
+				}
+				break;
+			default:
+				fail(str(boost::format("unexpected CBOR item %1$#x") % int(header_[0])));
+				return false;
+		}
+		return completed();
+	}
+
+	bool end_string()
+	{
+		string_.active = false;
+		handler_.end_string();
+		return completed();
+	}
+
+	bool end_container()
+	{
+		if (tagged_ || stack_.empty() || !stack_.back().indefinite || (stack_.back().map && stack_.back().rest % 2 != 0))
+		{
+			fail("unexpected CBOR break");
+			return false;
+		}
+		auto map = stack_.back().map;
+		stack_.pop_back();
+		if (map)
+			handler_.end_map();
+		else
+			handler_.end_array();
+		return completed();
+	}
+
+	// item is complete, closes all definite length containers it completes; returns true if it was top level item
+	bool completed()
+	{
+		tagged_ = false;
+		while (!stack_.empty())
+		{
+			auto& frame = stack_.back();
+			if (frame.indefinite)
+			{
+				++frame.rest;
+				return false;
+			}
+			if (--frame.rest != 0)
+				return false;
+			auto map = frame.map;
+			stack_.pop_back();
+			if (map)
+				handler_.end_map();
+			else
+				handler_.end_array();
+		}
+		return true;
+	}
+private:
+	Handler& handler_;
+	std::vector<Frame> stack_;
+	String string_ = String{};
+	std::array<std::uint8_t, 1 + sizeof(std::uint64_t)> header_;
+	std::size_t size_ = 0;
+	std::size_t expected_ = 0;
+	bool tagged_ = false;
+	std::string error_;
+};
+
+// Accumulates bytes of a single top level item while Parser tracks its boundaries,
+// complete item is decoded by the regular decoder (cbor::decode<T, Options>).
+// Parser only finds where the item ends, nothing is decoded into T until the whole item has arrived,
+// so the item is buffered in full. Buffer is reused from item to item.
+//	auto decoder = bobl::cbor::incremental::Decoder<Message>{};
+//	while(decoder.feed(begin, end) == bobl::cbor::incremental::Status::NeedMore) ... read more ...
+//	auto message = decoder.value();
+template<typename T, typename Options = bobl::options::None>
+class Decoder
+{
+public:
+	Decoder() = default;
+	Decoder(Decoder const&) = delete;
+	Decoder& operator= (Decoder const&) = delete;
+
+	// once value is ready no input is consumed until value() is called
+	template<typename Iterator>
+	Status feed(Iterator& begin, Iterator end)
+	{
+		if (ready_)
+			return Status::ValueReady;
+		auto first = begin;
+		auto res = parser_.feed(begin, end);
+		buffer_.insert(buffer_.end(), first, begin);
+		ready_ = res == Status::ValueReady;
+		return res;
+	}
+
+	std::string const& error() const { return parser_.error(); }
+
+	// decodes complete item, decoder is ready for the next one afterwards
+	T value()
+	{
+		if (!ready_)
+			throw bobl::InputToShort{ str(boost::format("incomplete CBOR item (%1% bytes buffered)") % buffer_.size()) };
+		ready_ = false;
+		std::uint8_t const* begin = buffer_.data();
+		try
+		{
+			auto res = bobl::cbor::decode<T, Options>(begin, begin + buffer_.size());
+			buffer_.clear();
+			return res;
+		}
+		catch (...)
+		{
+			buffer_.clear();
+			throw;
+		}
+	}
+
+	void reset()
+	{
+		parser_.reset();
+		buffer_.clear();
+		ready_ = false;
+	}
+private:
+	Callbacks callbacks_;
+	Parser<Callbacks> parser_{ callbacks_ };
+	std::vector<std::uint8_t> buffer_;
+	bool ready_ = false;
+};
+
+}/*namespace incremental*/ }/*namespace cbor*/ } /*namespace bobl*/
@@ -0,0 +1,181 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/cbor/details/decoder.hpp"
+#include "bobl/cbor/details/options.hpp"
+#include "bobl/cbor/details/utility.hpp"
+#include "bobl/utility/projection.hpp"
+#include "bobl/utility/flyweight.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <string>
+#include <initializer_list>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace cbor {
+
+namespace decoder { namespace details {
+
+template<typename Projection, typename Options>
+class Projector;
+
+template<typename Projection, typename ...Options>
+class Projector<Projection, bobl::Options<Options...>>
+{
+	template<typename Iterator>
+	class LeafDecoder
+	{
+	public:
+		LeafDecoder(Iterator begin, Iterator end) : begin_{ begin }, end_{ end } {}
+		template<typename T>
+		T decode() const
+		{
+			auto begin = begin_;
+			return Decoder<T, typename cbor::EffectiveOptions<T, Options...>::type>::type::decode(begin, end_);
+		}
+	private:
+		Iterator begin_;
+		Iterator end_;
+	};
+
+	template<typename Iterator>
+	static void skip(Iterator& begin, Iterator end)
+	{
+		Decoder<bobl::flyweight::lite::Any<Iterator>, bobl::Options<Options...>>::type::decode(begin, end);
+	}
+
+	// returns key text, or an empty range if key isn't a definite length text string
+	template<typename Iterator>
+	static std::pair<Iterator, Iterator> key(Iterator& begin, Iterator end)
+	{
+		if (begin == end)
+			throw bobl::InputToShort{ "not enought data to decode CBOR dictionary key" };
+		if (bobl::cbor::utility::decode::major_type(std::uint8_t(*begin)) == bobl::cbor::MajorType::TextString)
+		{
+			auto i = begin;
+			auto len = bobl::cbor::utility::decode::length(begin, end);
+			if (len != bobl::cbor::utility::decode::IndefiniteLength)
+			{
+				if (std::uint64_t(std::distance(begin, end)) < len)
+					throw bobl::InputToShort{ "not enought data to decode CBOR dictionary key" };
+				auto first = begin;
+				std::advance(begin, len);
+				return { first, begin };
+			}
+			begin = i;
+		}
+		skip(begin, end);
+		return { begin, begin };
+	}
+
+	template<typename Iterator>
+	static bool equal(std::pair<Iterator, Iterator> const& key, std::string const& segment)
+	{
+		return std::size_t(std::distance(key.first, key.second)) == segment.size()
+					&& std::equal(key.first, key.second, segment.begin(), [](typename std::iterator_traits<Iterator>::value_type a, char b) { return char(a) == b; });
+	}
+public:
+	template<typename Iterator>
+	static void project(Iterator begin, Iterator end, Projection& projection)
+	{
+		auto active = std::vector<std::size_t>(projection.size());
+		for (auto i = std::size_t{ 0 }; i != active.size(); ++i)
+			active[i] = i;
+		project(begin, end, 0, active, projection, false);
+	}
+private:
+	// every path is matched against the first element with the same name/index only, the walk is over as soon as all active paths are matched,
+	// unless skip_rest is set, in which case the rest of the container is skipped to let the caller carry on
+	template<typename Iterator>
+	static void project(Iterator& begin, Iterator end, std::size_t depth, std::vector<std::size_t> const& active, Projection& projection, bool skip_rest)
+	{
+		if (begin == end)
+			throw bobl::InputToShort{ "not enought data to decode CBOR value" };
+		auto dictionary = bobl::cbor::utility::decode::major_type(std::uint8_t(*begin)) == bobl::cbor::MajorType::Dictionary;
+		auto eoc = EndOfMap{ bobl::cbor::utility::decode::length(begin, end) };
+		auto pending = active.size();
+		auto matched = std::vector<bool>(active.size());
+		auto nested = std::vector<std::size_t>{};
+		for (auto index = std::uint64_t{ 0 }; pending != 0 && !eoc(begin, end); ++index)
+		{
+			auto name = dictionary ? key(begin, end) : std::make_pair(begin, begin);
+			nested.clear();
+			for (auto i = std::size_t{ 0 }; i != active.size(); ++i)
+			{
+				auto const& path = projection.path(active[i]);
+				if (matched[i] || !(dictionary ? equal(name, path[depth]) : bobl::utility::projection::is_index(path[depth], index)))
+					continue;
+				matched[i] = true;
+				--pending;
+				if (path.size() == depth + 1)
+					projection.decode(active[i], LeafDecoder<Iterator>{ begin, end });
+				else
+					nested.push_back(active[i]);
+			}
+			auto carry_on = pending != 0 || skip_rest;
+			if (!nested.empty() && begin != end && is_container(std::uint8_t(*begin)))
+				project(begin, end, depth + 1, nested, projection, carry_on);
+			else if (carry_on)
+				skip(begin, end);
+		}
+		if (pending == 0 && skip_rest)
+		{
+			while (!eoc(begin, end))
+			{
+				if (dictionary)
+					skip(begin, end);
+				skip(begin, end);
+			}
+		}
+	}
+
+	static bool is_container(std::uint8_t type)
+	{
+		auto major = bobl::cbor::utility::decode::major_type(type);
+		return major == bobl::cbor::MajorType::Dictionary || major == bobl::cbor::MajorType::Array;
+	}
+};
+
+template<typename Result, typename Options, typename Iterator>
+Result project(Iterator begin, Iterator end, std::vector<bobl::utility::projection::Segments> const& paths)
+{
+	using Projection = bobl::utility::projection::Projection<Result>;
+	bobl::cbor::utility::decode::validate<bobl::cbor::MajorType::Dictionary>(begin, end);
+	auto projection = Projection{ paths };
+	Projector<Projection, Options>::project(begin, end, projection);
+	return std::move(projection).value();
+}
+
+} /*namespace details*/ } /*namespace decoder*/
+
+// decodes only members referred by Paths (bobl::Path<...>) of T, the rest of the map is skipped
+//	auto res = bobl::cbor::project<Message, bobl::Path<0, 1>, bobl::Path<0, 2>>(begin, end); // std::tuple<seq type, ts type>
+// unlike decode begin is not advanced, that would require to scan the whole map
+template<typename T, typename ...Args, typename Iterator>
+auto project(Iterator begin, Iterator end)
+	-> typename bobl::utility::projection::PathsTraits<T, typename bobl::utility::projection::Parameters<std::tuple<>, Args...>::type,
+																	typename bobl::utility::projection::Parameters<std::tuple<>, Args...>::Options>::type
+{
+	using Parameters = bobl::utility::projection::Parameters<std::tuple<>, Args...>;
+	using Traits = bobl::utility::projection::PathsTraits<T, typename Parameters::type, typename Parameters::Options>;
+	return bobl::cbor::decoder::details::project<typename Traits::type, typename Parameters::Options>(begin, end, Traits::paths());
+}
+
+// decodes only values referred by dotted paths, the rest of the map is skipped
+//	auto res = bobl::cbor::project<int, std::string>(begin, end, {"header.seq", "header.ts"});
+template<typename ...Args, typename Iterator>
+auto project(Iterator begin, Iterator end, std::initializer_list<diversion::string_view> paths)
+		-> typename bobl::utility::projection::Parameters<std::tuple<>, Args...>::type
+{
+	auto segments = std::vector<bobl::utility::projection::Segments>{};
+	for (auto const& path : paths)
+		segments.push_back(bobl::utility::projection::split(path));
+	using Parameters = bobl::utility::projection::Parameters<std::tuple<>, Args...>;
+	return bobl::cbor::decoder::details::project<typename Parameters::type, typename Parameters::Options>(begin, end, segments);
+}
+
+}/*namespace cbor*/ } /*namespace bobl*/
@@ -0,0 +1,255 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+
+#include "bobl/cbor/details/decoder.hpp"
+#include "bobl/cbor/incremental.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/cbor/cast.hpp"
+#include "bobl/utility/memory.hpp"
+#include "bobl/utility/file.hpp"
+#include "bobl/utility/any.hpp"
+#include "bobl/utility/diversion.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/format.hpp>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <type_traits>
+#include <cstring>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace cbor {
+
+// offsets of every stride-th item of CBOR sequence, see SequenceReader::index
+struct SequenceIndex
+{
+	std::size_t stride;
+	// number of items in the sequence
+	std::size_t size;
+	std::vector<std::size_t> offsets;
+};
+
+// RFC 8742 CBOR sequence (back to back top level items) in memory, typically memory mapped file.
+// Items are returned as lite::Any views into the memory or decoded on the way.
+//	auto reader = bobl::cbor::SequenceReader<>{ mmap.data(), mmap.data() + mmap.size() };
+//	while (auto event = reader.next<Event>()) ...
+template<typename Iterator = std::uint8_t const*>
+class SequenceReader
+{
+	using Skipper = decoder::details::Handler<bobl::flyweight::lite::Any<Iterator>, bobl::options::None>;
+public:
+	SequenceReader(Iterator begin, Iterator end, bool sequential = true) : begin_{ begin }, current_{ begin }, end_{ end }
+	{
+		if (sequential)
+			advise(begin, end, std::is_pointer<Iterator>{});
+	}
+
+	// next item or nullopt at the end of the sequence
+	diversion::optional<bobl::flyweight::lite::Any<Iterator>> next()
+	{
+		if (current_ == end_)
+			return diversion::nullopt;
+		auto res = Skipper::decode(current_, end_);
+		if (current_ != end_)
+			prefetch(current_, std::is_pointer<Iterator>{});
+		return res;
+	}
+
+	template<typename T, typename Options = bobl::options::None>
+	diversion::optional<T> next()
+	{
+		auto any = next();
+		if (!any)
+			return diversion::nullopt;
+		return bobl::cbor::cast<T, Options>(*any);
+	}
+
+	// byte offset of the next item, reading can be resumed from it later by seek(offset)
+	std::size_t offset() const { return std::size_t(std::distance(begin_, current_)); }
+
+	// offset has to point at the beginning of an item
+	void seek(std::size_t offset)
+	{
+		if (offset > std::size_t(std::distance(begin_, end_)))
+			throw bobl::RangeError{ str(boost::format("offset %1% is out of CBOR sequence of %2% bytes") % offset % std::distance(begin_, end_)) };
+		current_ = std::next(begin_, offset);
+	}
+
+	// positions reader at n-th item, skipping at most index.stride - 1 items
+	void seek(SequenceIndex const& index, std::size_t n)
+	{
+		if (n > index.size)
+			throw bobl::RangeError{ str(boost::format("item %1% is out of CBOR sequence of %2% items") % n % index.size) };
+		if (n == index.size)
+		{
+			current_ = end_;
+			return;
+		}
+		seek(index.offsets[n / index.stride]);
+		for (auto i = n % index.stride; i != 0; --i)
+			Skipper::decode(current_, end_);
+	}
+
+	// scans the whole sequence once, current position is not affected
+	SequenceIndex index(std::size_t stride = 1024) const
+	{
+		if (stride == 0)
+			throw bobl::RangeError{ "CBOR sequence index stride has to be positive" };
+		auto res = SequenceIndex{ stride, 0, {} };
+		for (auto i = begin_; i != end_; ++res.size)
+		{
+			if (res.size % stride == 0)
+				res.offsets.push_back(std::size_t(std::distance(begin_, i)));
+			Skipper::decode(i, end_);
+		}
+		return res;
+	}
+private:
+	static void advise(Iterator begin, Iterator end, std::true_type) { bobl::utility::advise_sequential(begin, std::size_t(std::distance(begin, end)) * sizeof(*begin)); }
+	static void advise(Iterator /*begin*/, Iterator /*end*/, std::false_type) {}
+	static void prefetch(Iterator i, std::true_type) { bobl::utility::prefetch(i); }
+	static void prefetch(Iterator /*i*/, std::false_type) {}
+private:
+	Iterator begin_;
+	Iterator current_;
+	Iterator end_;
+};
+
+template<typename Iterator>
+SequenceReader<Iterator> make_sequence_reader(Iterator begin, Iterator end)
+{
+	return SequenceReader<Iterator>{ begin, end };
+}
+
+// CBOR sequence read from Source in chunks, Source is called as std::size_t(std::uint8_t* buffer, std::size_t size)
+// and returns number of bytes read, 0 at the end of input. Item boundaries are tracked by incremental::Parser,
+// so bytes are scanned only once however items are split between reads.
+// Item returned by next() refers reader's buffer and remains valid until the following call.
+template<typename Source>
+class SequenceStreamReader
+{
+public:
+	explicit SequenceStreamReader(Source source, std::size_t capacity = 64 * 1024)
+		: source_( std::move(source) ), buffer_( std::max(capacity, std::size_t{ 1 }) ) {}
+	SequenceStreamReader(SequenceStreamReader&& other)
+		: source_( std::move(other.source_) ), buffer_( std::move(other.buffer_) ), begin_{ other.begin_ }, scan_{ other.scan_ }, end_{ other.end_ }
+	{
+		assert(other.parser_.idle() && "reader can't be moved in the middle of an item");
+	}
+
+	diversion::optional<bobl::flyweight::lite::Any<std::uint8_t const*>> next()
+	{
+		begin_ = scan_;
+		for (;;)
+		{
+			std::uint8_t const* begin = buffer_.data() + scan_;
+			auto status = parser_.feed(begin, static_cast<std::uint8_t const*>(buffer_.data() + end_));
+			scan_ = std::size_t(begin - buffer_.data());
+			if (status == incremental::Status::ValueReady)
+				return bobl::flyweight::lite::Any<std::uint8_t const*>{ buffer_.data() + begin_, buffer_.data() + scan_ };
+			if (status == incremental::Status::Error)
+				throw bobl::InvalidObject{ parser_.error() };
+			if (!read())
+			{
+				if (begin_ != end_)
+					throw bobl::InputToShort{ str(boost::format("truncated CBOR item : %1% bytes available") % (end_ - begin_)) };
+				return diversion::nullopt;
+			}
+		}
+	}
+
+	template<typename T, typename Options = bobl::options::None>
+	diversion::optional<T> next()
+	{
+		auto any = next();
+		if (!any)
+			return diversion::nullopt;
+		return bobl::cbor::cast<T, Options>(*any);
+	}
+private:
+	// keeps incomplete item and reuses the buffer, grows it only for items larger than the buffer
+	bool read()
+	{
+		if (begin_ != 0)
+		{
+			std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+			scan_ -= begin_;
+			end_ -= begin_;
+			begin_ = 0;
+		}
+		if (end_ == buffer_.size())
+			buffer_.resize(buffer_.size() * 2);
+		auto n = source_(buffer_.data() + end_, buffer_.size() - end_);
+		end_ += n;
+		return n != 0;
+	}
+private:
+	Source source_;
+	std::vector<std::uint8_t> buffer_;
+	std::size_t begin_ = 0;
+	std::size_t scan_ = 0;
+	std::size_t end_ = 0;
+	incremental::Callbacks callbacks_;
+	incremental::Parser<incremental::Callbacks> parser_{ callbacks_ };
+};
+
+template<typename Source>
+SequenceStreamReader<Source> make_sequence_stream_reader(Source source, std::size_t capacity = 64 * 1024)
+{
+	return SequenceStreamReader<Source>{ std::move(source), capacity };
+}
+
+// Encodes items back to back into a single reusable buffer, Sink is called as void(std::uint8_t const* data, std::size_t size)
+// once at least capacity bytes are accumulated. flush() has to be called to pass on the rest, it isn't done on destruction.
+template<typename Sink>
+class SequenceWriter
+{
+public:
+	explicit SequenceWriter(Sink sink, std::size_t capacity = 64 * 1024) : sink_( std::move(sink) ), capacity_{ capacity }
+	{
+		buffer_.reserve(capacity);
+	}
+
+	template<typename ...Options, typename ...Args>
+	void write(Args&& ...args)
+	{
+		bobl::cbor::encode<Options...>(std::back_inserter(buffer_), std::forward<Args>(args)...);
+		if (buffer_.size() >= capacity_)
+			flush();
+	}
+
+	// appends already encoded item as is
+	template<typename Iterator>
+	void append(bobl::flyweight::lite::Any<Iterator> const& any)
+	{
+		buffer_.insert(buffer_.end(), bobl::flyweight::lite::utility::details::begin_raw(any), bobl::flyweight::lite::utility::details::end_raw(any));
+		if (buffer_.size() >= capacity_)
+			flush();
+	}
+
+	void flush()
+	{
+		if (buffer_.empty())
+			return;
+		sink_(static_cast<std::uint8_t const*>(buffer_.data()), buffer_.size());
+		buffer_.clear();
+	}
+
+	std::size_t buffered() const { return buffer_.size(); }
+private:
+	Sink sink_;
+	std::size_t capacity_;
+	std::vector<std::uint8_t> buffer_;
+};
+
+template<typename Sink>
+SequenceWriter<Sink> make_sequence_writer(Sink sink, std::size_t capacity = 64 * 1024)
+{
+	return SequenceWriter<Sink>{ std::move(sink), capacity };
+}
+
+}/*namespace cbor*/ } /*namespace bobl*/
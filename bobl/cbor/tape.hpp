@@ -0,0 +1,257 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+
+#include "bobl/cbor/details/decoder.hpp"
+#include "bobl/cbor/details/utility.hpp"
+#include "bobl/cbor/cbor.hpp"
+#include "bobl/utility/tape.hpp"
+#include "bobl/utility/any.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/format.hpp>
+#include <iterator>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace cbor {
+
+template<typename Iterator>
+using Tape = bobl::utility::tape::Tape<Iterator>;
+
+namespace details {
+
+template<typename T>
+struct TapeDecoder
+{
+	template<typename Options, typename Iterator>
+	static T decode(Tape<Iterator> const& tape, std::size_t index)
+	{
+		auto begin = tape.begin(index);
+		return decoder::details::Handler<T, Options>::decode(begin, tape.end(index));
+	}
+};
+
+template<typename Iterator, bobl::flyweight::utility::AnyTag Tag>
+struct TapeDecoder<bobl::flyweight::lite::utility::AnyType<Iterator, Tag>>
+{
+	template<typename Options>
+	static bobl::flyweight::lite::utility::AnyType<Iterator, Tag> decode(Tape<Iterator> const& tape, std::size_t index)
+	{
+		return tape.template as<bobl::flyweight::lite::utility::AnyType<Iterator, Tag>>(index);
+	}
+};
+
+struct TapeValueDecoder
+{
+	template<typename T, typename Options, typename Iterator>
+	static T decode(Tape<Iterator> const& tape, std::size_t parent, std::size_t position)
+	{
+		return TapeDecoder<T>::template decode<Options>(tape, tape.child(parent, position));
+	}
+};
+
+struct TapeNameValueDecoder
+{
+	template<typename T, typename Options, typename Iterator>
+	static T decode(Tape<Iterator> const& tape, std::size_t parent, std::size_t position)
+	{
+		auto begin = tape.begin(tape.child(parent, position));
+		auto end = tape.end(tape.child(parent, position + 1));
+		return decoder::details::NameValue<T, Options>::decode(begin, end, bobl::utility::ObjectNameIrrelevant{}).value();
+	}
+};
+
+// skips tags and returns major type of the tagged value
+template<typename Iterator>
+bobl::cbor::MajorType skip_tags(Iterator& begin, Iterator end)
+{
+	for (;;)
+	{
+		if (begin == end)
+			throw bobl::InputToShort{ "not enought data to decode CBOR value" };
+		auto type = bobl::cbor::utility::decode::major_type(std::uint8_t(*begin));
+		if (type != bobl::cbor::MajorType::Tag)
+			return type;
+		bobl::cbor::utility::decode::integer(begin, end);
+	}
+}
+
+template<typename Iterator, bobl::flyweight::utility::AnyTag Tag>
+std::size_t tape_index(Tape<Iterator> const& tape, bobl::flyweight::lite::utility::AnyType<Iterator, Tag> const& any, bobl::cbor::MajorType expected)
+{
+	auto begin = bobl::flyweight::lite::utility::details::begin_raw(any);
+	auto res = tape.find(begin);
+	if (res == bobl::utility::tape::npos)
+		throw bobl::InvalidObject{ "CBOR value doesn't belong to the tape" };
+	auto type = skip_tags(begin, bobl::flyweight::lite::utility::details::end_raw(any));
+	if (type != expected)
+		throw bobl::IncorrectObjectType{ str(boost::format("CBOR value has unexpected major type : %1% insted of expected %2%") % to_string(type) % to_string(expected)) };
+	return res;
+}
+
+} /*namespace details*/
+
+// Builds structural tape in a single pass: every value and map key gets an entry with its boundaries
+// and index of the entry following its subtree, so any subtree is skipped in O(1) and arrays get O(1) random access.
+// Tags are part of the value they tag.
+template<typename Iterator>
+Tape<Iterator> make_tape(Iterator begin, Iterator end)
+{
+	struct Container
+	{
+		std::uint64_t rest;		// number of items left, keys and values are counted separately for maps
+		bool indefinite;
+	};
+	auto builder = bobl::utility::tape::Builder{};
+	auto stack = std::vector<Container>{};
+	auto first = begin;
+	auto offset = [&first, &begin]() { return std::size_t(std::distance(first, begin)); };
+	do
+	{
+		if (begin == end)
+			throw bobl::InputToShort{ "not enought data to decode CBOR value" };
+		if (!stack.empty() && stack.back().indefinite && std::uint8_t(*begin) == bobl::cbor::Break)
+		{
+			++begin;
+			builder.close(offset());
+			stack.pop_back();
+		}
+		else
+		{
+			auto start = offset();
+			auto type = details::skip_tags(begin, end);
+			switch (type)
+			{
+				case bobl::cbor::MajorType::UnsignedInt:
+				case bobl::cbor::MajorType::NegativeInt:
+				case bobl::cbor::MajorType::SimpleValue:
+				{
+					// break or reserved additional info
+					auto const& initial = bobl::cbor::utility::decode::initial_byte(std::uint8_t(*begin));
+					if (initial.is_break || initial.is_malformed)
+						throw bobl::InvalidObject{ str(boost::format("unexpected CBOR value (%1$#x)") % int(std::uint8_t(*begin))) };
+					bobl::cbor::utility::decode::integer(initial, begin, end);
+					builder.value(start, offset());
+					break;
+				}
+				case bobl::cbor::MajorType::ByteString:
+				case bobl::cbor::MajorType::TextString:
+				{
+					auto skip = [&begin, end, type](std::uint64_t len)
+					{
+						if (std::uint64_t(std::distance(begin, end)) < len)
+							throw bobl::InputToShort{ str(boost::format("not enought data to decode CBOR \"%1%\"") % to_string(type)) };
+						std::advance(begin, len);
+					};
+					auto len = bobl::cbor::utility::decode::length(begin, end);
+					if (len != bobl::cbor::utility::decode::IndefiniteLength)
+						skip(len);
+					else
+					{
+						// indefinite length strings are sequences of definite length chunks of the same type
+						for (;;)
+						{
+							if (begin == end)
+								throw bobl::InputToShort{ str(boost::format("break is missing for indefinite length \"%1%\"") % to_string(type)) };
+							if (std::uint8_t(*begin) == bobl::cbor::Break)
+							{
+								++begin;
+								break;
+							}
+							auto const& chunk = bobl::cbor::utility::decode::initial_byte(std::uint8_t(*begin));
+							if (chunk.major_type != type || chunk.is_indefinite)
+								throw bobl::InvalidObject{ str(boost::format("invalid chunk (%1$#x) of indefinite length \"%2%\"") % int(std::uint8_t(*begin)) % to_string(type)) };
+							skip(bobl::cbor::utility::decode::length(chunk, begin, end));
+						}
+					}
+					builder.value(start, offset());
+					break;
+				}
+				case bobl::cbor::MajorType::Array:
+				case bobl::cbor::MajorType::Dictionary:
+				{
+					auto len = bobl::cbor::utility::decode::length(begin, end);
+					auto indefinite = len == bobl::cbor::utility::decode::IndefiniteLength;
+					builder.open(start);
+					if (!indefinite && type == bobl::cbor::MajorType::Dictionary)
+					{
+						if (len > (bobl::cbor::utility::decode::IndefiniteLength - 1) / 2)
+							throw bobl::InvalidObject{ "CBOR: to many object to decode" };
+						len *= 2;
+					}
+					if (indefinite || len != 0)
+					{
+						stack.push_back(Container{ len, indefinite });
+						continue;
+					}
+					builder.close(offset());
+					break;
+				}
+				default:
+					throw bobl::InvalidObject{ str(boost::format("CBOR tape does not support \"%1%\"") % to_string(type)) };
+			}
+		}
+		// item is complete, close all definite length containers it completes
+		while (!stack.empty() && !stack.back().indefinite && --stack.back().rest == 0)
+		{
+			builder.close(offset());
+			stack.pop_back();
+		}
+	} while (!stack.empty());
+	return std::move(builder).tape(first);
+}
+
+template<typename T, typename Options, typename Iterator>
+boost::iterator_range<bobl::utility::tape::Iterator<T, Options, details::TapeNameValueDecoder, Iterator, 2>> make_iterator_range(Tape<Iterator> const& tape, bobl::flyweight::lite::Object<Iterator> const& object)
+{
+	return bobl::utility::tape::make_iterator_range<T, Options, details::TapeNameValueDecoder, 2>(tape, details::tape_index(tape, object, bobl::cbor::MajorType::Dictionary));
+}
+
+template<typename T, typename Iterator>
+boost::iterator_range<bobl::utility::tape::Iterator<T, bobl::options::None, details::TapeNameValueDecoder, Iterator, 2>> make_iterator_range(Tape<Iterator> const& tape, bobl::flyweight::lite::Object<Iterator> const& object)
+{
+	return make_iterator_range<T, bobl::options::None>(tape, object);
+}
+
+template<typename T, typename Options, typename Iterator>
+boost::iterator_range<bobl::utility::tape::Iterator<T, Options, details::TapeValueDecoder, Iterator, 1>> make_iterator_range(Tape<Iterator> const& tape, bobl::flyweight::lite::Array<Iterator> const& array)
+{
+	return bobl::utility::tape::make_iterator_range<T, Options, details::TapeValueDecoder, 1>(tape, details::tape_index(tape, array, bobl::cbor::MajorType::Array));
+}
+
+template<typename T, typename Iterator>
+boost::iterator_range<bobl::utility::tape::Iterator<T, bobl::options::None, details::TapeValueDecoder, Iterator, 1>> make_iterator_range(Tape<Iterator> const& tape, bobl::flyweight::lite::Array<Iterator> const& array)
+{
+	return make_iterator_range<T, bobl::options::None>(tape, array);
+}
+
+// number of array elements, O(1)
+template<typename Iterator>
+std::size_t size(Tape<Iterator> const& tape, bobl::flyweight::lite::Array<Iterator> const& array)
+{
+	return tape.children(details::tape_index(tape, array, bobl::cbor::MajorType::Array));
+}
+
+// n-th array element, O(1) once array entry is located on the tape
+template<typename T, typename Options = bobl::options::None, typename Iterator>
+T at(Tape<Iterator> const& tape, bobl::flyweight::lite::Array<Iterator> const& array, std::size_t n)
+{
+	auto index = details::tape_index(tape, array, bobl::cbor::MajorType::Array);
+	if (n >= tape.children(index))
+		throw bobl::RangeError{ str(boost::format("CBOR array index %1% is out of range [0, %2%)") % n % tape.children(index)) };
+	return details::TapeDecoder<T>::template decode<Options>(tape, tape.child(index, n));
+}
+
+// position past the value starting at position
+template<typename Iterator>
+Iterator skip(Tape<Iterator> const& tape, Iterator position)
+{
+	auto index = tape.find(position);
+	if (index == bobl::utility::tape::npos)
+		throw bobl::InvalidObject{ "CBOR value doesn't belong to the tape" };
+	return tape.end(index);
+}
+
+}/*namespace cbor*/ } /*namespace bobl*/
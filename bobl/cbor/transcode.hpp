@@ -0,0 +1,304 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/cbor/details/utility.hpp"
+#include "bobl/cbor/details/options.hpp"
+#include "bobl/cbor/cbor.hpp"
+#include "bobl/utility/transcoder.hpp"
+#include "bobl/utility/float.hpp"
+#include "bobl/utility/diversion.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/format.hpp>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace transcoder{
+
+template<>
+class Reader<bobl::cbor::NsTag>
+{
+public:
+	template<typename Iterator, typename Writer>
+	static void read(Iterator& begin, Iterator end, Writer& writer)
+	{
+		static_assert(std::is_pointer<Iterator>::value && sizeof(typename std::iterator_traits<Iterator>::value_type) == 1, "CBOR transcoder requires contiguous input");
+		value(begin, end, writer);
+	}
+private:
+	template<typename Iterator>
+	static std::pair<Iterator, Iterator> payload(Iterator& begin, Iterator end)
+	{
+		auto len = bobl::cbor::utility::decode::length(begin, end);
+		if (len == bobl::cbor::utility::decode::IndefiniteLength)
+			throw bobl::TypeNotSupported{ "indefinite length CBOR strings can't be transcoded" };
+		if (std::uint64_t(std::distance(begin, end)) < len)
+			throw bobl::InvalidObject{ "not enough data provided to decode CBOR string" };
+		auto first = begin;
+		std::advance(begin, len);
+		return { first, begin };
+	}
+
+	template<typename Iterator>
+	static bool is_break(Iterator begin, Iterator end)
+	{
+		if (begin == end)
+			throw bobl::InputToShort{ "not enought data to decode CBOR value" };
+		return std::uint8_t(*begin) == bobl::cbor::Break;
+	}
+
+	template<typename Iterator, typename Writer>
+	static void entry(Iterator& begin, Iterator end, Writer& writer)
+	{
+		if (begin == end)
+			throw bobl::InputToShort{ "not enought data to decode CBOR dictionary key" };
+		switch (auto type = bobl::cbor::utility::decode::major_type(std::uint8_t(*begin)))
+		{
+			case bobl::cbor::MajorType::TextString:
+			{
+				auto text = payload(begin, end);
+				writer.name(diversion::string_view{ reinterpret_cast<char const*>(text.first), std::size_t(std::distance(text.first, text.second)) });
+				break;
+			}
+			case bobl::cbor::MajorType::UnsignedInt:
+			{
+				// name has to stay valid till the value is written
+				details::Decimal key{ bobl::cbor::utility::decode::integer(begin, end) };
+				writer.name(key.view());
+				value(begin, end, writer);
+				return;
+			}
+			default:
+				throw bobl::TypeNotSupported{ str(boost::format("CBOR dictionary key of type %1% can't be transcoded") % to_string(type)) };
+		}
+		value(begin, end, writer);
+	}
+
+	template<typename Iterator, typename Writer>
+	static void value(Iterator& begin, Iterator end, Writer& writer)
+	{
+		if (begin == end)
+			throw bobl::InputToShort{ "not enought data to decode CBOR value" };
+		auto type = bobl::cbor::utility::decode::type(std::uint8_t(*begin));
+		switch (bobl::cbor::utility::decode::major_type(type))
+		{
+			case bobl::cbor::MajorType::UnsignedInt:
+				writer.unsigned_integer(bobl::cbor::utility::decode::integer(begin, end));
+				break;
+			case bobl::cbor::MajorType::NegativeInt:
+			{
+				auto value = bobl::cbor::utility::decode::integer(begin, end);
+				if (value > std::uint64_t((std::numeric_limits<std::int64_t>::max)()))
+					throw bobl::Overflow{ str(boost::format("-%1% - 1 doesn't fit into 64 bit integer") % value) };
+				writer.integer(-std::int64_t(value) - 1);
+				break;
+			}
+			case bobl::cbor::MajorType::ByteString:
+			{
+				auto bytes = payload(begin, end);
+				writer.binary(reinterpret_cast<std::uint8_t const*>(bytes.first), reinterpret_cast<std::uint8_t const*>(bytes.second));
+				break;
+			}
+			case bobl::cbor::MajorType::TextString:
+			{
+				auto text = payload(begin, end);
+				writer.string(diversion::string_view{ reinterpret_cast<char const*>(text.first), std::size_t(std::distance(text.first, text.second)) });
+				break;
+			}
+			case bobl::cbor::MajorType::Array:
+			{
+				auto size = bobl::cbor::utility::decode::length(begin, end);
+				auto indefinite = size == bobl::cbor::utility::decode::IndefiniteLength;
+				writer.begin_array(indefinite ? UnknownSize : std::size_t(size));
+				for (; indefinite ? !is_break(begin, end) : size != 0; --size)
+					value(begin, end, writer);
+				if (indefinite)
+					++begin;
+				writer.end_array();
+				break;
+			}
+			case bobl::cbor::MajorType::Dictionary:
+			{
+				auto size = bobl::cbor::utility::decode::length(begin, end);
+				auto indefinite = size == bobl::cbor::utility::decode::IndefiniteLength;
+				writer.begin_object(indefinite ? UnknownSize : std::size_t(size));
+				for (; indefinite ? !is_break(begin, end) : size != 0; --size)
+					entry(begin, end, writer);
+				if (indefinite)
+					++begin;
+				writer.end_object();
+				break;
+			}
+			case bobl::cbor::MajorType::Tag:
+				tagged(begin, end, writer);
+				break;
+			case bobl::cbor::MajorType::SimpleValue:
+				switch (type)
+				{
+					case bobl::cbor::False:
+					case bobl::cbor::True:
+						writer.boolean(type == bobl::cbor::True);
+						++begin;
+						break;
+					case bobl::cbor::Null:
+					case bobl::cbor::Undefined:
+						writer.null();
+						++begin;
+						break;
+					case bobl::cbor::Float16:
+					case bobl::cbor::Float32:
+					case bobl::cbor::Float64:
+						writer.floating_point(bobl::cbor::utility::decode::floating_point<double>(begin, end));
+						break;
+					default:
+						throw bobl::TypeNotSupported{ str(boost::format("CBOR simple value %1% (%2$#x) can't be transcoded") % to_string(type) % int(type)) };
+				}
+				break;
+		}
+	}
+
+	// seconds since epoch, -1 - seconds if negative, in milliseconds
+	static std::int64_t milliseconds(std::uint64_t seconds, bool negative)
+	{
+		if (seconds > std::uint64_t((std::numeric_limits<std::int64_t>::max)() / 1000) - (negative ? 1 : 0))
+			throw bobl::Overflow{ str(boost::format("CBOR Date/Time %1%%2% seconds doesn't fit int64 milliseconds") % (negative ? "-1 - " : "") % seconds) };
+		return negative ? (-std::int64_t(seconds) - 1) * 1000 : std::int64_t(seconds) * 1000;
+	}
+
+	template<typename Iterator, typename Writer>
+	static void tagged(Iterator& begin, Iterator end, Writer& writer)
+	{
+		switch (bobl::cbor::utility::decode::integer(begin, end))
+		{
+			case bobl::cbor::DataTimeNumerical:
+			{
+				if (begin == end)
+					throw bobl::InputToShort{ "not enought data to decode CBOR Date/Time" };
+				switch (auto type = bobl::cbor::utility::decode::major_type(std::uint8_t(*begin)))
+				{
+					case bobl::cbor::MajorType::UnsignedInt:
+						writer.time_point(milliseconds(bobl::cbor::utility::decode::integer(begin, end), false));
+						break;
+					case bobl::cbor::MajorType::NegativeInt:
+						writer.time_point(milliseconds(bobl::cbor::utility::decode::integer(begin, end), true));
+						break;
+					case bobl::cbor::MajorType::Float:
+					{
+						auto seconds = bobl::cbor::utility::decode::floating_point<double>(begin, end);
+						// 2^63 is exactly representable, so range is checked before rounding
+						if (!(std::fabs(seconds * 1000) < 9223372036854775808.0))
+							throw bobl::Overflow{ str(boost::format("CBOR Date/Time %1% seconds doesn't fit int64 milliseconds") % seconds) };
+						writer.time_point(std::int64_t(std::llround(seconds * 1000)));
+						break;
+					}
+					default:
+						throw bobl::InvalidObject(str(boost::format("CBOR numerical tagged Date/Time has unsupported type \"%1%\"") % to_string(type)));
+				}
+				break;
+			}
+			case bobl::cbor::UUID:
+			{
+				bobl::cbor::utility::decode::validate<bobl::cbor::MajorType::ByteString>(begin, end);
+				auto bytes = payload(begin, end);
+				if (std::distance(bytes.first, bytes.second) != 16)
+					throw bobl::InvalidObject{ "CBOR UUID expected to be 16 bytes long" };
+				writer.uuid(reinterpret_cast<std::uint8_t const*>(bytes.first));
+				break;
+			}
+			default:
+				// semantic of unknown tags is lost, tagged value is transcoded as is
+				value(begin, end, writer);
+		}
+	}
+};
+
+template<typename Sink>
+class Writer<bobl::cbor::NsTag, Sink>
+{
+public:
+	explicit Writer(Sink& sink) : sink_{ sink } {}
+
+	void null() { put(bobl::cbor::Null); }
+	void boolean(bool value) { put(value ? bobl::cbor::True : bobl::cbor::False); }
+	void integer(std::int64_t value)
+	{
+		if (value < 0)
+			header(bobl::cbor::MajorType::NegativeInt, std::uint64_t(-(value + 1)));
+		else
+			header(bobl::cbor::MajorType::UnsignedInt, std::uint64_t(value));
+	}
+	void unsigned_integer(std::uint64_t value) { header(bobl::cbor::MajorType::UnsignedInt, value); }
+	void floating_point(double value)
+	{
+		// narrowing of finite value out of float range is undefined
+		if (!std::isfinite(value) || (std::fabs(value) <= (std::numeric_limits<float>::max)() && float(value) == value))
+			bobl::cbor::utility::encode::unsigned_int_strict(std::back_inserter(sink_), bobl::cbor::MajorType::Float, bobl::utility::FloatConverter<sizeof(std::uint32_t)>{}(float(value)));
+		else
+			bobl::cbor::utility::encode::unsigned_int_strict(std::back_inserter(sink_), bobl::cbor::MajorType::Float, bobl::utility::FloatConverter<sizeof(std::uint64_t)>{}(value));
+	}
+	void string(diversion::string_view value)
+	{
+		header(bobl::cbor::MajorType::TextString, value.size());
+		append(value.data(), value.data() + value.size());
+	}
+	void binary(std::uint8_t const* begin, std::uint8_t const* end)
+	{
+		header(bobl::cbor::MajorType::ByteString, std::uint64_t(std::distance(begin, end)));
+		append(begin, end);
+	}
+	void uuid(std::uint8_t const* data)
+	{
+		header(bobl::cbor::MajorType::Tag, std::uint64_t(bobl::cbor::UUID));
+		binary(data, data + 16);
+	}
+	void time_point(std::int64_t milliseconds)
+	{
+		header(bobl::cbor::MajorType::Tag, std::uint64_t(bobl::cbor::DataTimeNumerical));
+		if (milliseconds % 1000 == 0)
+			integer(milliseconds / 1000);
+		else
+			bobl::cbor::utility::encode::unsigned_int_strict(std::back_inserter(sink_), bobl::cbor::MajorType::Float, bobl::utility::FloatConverter<sizeof(std::uint64_t)>{}(double(milliseconds) / 1000));
+	}
+	void begin_array(std::size_t size) { open(bobl::cbor::MajorType::Array, size); }
+	void end_array() { close(); }
+	void begin_object(std::size_t size) { open(bobl::cbor::MajorType::Dictionary, size); }
+	void name(diversion::string_view name) { string(name); }
+	void end_object() { close(); }
+private:
+	void put(std::uint8_t value) { sink_.push_back(typename Sink::value_type(value)); }
+
+	template<typename T>
+	void append(T const* begin, T const* end)
+	{
+		auto first = reinterpret_cast<typename Sink::value_type const*>(begin);
+		sink_.insert(std::end(sink_), first, first + std::distance(begin, end));
+	}
+
+	void header(bobl::cbor::MajorType type, std::uint64_t value) { bobl::cbor::utility::encode::unsigned_int(std::back_inserter(sink_), type, value); }
+
+	void open(bobl::cbor::MajorType type, std::size_t size)
+	{
+		indefinite_.push_back(size == UnknownSize);
+		if (size == UnknownSize)
+			put(std::uint8_t(type) | 31);
+		else
+			header(type, size);
+	}
+
+	void close()
+	{
+		if (indefinite_.back())
+			put(bobl::cbor::Break);
+		indefinite_.pop_back();
+	}
+private:
+	Sink& sink_;
+	std::vector<bool> indefinite_;
+};
+
+}/*namespace transcoder*/} /*namespace bobl*/
@@ -0,0 +1,44 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/cbor/details/decoder.hpp"
+#include "bobl/cbor/details/options.hpp"
+#include "bobl/cbor/details/utility.hpp"
+#include "bobl/utility/view.hpp"
+#include "bobl/options.hpp"
+#include <utility>
+#include <cstdint>
+
+namespace bobl{ namespace cbor { 
+
+// typed view over CBOR map, members are decoded on access, see bobl::utility::LazyDictionary
+//	auto view = bobl::cbor::view<T>(begin, end);
+//	auto price = view.get<2>(); /*or*/ view.get(&T::price); /*or c++17*/ view.get<&T::price>();
+// encoded data has to outlive the view
+template<typename T, typename Options = bobl::options::None, typename Iterator = std::uint8_t const*> class View;
+
+template<typename T, typename ...Options, typename Iterator>
+class View<T, bobl::Options<Options...>, Iterator> 
+	: public bobl::utility::LazyDictionary<T, Iterator, decoder::details::DictionaryValueDecoder<Iterator, Options...>, decoder::details::EndOfMap, Options...>
+{
+	using Base = bobl::utility::LazyDictionary<T, Iterator, decoder::details::DictionaryValueDecoder<Iterator, Options...>, decoder::details::EndOfMap, Options...>;
+	View(std::pair<Iterator, std::uint64_t> const& map, Iterator end) : Base{ map.first, end, decoder::details::EndOfMap{ map.second } } {}
+public:
+	View(Iterator begin, Iterator end) : View{ header(begin, end), end } {}
+private:
+	static std::pair<Iterator, std::uint64_t> header(Iterator begin, Iterator end)
+	{
+		bobl::cbor::utility::decode::validate<cbor::MajorType::Dictionary>(begin, end);
+		auto len = bobl::cbor::utility::decode::length(begin, end);
+		return { begin, len };
+	}
+};
+
+// unlike decode begin is not advanced, that would require to scan the whole map
+template<typename T, typename Options = bobl::options::None, typename Iterator>
+View<T, Options, Iterator> view(Iterator begin, Iterator end)
+{
+	return View<T, Options, Iterator>{ begin, end };
+}
+
+}/*namespace cbor*/ } /*namespace bobl*/
@@ -6,6 +6,8 @@
 #include "bobl/json/details/options.hpp"
 #include "bobl/utility/parameters.hpp"
 #include "bobl/utility/any.hpp"
+#include "bobl/utility/stats.hpp"
+#include "bobl/utility/profile.hpp"
 #include "bobl/bobl.hpp"
 #include <type_traits>
 
@@ -31,10 +33,12 @@ Type type(bobl::flyweight::lite::utility::AnyType<Iterator, Tag> const& any)
 template<typename ...Args, typename Iterator>
 auto decode(Iterator& begin, Iterator end) -> typename bobl::utility::DecodeParameters<bobl::json::NsTag, Args...>::Result
 {
-	using Parameters = typename bobl::utility::DecodeParameters<bobl::json::NsTag, Args...>::Parameters;
-	using Options = typename bobl::utility::DecodeParameters<bobl::json::NsTag, Args...>::Options;
-	using Decoder = typename decoder::details::Decoder<bobl::json::NsTag, Parameters, Options>::type;
-	return bobl::utility::DecodeParameters<bobl::json::NsTag, Args...>::result(Decoder::decode(begin, end));
+	using Parameters = bobl::utility::DecodeParameters<bobl::json::NsTag, Args...>;
+	using Decoder = typename decoder::details::Decoder<typename Parameters::Result, typename Parameters::Options>::type;
+	auto position = bobl::stats::position(begin);
+	auto res = bobl::profile::measure<typename Parameters::Result, bobl::profile::Operation::Decode>([&begin, end]() { return Decoder::decode(begin, end); });
+	bobl::stats::scanned(position, begin);
+	return res;
 }
 
 }/*namespace json*/ } /*namespace bobl*/
\ No newline at end of file
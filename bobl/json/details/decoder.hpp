@@ -12,6 +12,7 @@
 #include "bobl/utility/parameters.hpp"
 #include "bobl/utility/adapter.hpp"
 #include "bobl/utility/decoders.hpp"
+#include "bobl/utility/stats.hpp"
 #include "bobl/utility/diversion.hpp"
 #include "bobl/bobl.hpp"
 #include <boost/fusion/adapted/std_tuple.hpp>
@@ -171,6 +172,7 @@ public:
 			auto begin = range.begin();
 			return Decoder::decode(begin, range.end());
 		});
+		bobl::stats::elements<T>(res.size());
 		return res;
 	}
 };
@@ -203,6 +205,7 @@ private:
 		}
 		catch (bobl::IncorrectObjectType&)
 		{
+			bobl::stats::exception();
 		}
 		begin = i;
 		return try_decode<Iterator, Args...>(begin, end);
@@ -97,6 +97,8 @@ private:
 	boost::spirit::qi::rule<Iterator, bobl::Type(), boost::spirit::qi::ascii::space_type> value_type_;
 };
 
+inline bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
 struct Name
 {
 	template<typename Iterator>
@@ -150,7 +152,8 @@ struct ObjectOpen
 	static void parse(Iterator& begin, Iterator end)
 	{
 		if (!boost::spirit::qi::phrase_parse(begin, end, boost::spirit::ascii::char_('{'), boost::spirit::ascii::space))
-			throw bobl::InvalidObject{ "JSON object opening '{' is missing" };	}
+			throw bobl::InvalidObject{ "JSON object opening '{' is missing" };
+	}
 };
 
 struct ArrayOpen
@@ -159,7 +162,8 @@ struct ArrayOpen
 	static void parse(Iterator& begin, Iterator end)
 	{
 		if (!boost::spirit::qi::phrase_parse(begin, end, boost::spirit::ascii::char_('['), boost::spirit::ascii::space))
-			throw bobl::InvalidObject{ "JSON array opening '[' is missing" };	}
+			throw bobl::InvalidObject{ "JSON array opening '[' is missing" };
+	}
 };
 
 
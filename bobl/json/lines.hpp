@@ -0,0 +1,188 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+
+#include "bobl/json/decode.hpp"
+#include "bobl/json/details/parser.hpp"
+#include "bobl/utility/parallel.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <boost/format.hpp>
+#include <istream>
+#include <mutex>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+
+namespace bobl{ namespace json {
+
+enum class Order
+{
+	Ordered,	// handler is called from the calling thread in record order
+	Unordered	// handler is called from worker threads (one at a time) as soon as batch of records is decoded
+};
+
+namespace details {
+
+inline char const* find_newline(char const* begin, char const* end)
+{
+	// memchr is vectorized by any decent C runtime
+	auto res = static_cast<char const*>(std::memchr(begin, '\n', std::size_t(end - begin)));
+	return res == nullptr ? end : res;
+}
+
+inline bool is_blank(char const* begin, char const* end)
+{
+	for (; begin != end; ++begin)
+	{
+		if (!parser::is_space(*begin))
+			return false;
+	}
+	return true;
+}
+
+} /*namespace details*/
+
+// decodes newline delimited JSON (JSON Lines, NDJSON) records into T on several threads,
+// blank lines are skipped, record index passed to the handler doesn't count them
+template<typename T, typename Options = bobl::options::None>
+class LinesDecoder
+{
+public:
+	explicit LinesDecoder(std::size_t threads = 0, std::size_t batch = 256)
+		: pool_{ threads }, batch_{ (std::max)(batch, std::size_t{ 1 }) } {}
+
+	// decodes records of [begin, end) calling handler(std::size_t index, T&& value) for every one of them,
+	// when last is false trailing record without '\n' is left undecoded.
+	// returns beginning of not processed tail
+	template<typename Handler>
+	char const* decode(char const* begin, char const* end, Handler&& handler, Order order = Order::Ordered, bool last = true)
+	{
+		while (begin != end)
+		{
+			auto next = split(begin, end, last);
+			if (next == begin)
+				break;
+			process(handler, order);
+			begin = next;
+		}
+		return begin;
+	}
+
+	// number of records decoded so far
+	std::size_t records() const { return index_; }
+
+	template<typename Iterator>
+	static T decode_record(Iterator begin, Iterator end)
+	{
+		auto res = bobl::json::decode<T, Options>(begin, end);
+		while (begin != end && parser::is_space(*begin))
+			++begin;
+		if (begin != end)
+			throw bobl::InvalidObject{ str(boost::format("JSON record unexpected symbol found \"%1%\" after the value") % *begin) };
+		return res;
+	}
+private:
+	char const* split(char const* begin, char const* end, bool last)
+	{
+		auto const segment = pool_.size() * batch_ * 4;
+		records_.clear();
+		while (begin != end && records_.size() < segment)
+		{
+			auto eol = details::find_newline(begin, end);
+			if (eol == end && !last)
+				break;
+			auto record_end = eol != begin && *(eol - 1) == '\r' ? eol - 1 : eol;
+			if (!details::is_blank(begin, record_end))
+				records_.emplace_back(begin, record_end);
+			begin = eol == end ? end : eol + 1;
+		}
+		return begin;
+	}
+
+	template<typename Handler>
+	void process(Handler& handler, Order order)
+	{
+		auto const n = records_.size();
+		auto const base = index_;
+		auto const batches = (n + batch_ - 1) / batch_;
+		if (results_.size() < batches)
+			results_.resize(batches);
+		std::mutex guard;
+		pool_.parallel_for(n, batch_, [this, &handler, &guard, order, base](std::size_t /*worker*/, std::size_t batch, std::size_t first, std::size_t last)
+		{
+			auto& results = results_[batch];
+			results.clear();
+			for (auto i = first; i != last; ++i)
+				results.push_back(decode_record(records_[i].begin(), records_[i].end()));
+			if (order == Order::Unordered)
+			{
+				std::lock_guard<std::mutex> lock{ guard };
+				for (auto& value : results)
+					handler(base + first++, std::move(value));
+			}
+		});
+		if (order == Order::Ordered)
+		{
+			auto index = base;
+			for (std::size_t batch = 0; batch != batches; ++batch)
+			{
+				for (auto& value : results_[batch])
+					handler(index++, std::move(value));
+			}
+		}
+		index_ += n;
+	}
+private:
+	bobl::utility::ThreadPool pool_;	// workers are started once and serve all the segments
+	std::size_t batch_;
+	std::size_t index_ = 0;
+	std::vector<boost::iterator_range<char const*>> records_;
+	std::vector<std::vector<T>> results_; // per batch scratch, reused between segments
+};
+
+// decodes JSON Lines from memory (e.g. memory-mapped file)
+template<typename T, typename Options = bobl::options::None, typename Handler>
+auto decode_lines(char const* begin, char const* end, Handler&& handler, Order order = Order::Ordered, std::size_t threads = 0)
+	-> typename std::enable_if<!std::is_integral<typename std::decay<Handler>::type>::value, std::size_t>::type
+{
+	LinesDecoder<T, Options> decoder{ threads };
+	decoder.decode(begin, end, handler, order);
+	return decoder.records();
+}
+
+template<typename T, typename Options = bobl::options::None>
+std::vector<T> decode_lines(char const* begin, char const* end, std::size_t threads = 0)
+{
+	auto res = std::vector<T>{};
+	decode_lines<T, Options>(begin, end, [&res](std::size_t, T&& value) { res.push_back(std::move(value)); }, Order::Ordered, threads);
+	return res;
+}
+
+// decodes JSON Lines from the stream reading it by chunks, chunk grows if single record doesn't fit into it
+template<typename T, typename Options = bobl::options::None, typename Handler>
+std::size_t decode_lines(std::istream& in, Handler&& handler, Order order = Order::Ordered, std::size_t threads = 0, std::size_t chunk = 1 << 20)
+{
+	LinesDecoder<T, Options> decoder{ threads };
+	auto buffer = std::vector<char>((std::max)(chunk, std::size_t{ 1 }));
+	auto size = std::size_t{ 0 };
+	for (;;)
+	{
+		if (size == buffer.size())
+			buffer.resize(buffer.size() * 2);
+		in.read(buffer.data() + size, std::streamsize(buffer.size() - size));
+		size += std::size_t(in.gcount());
+		auto const last = !in;
+		auto tail = decoder.decode(buffer.data(), buffer.data() + size, handler, order, last);
+		size = std::size_t(buffer.data() + size - tail);
+		std::memmove(buffer.data(), tail, size);
+		if (last)
+			break;
+	}
+	return decoder.records();
+}
+
+}/*namespace json*/ } /*namespace bobl*/
@@ -0,0 +1,257 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+
+#include "bobl/json/details/decoder.hpp"
+#include "bobl/json/details/parser.hpp"
+#include "bobl/utility/tape.hpp"
+#include "bobl/utility/any.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/format.hpp>
+#include <iterator>
+#include <vector>
+#include <type_traits>
+#include <cstddef>
+
+namespace bobl{ namespace json {
+
+template<typename Iterator>
+using Tape = bobl::utility::tape::Tape<Iterator>;
+
+namespace details {
+
+inline bool is_delimiter(char c) { return parser::is_space(c) || c == ',' || c == ':' || c == ']' || c == '}'; }
+
+enum class TapeState
+{
+	Value,		// value is expected
+	Key,		// object name or '}' is expected
+	Colon,		// ':' is expected
+	Next		// ',' or closing bracket is expected
+};
+
+template<typename T>
+struct TapeDecoder
+{
+	template<typename Options, typename Iterator>
+	static T decode(Tape<Iterator> const& tape, std::size_t index)
+	{
+		auto begin = tape.begin(index);
+		using Decoder = typename decoder::details::Decoder<T, Options>::type;
+		return Decoder::decode(begin, tape.end(index));
+	}
+};
+
+template<typename Iterator, bobl::flyweight::utility::AnyTag Tag>
+struct TapeDecoder<bobl::flyweight::lite::utility::AnyType<Iterator, Tag>>
+{
+	template<typename Options>
+	static bobl::flyweight::lite::utility::AnyType<Iterator, Tag> decode(Tape<Iterator> const& tape, std::size_t index)
+	{
+		return tape.template as<bobl::flyweight::lite::utility::AnyType<Iterator, Tag>>(index);
+	}
+};
+
+template<typename T>
+struct TapeNameValue
+{
+	template<typename Options, typename Iterator>
+	static T decode(Tape<Iterator> const& tape, std::size_t /*key*/, std::size_t value) { return TapeDecoder<T>::template decode<Options>(tape, value); }
+};
+
+template<typename T>
+struct TapeNameValue<bobl::flyweight::NameValue<T>>
+{
+	template<typename Options, typename Iterator>
+	static bobl::flyweight::NameValue<T> decode(Tape<Iterator> const& tape, std::size_t key, std::size_t value)
+	{
+		auto begin = tape.begin(key);
+		auto name = std::string{};
+		if (!boost::spirit::qi::phrase_parse(begin, tape.end(key), bobl::json::parser::String<Iterator>{}, boost::spirit::ascii::space, name))
+			throw bobl::InvalidObject{ "can't parse JSON object name" };
+		return { std::move(name), TapeDecoder<T>::template decode<Options>(tape, value) };
+	}
+};
+
+struct TapeValueDecoder
+{
+	template<typename T, typename Options, typename Iterator>
+	static T decode(Tape<Iterator> const& tape, std::size_t parent, std::size_t position)
+	{
+		return TapeDecoder<T>::template decode<Options>(tape, tape.child(parent, position));
+	}
+};
+
+struct TapeNameValueDecoder
+{
+	template<typename T, typename Options, typename Iterator>
+	static T decode(Tape<Iterator> const& tape, std::size_t parent, std::size_t position)
+	{
+		return TapeNameValue<T>::template decode<Options>(tape, tape.child(parent, position), tape.child(parent, position + 1));
+	}
+};
+
+template<typename Iterator, bobl::flyweight::utility::AnyTag Tag>
+std::size_t tape_index(Tape<Iterator> const& tape, bobl::flyweight::lite::utility::AnyType<Iterator, Tag> const& any, char open)
+{
+	auto begin = bobl::flyweight::lite::utility::details::begin_raw(any);
+	auto end = bobl::flyweight::lite::utility::details::end_raw(any);
+	while (begin != end && parser::is_space(char(*begin)))
+		++begin;
+	if (begin == end || char(*begin) != open)
+		throw bobl::IncorrectObjectType{ str(boost::format("JSON value expected to start with '%1%'") % open) };
+	auto res = tape.find(begin);
+	if (res == bobl::utility::tape::npos)
+		throw bobl::InvalidObject{ "JSON value doesn't belong to the tape" };
+	return res;
+}
+
+} /*namespace details*/
+
+// builds structural tape in a single pass: every value and object name gets an entry
+// with its boundaries and index of the entry following its subtree, so skipping is O(1)
+template<typename Iterator>
+Tape<Iterator> make_tape(Iterator begin, Iterator end)
+{
+	using details::TapeState;
+	auto builder = bobl::utility::tape::Builder{};
+	auto containers = std::vector<char>{};
+	auto state = TapeState::Value;
+	auto offset = std::size_t{ 0 };
+	auto first = begin;
+	auto root = false;
+	while (begin != end)
+	{
+		auto c = char(*begin);
+		if (parser::is_space(c))
+		{
+			++begin;
+			++offset;
+			continue;
+		}
+		if (root && containers.empty())
+			throw bobl::InvalidObject{ str(boost::format("JSON unexpected symbol found \"%1%\" after the value") % c) };
+		switch (state)
+		{
+			case TapeState::Colon:
+				if (c != ':')
+					throw bobl::InvalidObject{ "JSON object ':' is missing" };
+				state = TapeState::Value;
+				++begin;
+				++offset;
+				continue;
+			case TapeState::Next:
+				if (c == ',')
+				{
+					state = containers.back() == '{' ? TapeState::Key : TapeState::Value;
+					++begin;
+					++offset;
+					continue;
+				}
+				if (c != (containers.back() == '{' ? '}' : ']'))
+					throw bobl::InvalidObject{ str(boost::format("JSON unexpected symbol found \"%1%\" (expected delimiter)") % c) };
+				builder.close(++offset);
+				++begin;
+				containers.pop_back();
+				continue;
+			case TapeState::Key:
+				if (c == '}' && builder.children() == 0)
+				{
+					builder.close(++offset);
+					++begin;
+					containers.pop_back();
+					state = TapeState::Next;
+					continue;
+				}
+				if (c != '"')
+					throw bobl::InvalidObject{ "JSON object name expected" };
+				break;
+			case TapeState::Value:
+				if (c == ']' && !containers.empty() && containers.back() == '[' && builder.children() == 0)
+				{
+					builder.close(++offset);
+					++begin;
+					containers.pop_back();
+					state = TapeState::Next;
+					continue;
+				}
+				break;
+		}
+		root = root || containers.empty();
+		switch (c)
+		{
+			case '{':
+			case '[':
+				builder.open(offset++);
+				++begin;
+				containers.push_back(c);
+				state = c == '{' ? TapeState::Key : TapeState::Value;
+				continue;
+			case '"':
+			{
+				auto start = offset;
+				for (++begin, ++offset;; ++begin, ++offset)
+				{
+					if (begin == end)
+						throw bobl::InputToShort{ "JSON string closing '\"' is missing" };
+					if (char(*begin) == '"')
+						break;
+					if (char(*begin) == '\\')
+					{
+						if (++begin == end)
+							throw bobl::InputToShort{ "JSON string escape sequence is incomplete" };
+						++offset;
+					}
+				}
+				builder.value(start, ++offset);
+				++begin;
+				break;
+			}
+			default:
+			{
+				if (state == TapeState::Key || !(c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n'))
+					throw bobl::InvalidObject{ str(boost::format("JSON unexpected symbol found \"%1%\"") % c) };
+				auto start = offset;
+				while (begin != end && !details::is_delimiter(char(*begin)))
+				{
+					++begin;
+					++offset;
+				}
+				builder.value(start, offset);
+			}
+		}
+		state = state == TapeState::Key ? TapeState::Colon : TapeState::Next;
+	}
+	if (!root)
+		throw bobl::InputToShort{ "JSON value is missing" };
+	if (!containers.empty())
+		throw bobl::InputToShort{ str(boost::format("JSON closing '%1%' is missing") % (containers.back() == '{' ? '}' : ']')) };
+	return std::move(builder).tape(first);
+}
+
+template<typename T, typename Options, typename Iterator>
+boost::iterator_range<bobl::utility::tape::Iterator<T, Options, details::TapeNameValueDecoder, Iterator, 2>> make_iterator_range(Tape<Iterator> const& tape, bobl::flyweight::lite::Object<Iterator> const& object)
+{
+	return bobl::utility::tape::make_iterator_range<T, Options, details::TapeNameValueDecoder, 2>(tape, details::tape_index(tape, object, '{'));
+}
+
+template<typename T, typename Iterator>
+boost::iterator_range<bobl::utility::tape::Iterator<T, bobl::options::None, details::TapeNameValueDecoder, Iterator, 2>> make_iterator_range(Tape<Iterator> const& tape, bobl::flyweight::lite::Object<Iterator> const& object)
+{
+	return make_iterator_range<T, bobl::options::None>(tape, object);
+}
+
+template<typename T, typename Options, typename Iterator>
+boost::iterator_range<bobl::utility::tape::Iterator<T, Options, details::TapeValueDecoder, Iterator, 1>> make_iterator_range(Tape<Iterator> const& tape, bobl::flyweight::lite::Array<Iterator> const& array)
+{
+	return bobl::utility::tape::make_iterator_range<T, Options, details::TapeValueDecoder, 1>(tape, details::tape_index(tape, array, '['));
+}
+
+template<typename T, typename Iterator>
+boost::iterator_range<bobl::utility::tape::Iterator<T, bobl::options::None, details::TapeValueDecoder, Iterator, 1>> make_iterator_range(Tape<Iterator> const& tape, bobl::flyweight::lite::Array<Iterator> const& array)
+{
+	return make_iterator_range<T, bobl::options::None>(tape, array);
+}
+
+}/*namespace json*/ } /*namespace bobl*/
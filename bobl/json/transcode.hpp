@@ -0,0 +1,431 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/json/tape.hpp"
+#include "bobl/json/details/options.hpp"
+#include "bobl/utility/transcoder.hpp"
+#include "bobl/utility/diversion.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/spirit/include/qi.hpp>
+#include <boost/format.hpp>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace transcoder{
+
+namespace details {
+
+// decodes JSON string body (no quotes) into UTF-8, returns false if input has no escape sequences (so it can be used as is)
+template<typename Iterator>
+bool unescape(Iterator begin, Iterator end, std::string& out)
+{
+	auto escape = std::find(begin, end, '\\');
+	if (escape == end)
+		return false;
+	out.assign(begin, escape);
+	auto hex = [&end](Iterator& begin) -> std::uint32_t
+	{
+		auto res = std::uint32_t{ 0 };
+		if (std::distance(begin, end) < 4 || !boost::spirit::qi::parse(begin, begin + 4, boost::spirit::qi::uint_parser<std::uint32_t, 16, 4, 4>{}, res))
+			throw bobl::InvalidObject{ "JSON string has invalid \\u escape sequence" };
+		return res;
+	};
+	for (begin = escape; begin != end;)
+	{
+		auto c = *begin++;
+		if (c != '\\')
+		{
+			out.push_back(c);
+			continue;
+		}
+		if (begin == end)
+			throw bobl::InvalidObject{ "JSON string escape sequence is incomplete" };
+		switch (c = *begin++)
+		{
+			case '"': case '\\': case '/': out.push_back(c); break;
+			case 'b': out.push_back('\b'); break;
+			case 'f': out.push_back('\f'); break;
+			case 'n': out.push_back('\n'); break;
+			case 'r': out.push_back('\r'); break;
+			case 't': out.push_back('\t'); break;
+			case 'u':
+			{
+				auto code = hex(begin);
+				if (code >= 0xd800 && code < 0xdc00)
+				{
+					if (std::distance(begin, end) < 2 || *begin != '\\' || *(begin + 1) != 'u')
+						throw bobl::InvalidObject{ "JSON string has unpaired surrogate" };
+					begin += 2;
+					auto low = hex(begin);
+					if (low < 0xdc00 || low >= 0xe000)
+						throw bobl::InvalidObject{ "JSON string has invalid surrogate pair" };
+					code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+				}
+				if (code < 0x80)
+					out.push_back(char(code));
+				else if (code < 0x800)
+				{
+					out.push_back(char(0xc0 | (code >> 6)));
+					out.push_back(char(0x80 | (code & 0x3f)));
+				}
+				else if (code < 0x10000)
+				{
+					out.push_back(char(0xe0 | (code >> 12)));
+					out.push_back(char(0x80 | ((code >> 6) & 0x3f)));
+					out.push_back(char(0x80 | (code & 0x3f)));
+				}
+				else
+				{
+					out.push_back(char(0xf0 | (code >> 18)));
+					out.push_back(char(0x80 | ((code >> 12) & 0x3f)));
+					out.push_back(char(0x80 | ((code >> 6) & 0x3f)));
+					out.push_back(char(0x80 | (code & 0x3f)));
+				}
+				break;
+			}
+			default:
+				throw bobl::InvalidObject{ str(boost::format("JSON string has invalid escape sequence \"\\%1%\"") % c) };
+		}
+	}
+	return true;
+}
+
+} /*namespace details*/
+
+template<>
+class Reader<bobl::json::NsTag>
+{
+	template<typename Iterator>
+	struct Context
+	{
+		bobl::json::Tape<Iterator> tape;
+		std::string name;	// scratch for unescaped names
+		std::string value;	// scratch for unescaped strings
+	};
+public:
+	template<typename Iterator, typename Writer>
+	static void read(Iterator& begin, Iterator end, Writer& writer)
+	{
+		// unescaped strings are passed to writer as views of the input
+		static_assert(std::is_pointer<Iterator>::value && sizeof(typename std::iterator_traits<Iterator>::value_type) == 1, "JSON transcoder requires contiguous input");
+		auto context = Context<Iterator>{ bobl::json::make_tape(begin, end), {}, {} };
+		value(context, 0, writer);
+		begin = end;
+	}
+private:
+	template<typename Iterator>
+	static diversion::string_view string(bobl::json::Tape<Iterator> const& tape, std::size_t index, std::string& scratch)
+	{
+		auto begin = std::next(tape.begin(index));
+		auto end = std::prev(tape.end(index));
+		if (details::unescape(begin, end, scratch))
+			return { scratch.data(), scratch.size() };
+		return { reinterpret_cast<char const*>(&*begin), std::size_t(std::distance(begin, end)) };
+	}
+
+	template<typename Iterator, typename Parser, typename T>
+	static void number(Iterator begin, Iterator end, Parser const& parser, T& value)
+	{
+		auto first = begin;
+		if (!boost::spirit::qi::parse(first, end, parser, value) || first != end)
+			throw bobl::InvalidObject{ str(boost::format("can't parse JSON number \"%1%\"") % std::string(begin, end)) };
+	}
+
+	template<typename Iterator>
+	static bool literal(Iterator begin, Iterator end, char const* value)
+	{
+		auto len = std::strlen(value);
+		return std::size_t(std::distance(begin, end)) == len && std::equal(begin, end, value);
+	}
+
+	template<typename Iterator, typename Writer>
+	static void value(Context<Iterator>& context, std::size_t index, Writer& writer)
+	{
+		auto const& tape = context.tape;
+		auto begin = tape.begin(index);
+		auto end = tape.end(index);
+		switch (*begin)
+		{
+			case '{':
+			{
+				auto n = tape.children(index);
+				writer.begin_object(n / 2);
+				for (std::size_t i = 0; i != n; i += 2)
+				{
+					writer.name(string(tape, tape.child(index, i), context.name));
+					value(context, tape.child(index, i + 1), writer);
+				}
+				writer.end_object();
+				break;
+			}
+			case '[':
+			{
+				auto n = tape.children(index);
+				writer.begin_array(n);
+				for (std::size_t i = 0; i != n; ++i)
+					value(context, tape.child(index, i), writer);
+				writer.end_array();
+				break;
+			}
+			case '"':
+				writer.string(string(tape, index, context.value));
+				break;
+			case 't':
+			case 'f':
+			case 'n':
+				if (literal(begin, end, "true") || literal(begin, end, "false"))
+					writer.boolean(*begin == 't');
+				else if (literal(begin, end, "null"))
+					writer.null();
+				else
+					throw bobl::InvalidObject{ str(boost::format("unexpected JSON literal \"%1%\"") % std::string(begin, end)) };
+				break;
+			default:
+				if (std::find_if(begin, end, [](char c) { return c == '.' || c == 'e' || c == 'E'; }) != end)
+				{
+					auto res = double{};
+					number(begin, end, boost::spirit::qi::double_, res);
+					writer.floating_point(res);
+				}
+				else if (*begin == '-')
+				{
+					auto res = std::int64_t{};
+					number(begin, end, boost::spirit::qi::int_parser<std::int64_t>{}, res);
+					writer.integer(res);
+				}
+				else
+				{
+					auto res = std::uint64_t{};
+					number(begin, end, boost::spirit::qi::uint_parser<std::uint64_t>{}, res);
+					writer.unsigned_integer(res);
+				}
+		}
+	}
+};
+
+template<typename Sink>
+class Writer<bobl::json::NsTag, Sink>
+{
+	enum class Frame : std::uint8_t
+	{
+		Array,
+		Object,
+		Member	// object member name is written, value is expected
+	};
+public:
+	explicit Writer(Sink& sink) : sink_{ sink } {}
+
+	void null() { raw("null"); }
+	void boolean(bool value) { raw(value ? "true" : "false"); }
+	void integer(std::int64_t value)
+	{
+		if (value < 0)
+		{
+			separate();
+			put('-');
+			digits(std::uint64_t(-(value + 1)) + 1);
+		}
+		else
+			unsigned_integer(std::uint64_t(value));
+	}
+	void unsigned_integer(std::uint64_t value)
+	{
+		separate();
+		digits(value);
+	}
+	void floating_point(double value)
+	{
+		if (!std::isfinite(value))
+		{
+			null();
+			return;
+		}
+		char buffer[32];
+		auto len = std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+		if (std::strtod(buffer, nullptr) != value)
+			len = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+		separate();
+		append(buffer, buffer + len);
+		// keep it floating point on the way back
+		if (std::find_if(buffer, buffer + len, [](char c) { return c == '.' || c == 'e'; }) == buffer + len)
+			append(".0", ".0" + 2);
+	}
+	void string(diversion::string_view value)
+	{
+		separate();
+		quoted(value);
+	}
+	void binary(std::uint8_t const* begin, std::uint8_t const* end)
+	{
+		static char const alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		separate();
+		put('"');
+		for (; std::distance(begin, end) >= 3; begin += 3)
+		{
+			auto chunk = std::uint32_t(begin[0]) << 16 | std::uint32_t(begin[1]) << 8 | begin[2];
+			char out[] = { alphabet[chunk >> 18], alphabet[(chunk >> 12) & 0x3f], alphabet[(chunk >> 6) & 0x3f], alphabet[chunk & 0x3f] };
+			append(out, out + sizeof(out));
+		}
+		if (begin != end)
+		{
+			auto chunk = std::uint32_t(begin[0]) << 16 | (begin + 1 != end ? std::uint32_t(begin[1]) << 8 : 0);
+			char out[] = { alphabet[chunk >> 18], alphabet[(chunk >> 12) & 0x3f], begin + 1 != end ? alphabet[(chunk >> 6) & 0x3f] : '=', '=' };
+			append(out, out + sizeof(out));
+		}
+		put('"');
+	}
+	void uuid(std::uint8_t const* data)
+	{
+		static char const hex[] = "0123456789abcdef";
+		char out[38];
+		auto i = out;
+		*i++ = '"';
+		for (std::size_t n = 0; n != 16; ++n)
+		{
+			if (n == 4 || n == 6 || n == 8 || n == 10)
+				*i++ = '-';
+			*i++ = hex[data[n] >> 4];
+			*i++ = hex[data[n] & 0xf];
+		}
+		*i++ = '"';
+		separate();
+		append(out, i);
+	}
+	// ISO 8601 UTC
+	void time_point(std::int64_t milliseconds)
+	{
+		auto ms = milliseconds % 1000;
+		auto seconds = milliseconds / 1000 - (ms < 0 ? 1 : 0);
+		ms = (ms + 1000) % 1000;
+		auto days = seconds / 86400 - (seconds % 86400 < 0 ? 1 : 0);
+		auto time = seconds - days * 86400;
+		// http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+		auto z = days + 719468;
+		auto era = (z >= 0 ? z : z - 146096) / 146097;
+		auto doe = z - era * 146097;
+		auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+		auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+		auto mp = (5 * doy + 2) / 153;
+		auto day = doy - (153 * mp + 2) / 5 + 1;
+		auto month = mp < 10 ? mp + 3 : mp - 9;
+		auto year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+		char buffer[40];
+		auto len = std::snprintf(buffer, sizeof(buffer), "\"%04lld-%02lld-%02lldT%02lld:%02lld:%02lld.%03lldZ\"",
+									static_cast<long long>(year), static_cast<long long>(month), static_cast<long long>(day),
+									static_cast<long long>(time / 3600), static_cast<long long>(time % 3600 / 60), static_cast<long long>(time % 60), static_cast<long long>(ms));
+		separate();
+		append(buffer, buffer + len);
+	}
+	void begin_array(std::size_t /*size*/) { open('[', Frame::Array); }
+	void end_array() { close(']'); }
+	void begin_object(std::size_t /*size*/) { open('{', Frame::Object); }
+	void name(diversion::string_view name)
+	{
+		if (!first_)
+			put(',');
+		first_ = false;
+		quoted(name);
+		put(':');
+		stack_.back() = Frame::Member;
+	}
+	void end_object() { close('}'); }
+private:
+	void put(char c) { sink_.push_back(typename Sink::value_type(c)); }
+
+	void append(char const* begin, char const* end)
+	{
+		auto first = reinterpret_cast<typename Sink::value_type const*>(begin);
+		sink_.insert(std::end(sink_), first, first + std::distance(begin, end));
+	}
+
+	void raw(char const* value)
+	{
+		separate();
+		append(value, value + std::strlen(value));
+	}
+
+	void digits(std::uint64_t value)
+	{
+		details::Decimal decimal{ value };
+		append(decimal.view().data(), decimal.view().data() + decimal.view().size());
+	}
+
+	// writes ',' between array elements, object members are separated by name()
+	void separate()
+	{
+		if (stack_.empty())
+			return;
+		if (stack_.back() == Frame::Member)
+		{
+			stack_.back() = Frame::Object;
+			return;
+		}
+		if (!first_)
+			put(',');
+		first_ = false;
+	}
+
+	void open(char bracket, Frame frame)
+	{
+		separate();
+		put(bracket);
+		stack_.push_back(frame);
+		first_ = true;
+	}
+
+	void close(char bracket)
+	{
+		put(bracket);
+		stack_.pop_back();
+		first_ = false;
+	}
+
+	void quoted(diversion::string_view value)
+	{
+		static char const hex[] = "0123456789abcdef";
+		put('"');
+		auto begin = value.data();
+		auto end = begin + value.size();
+		for (auto i = begin; i != end; ++i)
+		{
+			auto c = std::uint8_t(*i);
+			if (c >= 0x20 && c != '"' && c != '\\')
+				continue;
+			append(begin, i);
+			begin = i + 1;
+			put('\\');
+			switch (c)
+			{
+				case '"': put('"'); break;
+				case '\\': put('\\'); break;
+				case '\b': put('b'); break;
+				case '\f': put('f'); break;
+				case '\n': put('n'); break;
+				case '\r': put('r'); break;
+				case '\t': put('t'); break;
+				default:
+				{
+					char out[] = { 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+					append(out, out + sizeof(out));
+				}
+			}
+		}
+		append(begin, end);
+		put('"');
+	}
+private:
+	Sink& sink_;
+	bool first_ = true;
+	std::vector<Frame> stack_;
+};
+
+}/*namespace transcoder*/} /*namespace bobl*/
@@ -13,6 +13,7 @@ public:
 };
 
 template<typename Type, typename MemberType, std::size_t Position, typename Options> class MemberName;
+template<typename Type, typename MemberType, std::size_t Position, typename Options> class MemberId;
 
 
 } /*namespace bobl*/
@@ -7,6 +7,7 @@
 #include <boost/fusion/mpl.hpp>
 #include <boost/mpl/contains.hpp>
 #include <type_traits>
+#include <cstddef>
 
 namespace bobl{ 
 
@@ -27,6 +28,16 @@ namespace options {
 	template<typename T> using NonUniformArray = HeterogeneousArray<T>;
 	struct OptionalAsNull {};
 	template<typename T> struct UseTypeName { static_assert(utility::IsVariant<T>::value, "valid only for variants"); };
+	// arrays encoded in at least Threshold bytes are decoded on bobl::utility::shared_pool() workers,
+	// vectors taking at least Threshold bytes in memory are encoded in chunks there as well, if the pool is busy they're processed on the calling thread
+	template<std::size_t Threshold = (1 << 20)> struct ParallelArrays {};
+	// text strings are checked to be well formed UTF-8 while decoded and encoded, bobl::InvalidObject is thrown otherwise
+	struct ValidateUtf8 {};
+	// CBOR struct members are keyed by unsigned integers, bobl::MemberId (member position by default), instead of their names
+	struct IndexKeys {};
+	// CBOR value is encoded as stringref namespace (tag 256), repeated strings are replaced with references (tag 25) to the first one;
+	// decoding resolves such references only with this option
+	struct StringRefs {};
 }// namespace options
 
 template<typename T, typename ...Options>
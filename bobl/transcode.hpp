@@ -0,0 +1,31 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/bson/transcode.hpp"
+#include "bobl/cbor/transcode.hpp"
+#include "bobl/json/transcode.hpp"
+#include "bobl/utility/transcoder.hpp"
+#include <vector>
+#include <cstdint>
+
+namespace bobl{
+
+// converts value encoded as From (bobl::bson::NsTag, bobl::cbor::NsTag, bobl::json::NsTag) to To encoding
+// without decoding it into C++ types, result is appended to the sink (std::vector<std::uint8_t>, std::string...)
+template<typename From, typename To, typename Iterator, typename Sink>
+Sink& transcode(Iterator& begin, Iterator end, Sink& sink)
+{
+	auto writer = transcoder::Writer<To, Sink>{ sink };
+	transcoder::Reader<From>::read(begin, end, writer);
+	return sink;
+}
+
+template<typename From, typename To, typename Iterator>
+std::vector<std::uint8_t> transcode(Iterator& begin, Iterator end)
+{
+	auto res = std::vector<std::uint8_t>{};
+	transcode<From, To>(begin, end, res);
+	return res;
+}
+
+} /*namespace bobl*/
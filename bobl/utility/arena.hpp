@@ -0,0 +1,69 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace utility{
+
+// bump allocator over caller provided memory, nothing is freed till reset()
+class Arena
+{
+public:
+	Arena(void* buffer, std::size_t size) : begin_{ static_cast<unsigned char*>(buffer) }, current_{ begin_ }, end_{ begin_ + size } {}
+	Arena(Arena const&) = delete;
+	Arena& operator=(Arena const&) = delete;
+
+	// all the free space as array of T, lets to fill it before it is known how much is going to be used, see allocate
+	template<typename T>
+	std::pair<T*, std::size_t> available() const
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "arena never calls destructors");
+		auto begin = align<T>();
+		return begin == nullptr ? std::pair<T*, std::size_t>{ nullptr, 0 } : std::pair<T*, std::size_t>{ reinterpret_cast<T*>(begin), std::size_t(end_ - begin) / sizeof(T) };
+	}
+
+	// n uninitialized T, throws std::bad_alloc if there is not enough space left
+	template<typename T>
+	T* allocate(std::size_t n)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "arena never calls destructors");
+		auto begin = align<T>();
+		if (begin == nullptr || std::size_t(end_ - begin) / sizeof(T) < n)
+			throw std::bad_alloc{};
+		current_ = begin + n * sizeof(T);
+		return reinterpret_cast<T*>(begin);
+	}
+
+	std::size_t used() const { return std::size_t(current_ - begin_); }
+	std::size_t capacity() const { return std::size_t(end_ - begin_); }
+	void reset() { current_ = begin_; }
+private:
+	// first suitably aligned free address or nullptr if there is none
+	template<typename T>
+	unsigned char* align() const
+	{
+		auto address = reinterpret_cast<std::uintptr_t>(current_);
+		auto padding = (alignof(T) - address % alignof(T)) % alignof(T);
+		return std::size_t(end_ - current_) < padding ? nullptr : current_ + padding;
+	}
+private:
+	unsigned char* begin_;
+	unsigned char* current_;
+	unsigned char* end_;
+};
+
+// arena with inline storage
+template<std::size_t Size>
+class StaticArena : public Arena
+{
+public:
+	StaticArena() : Arena{ &buffer_, Size } {}
+private:
+	typename std::aligned_storage<Size, alignof(std::max_align_t)>::type buffer_;
+};
+
+}/*namespace utility*/} /*namespace bobl*/
@@ -0,0 +1,96 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/utility/parallel.hpp"
+#include "bobl/utility/diversion.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/range/begin.hpp>
+#include <boost/range/end.hpp>
+#include <boost/range/size.hpp>
+#include <exception>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace bobl{ namespace utility{
+
+// outcome of decoding a single item of a batch: either decoded value or the error it failed with
+template<typename T>
+class Result
+{
+public:
+	Result() = default;
+	explicit Result(T value) : value_{ std::move(value) } {}
+	explicit Result(std::exception_ptr error) : error_{ std::move(error) } {}
+
+	explicit operator bool() const { return !error_ && !!value_; }
+	// rethrows the error item failed with
+	T const& value() const &
+	{
+		check();
+		return *value_;
+	}
+	T value() &&
+	{
+		check();
+		return std::move(*value_);
+	}
+	std::exception_ptr error() const { return error_; }
+	// error message, empty if item is decoded
+	std::string what() const
+	{
+		if (!error_)
+			return {};
+		try
+		{
+			std::rethrow_exception(error_);
+		}
+		catch (std::exception const& e)
+		{
+			return e.what();
+		}
+		catch (...)
+		{
+			return "unknown error";
+		}
+	}
+private:
+	void check() const
+	{
+		if (error_)
+			std::rethrow_exception(error_);
+		if (!value_)
+			throw bobl::InvalidObject{ "batch item has not been decoded" };
+	}
+private:
+	diversion::optional<T> value_;
+	std::exception_ptr error_;
+};
+
+// Decodes every span (range of encoded bytes) of random access range spans by Decoder::decode(begin, end)
+// into out[i] (random access iterator to Result<T>) on pool workers, items are independent, so failed ones don't affect the rest.
+// Every worker writes straight into its own consecutive slots of out, so no per item allocation or synchronization is involved.
+template<typename Decoder, typename Spans, typename Iterator>
+void decode_batch(Spans const& spans, Iterator out, bobl::utility::ThreadPool& pool, std::size_t batch = 64)
+{
+	using Value = typename std::iterator_traits<Iterator>::value_type;
+	pool.parallel_for(std::size_t(boost::size(spans)), batch, [&spans, out](std::size_t /*worker*/, std::size_t /*batch*/, std::size_t first, std::size_t last)
+	{
+		auto span = std::next(boost::begin(spans), first);
+		for (auto i = first; i != last; ++i, ++span)
+		{
+			try
+			{
+				out[i] = Value{ Decoder::decode(boost::begin(*span), boost::end(*span)) };
+			}
+			catch (...)
+			{
+				out[i] = Value{ std::current_exception() };
+			}
+		}
+	});
+}
+
+}/*namespace utility*/} /*namespace bobl*/
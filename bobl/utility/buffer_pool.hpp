@@ -0,0 +1,69 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace utility{
+
+// Lock free cache of byte buffers, buffers keep their capacity between uses so steady traffic doesn't allocate.
+// Every slot holds at most one buffer and is taken and refilled by a single atomic exchange, so there is no ABA problem;
+// buffers released while all the slots are taken are freed.
+class BufferPool
+{
+	using Slot = std::atomic<std::vector<std::uint8_t>*>;
+	struct Release
+	{
+		void operator()(std::vector<std::uint8_t>* buffer) const { pool->release(buffer); }
+		BufferPool* pool;
+	};
+public:
+	// returns buffer to the pool it has been taken from, pool has to outlive its buffers
+	using Buffer = std::unique_ptr<std::vector<std::uint8_t>, Release>;
+
+	explicit BufferPool(std::size_t slots = 64) : slots_( new Slot[slots] ), size_{ slots }
+	{
+		for (std::size_t i = 0; i != size_; ++i)
+			slots_[i].store(nullptr, std::memory_order_relaxed);
+	}
+	BufferPool(BufferPool const&) = delete;
+	BufferPool& operator=(BufferPool const&) = delete;
+	~BufferPool()
+	{
+		for (std::size_t i = 0; i != size_; ++i)
+			delete slots_[i].load(std::memory_order_relaxed);
+	}
+
+	// empty buffer, either cached one or newly allocated
+	Buffer acquire()
+	{
+		for (std::size_t i = 0; i != size_; ++i)
+		{
+			if (slots_[i].load(std::memory_order_relaxed) == nullptr)
+				continue;
+			if (auto buffer = slots_[i].exchange(nullptr, std::memory_order_acquire))
+				return Buffer{ buffer, Release{ this } };
+		}
+		return Buffer{ new std::vector<std::uint8_t>, Release{ this } };
+	}
+private:
+	void release(std::vector<std::uint8_t>* buffer)
+	{
+		buffer->clear();
+		for (std::size_t i = 0; i != size_; ++i)
+		{
+			auto empty = static_cast<std::vector<std::uint8_t>*>(nullptr);
+			if (slots_[i].compare_exchange_strong(empty, buffer, std::memory_order_release, std::memory_order_relaxed))
+				return;
+		}
+		delete buffer;
+	}
+private:
+	std::unique_ptr<Slot[]> slots_;
+	std::size_t size_;
+};
+
+}/*namespace utility*/} /*namespace bobl*/
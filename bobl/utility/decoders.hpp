@@ -6,42 +6,108 @@
 #include "bobl/options.hpp"
 #include "bobl/bobl.hpp"
 #include "bobl/utility/type_name.hpp"
+#include "bobl/utility/stats.hpp"
+#include "bobl/utility/profile.hpp"
 #include "bobl/utility/diversion.hpp"
 #include <boost/fusion/include/at.hpp>
 #include <boost/fusion/include/size.hpp>
 #include <boost/fusion/include/mpl.hpp>
 #include <boost/mpl/begin_end.hpp>
 #include <boost/mpl/and.hpp>
+#include <boost/mp11/integer_sequence.hpp>
 #include <boost/format.hpp>
+#include <algorithm>
 #include <bitset>
 #include <boost/fusion/support/is_sequence.hpp>
 #include <boost/fusion/include/adapt_struct.hpp>
+#include <string>
 #include <type_traits>
+#include <utility>
+#include <cstdint>
 
 namespace bobl{ namespace utility{
 
 template<typename Sequence, typename Options>
 using DictionaryDecoderCompatible = boost::mpl::and_<std::is_default_constructible<Sequence>, boost::fusion::traits::is_sequence<Sequence>, NamedSequence<Sequence, Options>>;
 
+// object decoders of formats having integer keys (bobl::options::IndexKeys) tell those by ObjectDecoder::indexed(key) and ObjectDecoder::id(key)
+template<typename ObjectDecoder, typename Key, typename Enabled = void>
+struct HasIndexedKeys : std::false_type {};
+template<typename ObjectDecoder, typename Key>
+struct HasIndexedKeys<ObjectDecoder, Key, decltype(void(ObjectDecoder::id(std::declval<Key const&>())))> : std::true_type {};
+
 template<typename Sequence, typename ObjectDecoder, typename ...Options>
 class DictionaryDecoder
 {
 	using Key = typename ObjectDecoder::Name;
 	using Skipper = typename ObjectDecoder::Skipper;
+	using IndexedKeys = typename HasIndexedKeys<ObjectDecoder, Key>::type;
 
 	struct Emplacer
 	{
 	public:
-		template<std::size_t N, typename Iterator>
-		auto emplace(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key&& key, Iterator& begin, Iterator end)  -> typename std::enable_if<N != boost::fusion::result_of::size<Sequence>::value>::type;
-		template<std::size_t N, typename Iterator>
-		auto emplace(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key&& key, Iterator& begin, Iterator end)  -> typename std::enable_if<N == boost::fusion::result_of::size<Sequence>::value>::type;
+		template<typename Iterator>
+		void emplace(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key&& key, Iterator& begin, Iterator end);
 		Sequence value() && ;
 	private:
+		using Size = boost::fusion::result_of::size<Sequence>;
+#if __cplusplus >= 201703L
+		template<typename Iterator, std::size_t ...N>
+		bool assign(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key& key, Iterator& begin, Iterator end, std::index_sequence<N...>) { return (assign<N>(decoder, key, begin, end) || ...); }
+		template<std::size_t ...N>
+		void initialize(std::index_sequence<N...>) { (initialize<N>(), ...); }
+#else
+		template<std::size_t N, typename Iterator>
+		auto assign_from(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key& key, Iterator& begin, Iterator end) -> typename std::enable_if<N != Size::value, bool>::type
+		{
+			return assign<N>(decoder, key, begin, end) || assign_from<N + 1>(decoder, key, begin, end);
+		}
+		template<std::size_t N, typename Iterator>
+		auto assign_from(typename ObjectDecoder::template rebase<Iterator, Options...>& /*decoder*/, Key& /*key*/, Iterator& /*begin*/, Iterator /*end*/) -> typename std::enable_if<N == Size::value, bool>::type { return false; }
+		template<std::size_t N>
+		auto initialize_from() -> typename std::enable_if<N != Size::value>::type
+		{
+			initialize<N>();
+			if (!initialized_.all())
+				initialize_from<N + 1>();
+		}
 		template<std::size_t N>
-		auto initialize() -> typename std::enable_if<N != boost::fusion::result_of::size<Sequence>::value>::type;
+		auto initialize_from() -> typename std::enable_if<N == Size::value>::type {}
+#endif
+		template<typename Iterator>
+		bool assign(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key& key, Iterator& begin, Iterator end, std::false_type /*indexed keys*/)
+		{
+#if __cplusplus >= 201703L
+			return assign(decoder, key, begin, end, std::make_index_sequence<Size::value>{});
+#else
+			return assign_from<0>(decoder, key, begin, end);
+#endif
+		}
+		template<typename Iterator>
+		bool assign(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key& key, Iterator& begin, Iterator end, std::true_type /*indexed keys*/)
+		{
+			return ObjectDecoder::indexed(key)
+						? assign_indexed(decoder, key, begin, end, boost::mp11::make_index_sequence<Size::value>{})
+						: assign(decoder, key, begin, end, std::false_type{});
+		}
+		// integer key is looked up in member ids table, ids are positions unless bobl::MemberId is specialized, so it is tried as index first
+		template<typename Iterator, std::size_t ...N>
+		bool assign_indexed(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key& key, Iterator& begin, Iterator end, boost::mp11::index_sequence<N...>)
+		{
+			using Assign = bool (Emplacer::*)(typename ObjectDecoder::template rebase<Iterator, Options...>&, Key&, Iterator&, Iterator);
+			static std::uint64_t const ids[] = { bobl::MemberId<Sequence, typename boost::fusion::result_of::value_at_c<Sequence, N>::type, N, bobl::Options<Options...>>::value..., 0 };
+			static Assign const assigns[] = { &Emplacer::template assign_value<N, Iterator>..., nullptr };
+			auto id = ObjectDecoder::id(key);
+			auto n = id < Size::value && ids[id] == id ? std::size_t(id) : std::size_t(std::find(ids, ids + Size::value, id) - ids);
+			return n != Size::value && (this->*assigns[n])(decoder, key, begin, end);
+		}
+		// decodes member N if key is its name
+		template<std::size_t N, typename Iterator>
+		bool assign(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key& key, Iterator& begin, Iterator end);
+		template<std::size_t N, typename Iterator>
+		bool assign_value(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key& key, Iterator& begin, Iterator end);
 		template<std::size_t N>
-		auto initialize() -> typename std::enable_if<N == boost::fusion::result_of::size<Sequence>::value>::type {}
+		void initialize();
 	private:
 		std::bitset<boost::fusion::result_of::size<Sequence>::value> initialized_;
 		Sequence sequence_/* = {}*/;
@@ -57,6 +123,10 @@ public:
 	Sequence operator()(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Iterator& begin, Iterator end, EndOfObject eoo = EndOfObject{}) const;
 
 	static auto name(Key const& key) -> decltype(ObjectDecoder::name(key)) { return ObjectDecoder::name(key); }
+private:
+	static std::string describe(Key const& key) { return describe(key, IndexedKeys{}); }
+	static std::string describe(Key const& key, std::false_type /*indexed keys*/) { return str(boost::format("%1%") % name(key)); }
+	static std::string describe(Key const& key, std::true_type /*indexed keys*/) { return ObjectDecoder::indexed(key) ? std::to_string(ObjectDecoder::id(key)) : describe(key, std::false_type{}); }
 };
 
 template<typename Sequence, typename ObjectDecoder, typename ...Options>
@@ -70,13 +140,24 @@ class Decoder
 		static char const* name() { return boost::fusion::extension::struct_member_name<T, N>::call(); }
 		bool compare(diversion::string_view n) const { return n.compare(name()) == 0; }
 		bool compare(std::string const& n) const { return n.compare(name()) == 0; }
+		bool compare(std::uint64_t id) const { return id == bobl::MemberId<T, typename boost::fusion::result_of::value_at_c<T, N>::type, N, bobl::Options<Options...>>::value; }
 	};
 public:
 	template<typename Iterator>
 	Sequence operator()(Iterator& begin, Iterator end) const;
 	template<typename Iterator>
-	Sequence operator()(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Iterator& begin, Iterator end) const { return decode(decoder, begin, end); }
+	Sequence operator()(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Iterator& begin, Iterator end) const;
 private:
+	template<std::size_t N, typename Iterator>
+	auto decode(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Iterator& begin, Iterator end) const -> typename boost::fusion::result_of::value_at_c<Sequence, N>::type;
+#if __cplusplus >= 201703L
+	// braced initialization decodes members in order straight into the sequence
+	template<typename Iterator, std::size_t ...N>
+	Sequence decode(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Iterator& begin, Iterator end, std::index_sequence<N...>) const
+	{
+		return Sequence{ decode<N>(decoder, begin, end)... };
+	}
+#else
 	template<typename Iterator, typename ...Args>
 	typename std::enable_if<sizeof...(Args) != boost::fusion::result_of::size<Sequence>::value, Sequence>::type decode(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Iterator& begin, Iterator end, Args&&... args) const;
 
@@ -85,6 +166,7 @@ private:
 	{
 		return Sequence{ std::forward<Args>(args)... };
 	}
+#endif
 };
 
 
@@ -107,7 +189,7 @@ Sequence bobl::utility::DictionaryDecoder<Sequence, ObjectDecoder, Options...>::
 	while (!eoo(begin, end))
 	{
 		auto key = decoder.decode_name(begin, end);
-		emplacer.template emplace<0>(decoder, std::move(key), begin, end);
+		emplacer.emplace(decoder, std::move(key), begin, end);
 	}
 	return std::move(emplacer).value();
 }
@@ -119,14 +201,18 @@ Sequence bobl::utility::DictionaryDecoder<Sequence, ObjectDecoder, Options...>::
 	{
 		if /*constexpr*/ (bobl::utility::options::Contains<bobl::Options<Options...>, bobl::options::ExacMatch>::value)
 			throw bobl::InputToShort{ str(boost::format("not enough data to completely initialize dictionary %1%>") % bobl::utility::type_name<Sequence>()) };
-		initialize<0>();
+#if __cplusplus >= 201703L
+		initialize(std::make_index_sequence<Size::value>{});
+#else
+		initialize_from<0>();
+#endif
 	}
 	return std::move(sequence_);
 }
 
 template<typename Sequence, typename ObjectDecoder, typename ...Options>
 template<std::size_t N>
-auto bobl::utility::DictionaryDecoder<Sequence, ObjectDecoder, Options...>::Emplacer::initialize() -> typename std::enable_if<N != boost::fusion::result_of::size<Sequence>::value>::type
+void bobl::utility::DictionaryDecoder<Sequence, ObjectDecoder, Options...>::Emplacer::initialize()
 {
 	if (!initialized_[N])
 	{
@@ -134,38 +220,47 @@ auto bobl::utility::DictionaryDecoder<Sequence, ObjectDecoder, Options...>::Empl
 		bobl::utility::DefaultValue<Sequence, Type>{}(boost::fusion::at_c<N>(sequence_));
 		initialized_.set(N);
 	}
-	if (!initialized_.all())
-		initialize<N + 1>();
+}
+
+template<typename Sequence, typename ObjectDecoder, typename ...Options>
+template<typename Iterator>
+void bobl::utility::DictionaryDecoder<Sequence, ObjectDecoder, Options...>::Emplacer::emplace(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key&& key, Iterator& begin, Iterator end)
+{
+	if (assign(decoder, key, begin, end, IndexedKeys{}))
+		return;
+
+	if /*constexpr*/ (bobl::utility::options::Contains<bobl::Options<Options...>, bobl::options::ExacMatch>::value)
+		throw bobl::InvalidObject(str(boost::format("unexpected key \"%1%\" found in the dictionary") % describe(key)));
+
+	auto position = bobl::stats::position(begin);
+	decoder.template decode<Skipper>(std::move(key), begin, end);
+	bobl::stats::skipped(position, begin);
 }
 
 template<typename Sequence, typename ObjectDecoder, typename ...Options>
 template<std::size_t N, typename Iterator>
-auto bobl::utility::DictionaryDecoder<Sequence, ObjectDecoder, Options...>::Emplacer::emplace(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key&& key, Iterator& begin, Iterator end)  
-		-> typename std::enable_if<N != boost::fusion::result_of::size<Sequence>::value>::type
+bool bobl::utility::DictionaryDecoder<Sequence, ObjectDecoder, Options...>::Emplacer::assign(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key& key, Iterator& begin, Iterator end)
 {
 	using Type = typename boost::fusion::result_of::value_at_c<Sequence, N>::type;
 	using MemberName = typename bobl::utility::GetNameType<bobl::MemberName<Sequence, Type, N, bobl::Options<Options...>>>::type;
 	static_assert(!std::is_same<MemberName, bobl::utility::ObjectNameIrrelevant>::value, "seems like this member has no name attached");
-	if (MemberName{}.compare(name(key)))
-	{
-		if (initialized_.test(N))
-			throw bobl::InvalidObject(str(boost::format("more then one key \"%1%\" found in the dictionary") % name(key)));
-		boost::fusion::at_c<N>(sequence_) = decoder.template decode<Type>(std::move(key), begin, end);
-		initialized_.set(N);
-	}
-	else
-		emplace<N + 1>(decoder, std::move(key), begin, end);
+	return MemberName{}.compare(name(key)) && assign_value<N>(decoder, key, begin, end);
 }
 
 template<typename Sequence, typename ObjectDecoder, typename ...Options>
 template<std::size_t N, typename Iterator>
-auto bobl::utility::DictionaryDecoder<Sequence, ObjectDecoder, Options...>::Emplacer::emplace(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key&& key, Iterator& begin, Iterator end)  
-			-> typename std::enable_if<N == boost::fusion::result_of::size<Sequence>::value>::type
+bool bobl::utility::DictionaryDecoder<Sequence, ObjectDecoder, Options...>::Emplacer::assign_value(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Key& key, Iterator& begin, Iterator end)
 {
-	if /*constexpr*/ (bobl::utility::options::Contains<bobl::Options<Options...>, bobl::options::ExacMatch>::value)
-		throw bobl::InvalidObject(str(boost::format("unexpected key \"%1%\" found in the dictionary") % name(key)));
-
-	decoder.template decode<Skipper>(std::move(key), begin, end);
+	using Type = typename boost::fusion::result_of::value_at_c<Sequence, N>::type;
+	if (initialized_.test(N))
+		throw bobl::InvalidObject(str(boost::format("more then one key \"%1%\" found in the dictionary") % describe(key)));
+	{
+		bobl::profile::DecodeProbe<Type> probe;
+		boost::fusion::at_c<N>(sequence_) = decoder.template decode<Type>(std::move(key), begin, end);
+	}
+	bobl::stats::elements<Type>();
+	initialized_.set(N);
+	return true;
 }
 
 template<typename Sequence, typename ObjectDecoder, typename ...Options>
@@ -176,17 +271,43 @@ Sequence bobl::utility::Decoder<Sequence, ObjectDecoder, Options...>::operator()
 	return operator()(decoder, begin, end); 
 }
 
+template<typename Sequence, typename ObjectDecoder, typename ...Options>
+template<typename Iterator>
+Sequence bobl::utility::Decoder<Sequence, ObjectDecoder, Options...>::operator()(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Iterator& begin, Iterator end) const
+{
+#if __cplusplus >= 201703L
+	return decode(decoder, begin, end, std::make_index_sequence<boost::fusion::result_of::size<Sequence>::value>{});
+#else
+	return decode(decoder, begin, end);
+#endif
+}
+
+template<typename Sequence, typename ObjectDecoder, typename ...Options>
+template<std::size_t N, typename Iterator>
+auto bobl::utility::Decoder<Sequence, ObjectDecoder, Options...>::decode(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Iterator& begin, Iterator end) const
+	-> typename boost::fusion::result_of::value_at_c<Sequence, N>::type
+{
+	using Type = typename boost::fusion::result_of::value_at_c<Sequence, N>::type;
+	using NameType = typename std::conditional<
+									std::is_same<typename boost::fusion::traits::tag_of<Sequence>::type, boost::fusion::struct_tag>::value
+									, ObjectNameTag<Sequence, N>
+									, ObjectNameIrrelevant>::type;
+
+	bobl::profile::DecodeProbe<Type> probe;
+	auto value = decoder.template decode<Type, N>(begin, end, NameType{});
+	bobl::stats::elements<Type>();
+	return value;
+}
+
+#if __cplusplus < 201703L
+
 template<typename Sequence, typename ObjectDecoder, typename ...Options>
 template<typename Iterator, typename ...Args>
 typename std::enable_if<sizeof...(Args) != boost::fusion::result_of::size<Sequence>::value, Sequence>::type 
 	bobl::utility::Decoder<Sequence, ObjectDecoder, Options...>::decode(typename ObjectDecoder::template rebase<Iterator, Options...>& decoder, Iterator& begin, Iterator end, Args&&... args) const
 {
-	using Type = typename boost::fusion::result_of::value_at_c<Sequence, sizeof...(Args)>::type;
-    using NameType = typename std::conditional<
-                                    std::is_same<typename boost::fusion::traits::tag_of<Sequence>::type, boost::fusion::struct_tag>::value
-                                    , ObjectNameTag<Sequence,sizeof...(Args)>
-                                    , ObjectNameIrrelevant>::type;
-
-	auto value = decoder.template decode<Type, sizeof...(Args)>(begin, end, NameType{});
+	auto value = decode<sizeof...(Args)>(decoder, begin, end);
 	return decode(decoder, begin, std::move(end), std::forward<Args>(args)..., std::move(value));
 }
+
+#endif
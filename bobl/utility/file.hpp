@@ -0,0 +1,62 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include <system_error>
+#include <cstddef>
+#include <cstdint>
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace bobl{ namespace utility {
+
+#if defined(__unix__) || defined(__APPLE__)
+
+// read(2) source for chunked readers (bson::DocumentReader, cbor::SequenceStreamReader)
+class FileSource
+{
+public:
+	explicit FileSource(int fd) : fd_{ fd } {}
+	std::size_t operator()(std::uint8_t* buffer, std::size_t size)
+	{
+		for (;;)
+		{
+			auto res = ::read(fd_, buffer, size);
+			if (res >= 0)
+				return std::size_t(res);
+			if (errno != EINTR)
+				throw std::system_error{ errno, std::generic_category(), "read" };
+		}
+	}
+private:
+	int fd_;
+};
+
+// write(2) sink for buffered writers (bson::DocumentWriter, cbor::SequenceWriter)
+class FileSink
+{
+public:
+	explicit FileSink(int fd) : fd_{ fd } {}
+	void operator()(std::uint8_t const* data, std::size_t size)
+	{
+		while (size != 0)
+		{
+			auto res = ::write(fd_, data, size);
+			if (res < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				throw std::system_error{ errno, std::generic_category(), "write" };
+			}
+			data += res;
+			size -= std::size_t(res);
+		}
+	}
+private:
+	int fd_;
+};
+
+#endif
+
+}/*namespace utility*/} /*namespace bobl*/
@@ -0,0 +1,22 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace utility{ namespace hash {
+
+// 32 bit FNV-1a, hash of concatenated strings can be calculated by chaining fnv1a(s2, fnv1a(s1))
+static constexpr std::uint32_t FnvOffsetBasis = 2166136261u;
+static constexpr std::uint32_t FnvPrime = 16777619u;
+
+inline std::uint32_t fnv1a(char const* begin, char const* end, std::uint32_t hash = FnvOffsetBasis)
+{
+	for (; begin != end; ++begin)
+		hash = (hash ^ std::uint8_t(*begin)) * FnvPrime;
+	return hash;
+}
+
+inline std::uint32_t fnv1a(char c, std::uint32_t hash) { return (hash ^ std::uint8_t(c)) * FnvPrime; }
+
+}/*namespace hash*/}/*namespace utility*/} /*namespace bobl*/
@@ -0,0 +1,158 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/utility/hash.hpp"
+#include "bobl/utility/diversion.hpp"
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef BOBL_INTERN_POOL_CAPACITY
+#define BOBL_INTERN_POOL_CAPACITY (1 << 16)
+#endif
+
+namespace bobl{ namespace utility{
+
+class InternPool;
+
+// Immutable string owned by InternPool. While it is alive every string equal to it interned in the same pool
+// gets the very same handle, so handles are compared by pointer. Decoded from BSON/CBOR text strings through intern_pool().
+class InternedString
+{
+	friend class InternPool;
+	InternedString(std::shared_ptr<std::string const> value, bool pooled) : value_{ std::move(value) }, pooled_{ pooled } {}
+public:
+	// empty string, it is never stored in a pool
+	InternedString() = default;
+
+	std::string const& str() const { return value_ ? *value_ : blank(); }
+	char const* data() const { return str().data(); }
+	std::size_t size() const { return str().size(); }
+	bool empty() const { return !value_; }
+	operator diversion::string_view() const { return diversion::string_view{ str() }; }
+
+	// strings the pool was too full to keep aren't unique, those are compared by value
+	friend bool operator==(InternedString const& x, InternedString const& y)
+	{
+		return x.value_ == y.value_ || (!(x.pooled_ && y.pooled_) && x.str() == y.str());
+	}
+	friend bool operator!=(InternedString const& x, InternedString const& y) { return !(x == y); }
+	friend bool operator<(InternedString const& x, InternedString const& y) { return x.value_ != y.value_ && x.str() < y.str(); }
+	friend std::ostream& operator<<(std::ostream& out, InternedString const& value) { return out << value.str(); }
+private:
+	static std::string const& blank()
+	{
+		static std::string const res;
+		return res;
+	}
+private:
+	std::shared_ptr<std::string const> value_;
+	bool pooled_ = true;
+};
+
+// Thread safe set of interned strings split into independently locked shards. Interning string already in the pool
+// doesn't allocate. Once a shard is full, strings no handle refers to any more are evicted from it; if there are none,
+// new strings are handed out without being pooled until some space is freed.
+class InternPool
+{
+	using Strings = std::unordered_multimap<std::uint32_t, std::shared_ptr<std::string const>>;
+	struct Shard
+	{
+		std::mutex mutex;
+		Strings strings;
+		// misses left before full shard is swept again
+		std::size_t backoff = 0;
+	};
+public:
+	explicit InternPool(std::size_t capacity = BOBL_INTERN_POOL_CAPACITY, std::size_t shards = 16)
+		: shards_( (std::max)(shards, std::size_t{ 1 }) ), capacity_{ (std::max)(capacity / shards_.size(), std::size_t{ 1 }) } {}
+	InternPool(InternPool const&) = delete;
+	InternPool& operator=(InternPool const&) = delete;
+
+	InternedString intern(diversion::string_view value)
+	{
+		if (value.empty())
+			return {};
+		auto hash = bobl::utility::hash::fnv1a(value.data(), value.data() + value.size());
+		auto& shard = shards_[hash % shards_.size()];
+		std::lock_guard<std::mutex> lock{ shard.mutex };
+		auto range = shard.strings.equal_range(hash);
+		for (auto i = range.first; i != range.second; ++i)
+		{
+			if (diversion::string_view{ *i->second } == value)
+				return { i->second, true };
+		}
+		auto res = std::make_shared<std::string const>(value.data(), value.size());
+		if (shard.strings.size() >= capacity_ && !evict(shard))
+			return { std::move(res), false };
+		shard.strings.emplace(hash, res);
+		return { std::move(res), true };
+	}
+
+	std::size_t size() const
+	{
+		auto res = std::size_t{ 0 };
+		for (auto& shard : shards_)
+		{
+			std::lock_guard<std::mutex> lock{ shard.mutex };
+			res += shard.strings.size();
+		}
+		return res;
+	}
+
+	std::size_t capacity() const { return capacity_ * shards_.size(); }
+
+	// drops strings no handle refers to
+	void shrink()
+	{
+		for (auto& shard : shards_)
+		{
+			std::lock_guard<std::mutex> lock{ shard.mutex };
+			sweep(shard);
+		}
+	}
+private:
+	// new handles are only made under the shard lock, so string referenced by the pool alone stays such while it is held
+	static std::size_t sweep(Shard& shard)
+	{
+		auto size = shard.strings.size();
+		for (auto i = shard.strings.begin(); i != shard.strings.end();)
+			i = i->second.use_count() == 1 ? shard.strings.erase(i) : std::next(i);
+		return size - shard.strings.size();
+	}
+
+	// shard full of strings still in use isn't swept on every miss
+	bool evict(Shard& shard)
+	{
+		if (shard.backoff != 0)
+		{
+			--shard.backoff;
+			return false;
+		}
+		if (sweep(shard) != 0)
+			return true;
+		shard.backoff = capacity_ / 8;
+		return false;
+	}
+private:
+	mutable std::vector<Shard> shards_;
+	std::size_t capacity_;
+};
+
+// process wide pool InternedString is decoded into
+inline InternPool& intern_pool()
+{
+	static InternPool res;
+	return res;
+}
+
+inline InternedString intern(diversion::string_view value) { return intern_pool().intern(value); }
+
+}/*namespace utility*/} /*namespace bobl*/
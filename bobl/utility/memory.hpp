@@ -0,0 +1,38 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace bobl{ namespace utility {
+
+// hints cpu to bring cache line at address in, does nothing where not supported
+inline void prefetch(void const* address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch(address, 0 /*read*/, 3 /*keep in all cache levels*/);
+#else
+	(void)address;
+#endif
+}
+
+// advises kernel that mapped range is going to be read sequentially, the advice is only a hint so failures are ignored
+inline void advise_sequential(void const* address, std::size_t size)
+{
+#if (defined(__unix__) || defined(__APPLE__)) && defined(POSIX_MADV_SEQUENTIAL)
+	static auto const page = std::uintptr_t(sysconf(_SC_PAGESIZE));
+	if (size == 0 || page == 0)
+		return;
+	auto begin = reinterpret_cast<std::uintptr_t>(address) & ~(page - 1);
+	posix_madvise(reinterpret_cast<void*>(begin), std::size_t(reinterpret_cast<std::uintptr_t>(address) - begin) + size, POSIX_MADV_SEQUENTIAL);
+#else
+	(void)address;
+	(void)size;
+#endif
+}
+
+}/*namespace utility*/} /*namespace bobl*/
@@ -16,6 +16,7 @@
 #include <boost/mpl/range_c.hpp>
 #include <utility>
 #include <type_traits>
+#include <cstdint>
 
 namespace bobl{ namespace utility{
 
@@ -66,6 +67,10 @@ public:
 template<typename Type, typename MemberType, std::size_t Position, typename Options>
 class MemberName : public utility::DefaultMemberName <Type, MemberType, Position, Options>::type {};
 
+// integer key of member encoded with bobl::options::IndexKeys, can be specialized the same way as MemberName
+template<typename Type, typename MemberType, std::size_t Position, typename Options>
+class MemberId : public std::integral_constant<std::uint64_t, Position> {};
+
 
 namespace utility {
 
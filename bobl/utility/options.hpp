@@ -8,6 +8,7 @@
 #include <boost/mpl/not.hpp>
 #include <boost/mpl/bool_fwd.hpp>
 #include <type_traits>
+#include <cstddef>
 #include <cstdint>
 
 namespace bobl{ namespace utility {
@@ -45,6 +46,31 @@ struct Contains<T, T> : std::true_type {};
 template<typename ...Params, typename T>
 struct Contains<Options<Params...>, T> : details::ContainsImp<std::tuple<Params...>, T>::type {};
 
+namespace details
+{
+
+template<typename ...Params>
+struct ParallelArraysThreshold : std::integral_constant<std::size_t, 0> {};
+
+template<std::size_t Threshold, typename ...Params>
+struct ParallelArraysThreshold<bobl::options::ParallelArrays<Threshold>, Params...> : std::integral_constant<std::size_t, Threshold> {};
+
+template<typename ...Nested, typename ...Params>
+struct ParallelArraysThreshold<Options<Nested...>, Params...>
+	: std::conditional<ParallelArraysThreshold<Nested...>::value != 0, ParallelArraysThreshold<Nested...>, ParallelArraysThreshold<Params...>>::type {};
+
+template<typename T, typename ...Params>
+struct ParallelArraysThreshold<T, Params...> : ParallelArraysThreshold<Params...> {};
+
+} // namespace details
+
+// threshold set by bobl::options::ParallelArrays, 0 if arrays are decoded and encoded sequentially
+template<typename Options>
+struct ParallelArrays : std::integral_constant<std::size_t, 0> {};
+
+template<typename ...Params>
+struct ParallelArrays<Options<Params...>> : details::ParallelArraysThreshold<Params...> {};
+
 }// namespace options
 
 template <typename T, typename Options>
@@ -0,0 +1,237 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <functional>
+#include <exception>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace utility{
+
+inline std::size_t concurrency(std::size_t threads = 0)
+{
+	return threads != 0 ? threads : (std::max)(std::size_t{ 1 }, std::size_t(std::thread::hardware_concurrency()));
+}
+
+// Fixed set of worker threads running parallel_for jobs, calling thread takes part in every job as worker 0.
+// Batches are dealt to workers in contiguous ranges up front; worker that is done with its range
+// steals the back half of some other worker's remaining range, so uneven batches still keep all workers busy.
+// Jobs are run one at a time, parallel_for called from inside a job (of any pool) or while the pool is busy runs the job inline.
+class ThreadPool
+{
+	struct Range
+	{
+		std::mutex guard;
+		std::size_t begin = 0;
+		std::size_t end = 0;
+		char padding[64]; // keeps ranges of different workers off the same cache line
+	};
+	using Job = std::function<void(std::size_t worker)>;
+
+	// true on the threads running a job
+	static bool& nested()
+	{
+		static thread_local bool res = false;
+		return res;
+	}
+
+	struct NestedGuard
+	{
+		NestedGuard() { nested() = true; }
+		~NestedGuard() { nested() = false; }
+	};
+public:
+	explicit ThreadPool(std::size_t threads = 0) : ranges_( concurrency(threads) )
+	{
+		workers_.reserve(ranges_.size() - 1);
+		try
+		{
+			for (std::size_t i = 1; i < ranges_.size(); ++i)
+				workers_.emplace_back([this, i]() { run(i); });
+		}
+		catch (...)
+		{
+			stop();
+			throw;
+		}
+	}
+	~ThreadPool() { stop(); }
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator= (ThreadPool const&) = delete;
+
+	// number of workers including the calling thread
+	std::size_t size() const { return workers_.size() + 1; }
+
+	// splits [0, n) into batches of batch items and runs f(worker, batch index, first, last) for every batch,
+	// if some batches failed exception thrown by the lowest one is rethrown, so behavior matches sequential loop
+	template<typename F>
+	void parallel_for(std::size_t n, std::size_t batch, F&& f)
+	{
+		if (n == 0)
+			return;
+		batch = (std::max)(batch, std::size_t{ 1 });
+		auto const batches = (n + batch - 1) / batch;
+		// pool is busy with job of another thread, waiting for it would be slower than running batches right here
+		std::unique_lock<std::mutex> lock{ job_guard_, std::defer_lock };
+		if (nested() || !lock.try_lock())
+		{
+			for (std::size_t i = 0; i != batches; ++i)
+				f(0, i, i * batch, (std::min)(n, (i + 1) * batch));
+			return;
+		}
+		auto const workers = (std::min)(size(), batches);
+		for (std::size_t i = 0; i != size(); ++i)
+		{
+			std::lock_guard<std::mutex> range_lock{ ranges_[i].guard };
+			ranges_[i].begin = i < workers ? batches * i / workers : 0;
+			ranges_[i].end = i < workers ? batches * (i + 1) / workers : 0;
+		}
+		std::atomic<std::size_t> failed{ (std::numeric_limits<std::size_t>::max)() };
+		auto error = std::exception_ptr{};
+		std::mutex error_guard;
+		auto job = Job{ [&](std::size_t worker)
+		{
+			NestedGuard const nested_guard;
+			for (auto i = std::size_t{ 0 }; take(worker, i);)
+			{
+				if (i > failed)
+					continue;
+				try
+				{
+					f(worker, i, i * batch, (std::min)(n, (i + 1) * batch));
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> error_lock{ error_guard };
+					if (i < failed)
+					{
+						failed = i;
+						error = std::current_exception();
+					}
+				}
+			}
+		} };
+		{
+			std::lock_guard<std::mutex> state_lock{ guard_ };
+			job_ = &job;
+			pending_ = workers_.size();
+			++generation_;
+		}
+		wake_.notify_all();
+		job(0);
+		{
+			std::unique_lock<std::mutex> state_lock{ guard_ };
+			done_.wait(state_lock, [this]() { return pending_ == 0; });
+			job_ = nullptr;
+		}
+		if (error)
+			std::rethrow_exception(error);
+	}
+private:
+	bool take(std::size_t worker, std::size_t& batch)
+	{
+		{
+			auto& own = ranges_[worker];
+			std::lock_guard<std::mutex> lock{ own.guard };
+			if (own.begin != own.end)
+			{
+				batch = own.begin++;
+				return true;
+			}
+		}
+		for (std::size_t i = 1; i < ranges_.size(); ++i)
+		{
+			auto begin = std::size_t{ 0 };
+			auto end = std::size_t{ 0 };
+			{
+				auto& victim = ranges_[(worker + i) % ranges_.size()];
+				std::lock_guard<std::mutex> lock{ victim.guard };
+				if (victim.begin == victim.end)
+					continue;
+				begin = victim.begin + (victim.end - victim.begin) / 2;
+				end = victim.end;
+				victim.end = begin;
+			}
+			auto& own = ranges_[worker];
+			std::lock_guard<std::mutex> lock{ own.guard };
+			own.begin = begin + 1;
+			own.end = end;
+			batch = begin;
+			return true;
+		}
+		return false;
+	}
+
+	void run(std::size_t worker)
+	{
+		for (auto generation = std::size_t{ 0 };;)
+		{
+			Job const* job = nullptr;
+			{
+				std::unique_lock<std::mutex> lock{ guard_ };
+				wake_.wait(lock, [this, generation]() { return stop_ || generation_ != generation; });
+				if (stop_)
+					return;
+				generation = generation_;
+				job = job_;
+			}
+			(*job)(worker);
+			std::lock_guard<std::mutex> lock{ guard_ };
+			if (--pending_ == 0)
+				done_.notify_one();
+		}
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ guard_ };
+			stop_ = true;
+		}
+		wake_.notify_all();
+		for (auto& worker : workers_)
+			worker.join();
+		workers_.clear();
+	}
+private:
+	std::vector<Range> ranges_;
+	std::vector<std::thread> workers_;
+	std::mutex job_guard_;
+	std::mutex guard_;
+	std::condition_variable wake_;
+	std::condition_variable done_;
+	Job const* job_ = nullptr;
+	std::size_t pending_ = 0;
+	std::size_t generation_ = 0;
+	bool stop_ = false;
+};
+
+// process wide pool used where no pool can be passed in explicitly (e.g. bobl::options::ParallelArrays)
+inline ThreadPool& shared_pool()
+{
+	static ThreadPool res;
+	return res;
+}
+
+// Encodes n items in consecutive chunks on pool workers, f(first, last, buffer) appends encoded items [first, last) to buffer.
+// Chunks are returned in order, so writing them one after another gives the same bytes as encoding all the items in one go.
+template<typename F>
+std::vector<std::vector<std::uint8_t>> encode_chunks(ThreadPool& pool, std::size_t n, F&& f)
+{
+	auto const batch = (std::max)(std::size_t{ 1 }, n / (pool.size() * 8));
+	auto res = std::vector<std::vector<std::uint8_t>>((n + batch - 1) / batch);
+	pool.parallel_for(n, batch, [&res, &f](std::size_t /*worker*/, std::size_t chunk, std::size_t first, std::size_t last)
+	{
+		f(first, last, res[chunk]);
+	});
+	return res;
+}
+
+}/*namespace utility*/} /*namespace bobl*/
@@ -0,0 +1,354 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/utility/type_name.hpp"
+#include <boost/format.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef BOBL_ENABLE_PROFILE
+// msvc doesn't define __x86_64__/__i386__, it has its own names for them
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define BOBL_PROFILE_RDTSC_
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BOBL_PROFILE_RDTSC_
+#elif defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#define BOBL_PROFILE_CLOCK_GETTIME_
+#endif
+// USDT probes bobl:decode and bobl:encode (type name, duration) fire on every sampled call, e.g.
+//	bpftrace -e 'usdt:./app:bobl:decode { @[str(arg0)] = hist(arg1); }'
+#if !defined(BOBL_PROFILE_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define BOBL_PROFILE_USDT_(operation, name, duration) do { DTRACE_PROBE2(bobl, operation, name, duration); } while (false)
+#endif
+#endif
+#endif
+#ifndef BOBL_PROFILE_USDT_
+#define BOBL_PROFILE_USDT_(operation, name, duration) do {} while (false)
+#endif
+
+#ifndef BOBL_PROFILE_SAMPLE_RATE
+#define BOBL_PROFILE_SAMPLE_RATE 64
+#endif
+
+// Opt-in sampling profiler, compiled in only when BOBL_ENABLE_PROFILE is defined. Every sample_rate()-th decode or encode
+// of structure member, and of top level value, is timed and recorded into lock-free histogram of its type:
+//	bobl::profile::report_text(std::cout, bobl::profile::snapshot());
+// Durations are in ticks of unit(): TSC cycles on x86, nanoseconds elsewhere. Times are inclusive, nested members are part of their parent's.
+namespace bobl{ namespace profile {
+
+#ifdef BOBL_ENABLE_PROFILE
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+enum class Operation { Decode, Encode };
+
+inline char const* to_string(Operation operation) { return operation == Operation::Decode ? "decode" : "encode"; }
+
+inline char const* unit()
+{
+#ifdef BOBL_PROFILE_RDTSC_
+	return "cycles";
+#else
+	return "ns";
+#endif
+}
+
+// log-linear buckets, every power of two is split into SubBuckets, so bucket bounds are within 25% of recorded values
+class Histogram
+{
+public:
+	static constexpr std::size_t SubBits = 2;
+	static constexpr std::size_t SubBuckets = std::size_t{ 1 } << SubBits;
+	static constexpr std::size_t Size = (64 - SubBits + 1) * SubBuckets;
+
+	Histogram() { reset(); }
+
+	void reset()
+	{
+		for (auto& bucket : buckets_)
+			bucket.store(0, std::memory_order_relaxed);
+		count_.store(0, std::memory_order_relaxed);
+		sum_.store(0, std::memory_order_relaxed);
+		max_.store(0, std::memory_order_relaxed);
+	}
+
+	void record(std::uint64_t value)
+	{
+		buckets_[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+		count_.fetch_add(1, std::memory_order_relaxed);
+		sum_.fetch_add(value, std::memory_order_relaxed);
+		for (auto max = max_.load(std::memory_order_relaxed); value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed);)
+			;
+	}
+
+	std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+	std::uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+	std::uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+	std::uint64_t bucket_count(std::size_t i) const { return buckets_[i].load(std::memory_order_relaxed); }
+
+	static std::size_t bucket(std::uint64_t value)
+	{
+		if (value < SubBuckets)
+			return std::size_t(value);
+		auto bits = std::size_t(0);
+		for (auto v = value; v >= SubBuckets * 2; v >>= 1)
+			++bits;
+		return (bits + 1) * SubBuckets + std::size_t((value >> bits) & (SubBuckets - 1));
+	}
+
+	// the highest value falling into bucket i
+	static std::uint64_t upper_bound(std::size_t i)
+	{
+		if (i < SubBuckets)
+			return i;
+		auto bits = i / SubBuckets - 1;
+		// wraps around to the maximal value for the last bucket
+		return (std::uint64_t(SubBuckets + i % SubBuckets) << bits) + (std::uint64_t{ 1 } << bits) - 1;
+	}
+private:
+	std::atomic<std::uint64_t> buckets_[Size];
+	std::atomic<std::uint64_t> count_;
+	std::atomic<std::uint64_t> sum_;
+	std::atomic<std::uint64_t> max_;
+};
+
+struct Summary
+{
+	std::string type;
+	Operation operation;
+	std::uint64_t count;
+	double mean;
+	std::uint64_t p50;
+	std::uint64_t p90;
+	std::uint64_t p99;
+	std::uint64_t max;
+};
+
+namespace details {
+
+class Registry
+{
+public:
+	// histograms are never removed, so returned reference stays valid and is used without locking
+	Histogram& add(Operation operation, std::string type)
+	{
+		std::lock_guard<std::mutex> lock{ mutex_ };
+		auto& res = histograms_[std::make_pair(std::move(type), operation)];
+		if (!res)
+			res.reset(new Histogram{});
+		return *res;
+	}
+
+	std::vector<Summary> summaries() const
+	{
+		auto res = std::vector<Summary>{};
+		std::lock_guard<std::mutex> lock{ mutex_ };
+		for (auto const& histogram : histograms_)
+		{
+			if (auto count = histogram.second->count())
+				res.push_back(summary(histogram.first.first, histogram.first.second, *histogram.second, count));
+		}
+		return res;
+	}
+
+	// samples recorded concurrently may survive it
+	void reset()
+	{
+		std::lock_guard<std::mutex> lock{ mutex_ };
+		for (auto& histogram : histograms_)
+			histogram.second->reset();
+	}
+private:
+	static Summary summary(std::string const& type, Operation operation, Histogram const& histogram, std::uint64_t count)
+	{
+		auto res = Summary{ type, operation, count, double(histogram.sum()) / count, 0, 0, 0, histogram.max() };
+		auto percentile = [&histogram, count](double p)
+		{
+			auto rank = std::uint64_t(p * count);
+			auto seen = std::uint64_t{ 0 };
+			for (std::size_t i = 0; i != Histogram::Size; ++i)
+			{
+				if ((seen += histogram.bucket_count(i)) > rank)
+					return (std::min)(Histogram::upper_bound(i), histogram.max());
+			}
+			return histogram.max();
+		};
+		res.p50 = percentile(0.5);
+		res.p90 = percentile(0.9);
+		res.p99 = percentile(0.99);
+		return res;
+	}
+private:
+	mutable std::mutex mutex_;
+	std::map<std::pair<std::string, Operation>, std::unique_ptr<Histogram>> histograms_;
+};
+
+inline Registry& registry()
+{
+	static Registry registry;
+	return registry;
+}
+
+} /*namespace details*/
+
+#ifdef BOBL_ENABLE_PROFILE
+
+namespace details {
+
+inline std::atomic<std::uint32_t>& sample_rate()
+{
+	static std::atomic<std::uint32_t> rate{ BOBL_PROFILE_SAMPLE_RATE };
+	return rate;
+}
+
+inline bool sampled()
+{
+	static thread_local std::uint32_t countdown = 0;
+	if (countdown != 0)
+	{
+		--countdown;
+		return false;
+	}
+	countdown = sample_rate().load(std::memory_order_relaxed) - 1;
+	return true;
+}
+
+inline std::uint64_t now()
+{
+#if defined(BOBL_PROFILE_RDTSC_)
+	return __rdtsc();
+#elif defined(BOBL_PROFILE_CLOCK_GETTIME_)
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return std::uint64_t(ts.tv_sec) * 1000000000 + std::uint64_t(ts.tv_nsec);
+#else
+	return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+template<typename T, Operation O>
+struct Probed
+{
+	static Histogram& histogram()
+	{
+		static auto& res = registry().add(O, bobl::utility::type_name<T>());
+		return res;
+	}
+
+	static char const* name()
+	{
+		static auto const res = bobl::utility::type_name<T>();
+		return res.c_str();
+	}
+};
+
+} /*namespace details*/
+
+// every n-th probe is recorded, per thread
+inline void sample_rate(std::uint32_t n) { details::sample_rate().store((std::max)(n, std::uint32_t{ 1 }), std::memory_order_relaxed); }
+
+// times its scope if sampled
+template<typename T, Operation O>
+class Probe
+{
+public:
+	Probe() : start_{ details::sampled() ? details::now() : 0 } {}
+	Probe(Probe const&) = delete;
+	Probe& operator=(Probe const&) = delete;
+	~Probe()
+	{
+		if (start_ != 0)
+		{
+			auto duration = details::now() - start_;
+			using Probed = details::Probed<T, O>;
+			Probed::histogram().record(duration);
+			if (O == Operation::Decode)
+				BOBL_PROFILE_USDT_(decode, Probed::name(), duration);
+			else
+				BOBL_PROFILE_USDT_(encode, Probed::name(), duration);
+		}
+	}
+private:
+	std::uint64_t start_;
+};
+
+#else
+
+inline void sample_rate(std::uint32_t /*n*/) {}
+
+template<typename T, Operation O>
+class Probe
+{
+public:
+	Probe() {}
+	Probe(Probe const&) = delete;
+	Probe& operator=(Probe const&) = delete;
+};
+
+#endif
+
+template<typename T>
+using DecodeProbe = Probe<T, Operation::Decode>;
+template<typename T>
+using EncodeProbe = Probe<T, Operation::Encode>;
+
+// f() timed as operation on T
+template<typename T, Operation O, typename F>
+auto measure(F&& f) -> decltype(f())
+{
+	Probe<T, O> probe;
+	return f();
+}
+
+// summaries of every type and operation recorded so far, by type name
+inline std::vector<Summary> snapshot() { return details::registry().summaries(); }
+inline void reset() { details::registry().reset(); }
+
+inline void report_text(std::ostream& out, std::vector<Summary> const& summaries)
+{
+	out << boost::format("%-60s %-6s %10s %12s %10s %10s %10s %10s\n") % "type" % "" % "samples" % (std::string{ "mean " } + unit()) % "p50" % "p90" % "p99" % "max";
+	for (auto const& summary : summaries)
+		out << boost::format("%-60s %-6s %10d %12.1f %10d %10d %10d %10d\n") % summary.type % to_string(summary.operation) % summary.count % summary.mean % summary.p50 % summary.p90 % summary.p99 % summary.max;
+}
+
+inline void report_json(std::ostream& out, std::vector<Summary> const& summaries)
+{
+	auto quoted = [](std::string const& value)
+	{
+		auto res = std::string{ "\"" };
+		for (auto c : value)
+		{
+			if (c == '"' || c == '\\')
+				res += '\\';
+			res += c;
+		}
+		return res + '"';
+	};
+	out << "{\"unit\": \"" << unit() << "\", \"types\": [";
+	for (auto i = summaries.begin(); i != summaries.end(); ++i)
+	{
+		out << (i == summaries.begin() ? "\n" : ",\n")
+			<< boost::format("\t{\"type\": %1%, \"operation\": \"%2%\", \"samples\": %3%, \"mean\": %4$.1f, \"p50\": %5%, \"p90\": %6%, \"p99\": %7%, \"max\": %8%}")
+				% quoted(i->type) % to_string(i->operation) % i->count % i->mean % i->p50 % i->p90 % i->p99 % i->max;
+	}
+	out << "\n]}\n";
+}
+
+}/*namespace profile*/} /*namespace bobl*/
@@ -0,0 +1,208 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/utility/names.hpp"
+#include "bobl/utility/options.hpp"
+#include "bobl/utility/utils.hpp"
+#include "bobl/utility/diversion.hpp"
+#include "bobl/names.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/fusion/include/value_at.hpp>
+#include <boost/fusion/support/is_sequence.hpp>
+#include <boost/format.hpp>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{
+
+// compile time member path: Path<3, 1> is member 1 of member 3 of the projected type
+template<std::size_t ...Positions>
+struct Path {};
+
+namespace utility{ namespace projection {
+
+// member names on the way to the leaf, "header.seq" -> {"header", "seq"}, array elements are addressed by their index "values.2"
+using Segments = std::vector<std::string>;
+
+inline Segments split(diversion::string_view path)
+{
+	auto res = Segments{};
+	for (auto pos = diversion::string_view::size_type{ 0 };;)
+	{
+		auto next = path.find('.', pos);
+		res.emplace_back(path.substr(pos, next == diversion::string_view::npos ? next : next - pos));
+		if (next == diversion::string_view::npos)
+			break;
+		pos = next + 1;
+	}
+	return res;
+}
+
+inline std::string join(Segments const& segments)
+{
+	auto res = std::string{};
+	for (auto const& segment : segments)
+		res.append(res.empty() ? "" : ".").append(segment);
+	return res;
+}
+
+// array elements are addressed by their decimal index
+inline bool is_index(std::string const& segment, std::uint64_t index)
+{
+	if (segment.empty() || segment.size() > std::numeric_limits<std::uint64_t>::digits10 || (segment.size() > 1 && segment[0] == '0'))
+		return false;
+	auto value = std::uint64_t{ 0 };
+	for (auto c : segment)
+	{
+		if (c < '0' || c > '9')
+			return false;
+		value = value * 10 + std::uint64_t(c - '0');
+	}
+	return value == index;
+}
+
+template<typename T, typename Path, typename Options>
+struct PathTraits;
+
+template<typename T, std::size_t Position, typename Options>
+struct PathTraits<T, bobl::Path<Position>, Options>
+{
+	static_assert(boost::fusion::traits::is_sequence<T>::value, "bobl::Path can refer only to members of boost::fusion sequences");
+	using type = typename boost::fusion::result_of::value_at_c<T, Position>::type;
+	using Name = typename bobl::utility::GetNameType<bobl::MemberName<T, type, Position, Options>>::type;
+	static_assert(!std::is_same<Name, bobl::utility::ObjectNameIrrelevant>::value, "seems like this member has no name attached");
+
+	static void segments(Segments& res) { res.emplace_back(Name::name()); }
+};
+
+template<typename T, std::size_t Position, std::size_t Next, std::size_t ...Positions, typename Options>
+struct PathTraits<T, bobl::Path<Position, Next, Positions...>, Options>
+{
+	using Member = PathTraits<T, bobl::Path<Position>, Options>;
+	using type = typename PathTraits<typename Member::type, bobl::Path<Next, Positions...>, Options>::type;
+
+	static void segments(Segments& res)
+	{
+		Member::segments(res);
+		PathTraits<typename Member::type, bobl::Path<Next, Positions...>, Options>::segments(res);
+	}
+};
+
+// splits projection parameters into the leaves and options: project<int, std::string, bobl::Options<...>>
+template<typename Leaves, typename ...Args>
+struct Parameters;
+
+template<typename ...Leaves>
+struct Parameters<std::tuple<Leaves...>>
+{
+	using type = std::tuple<Leaves...>;
+	using Options = bobl::options::None;
+};
+
+template<typename ...Leaves, typename Last>
+struct Parameters<std::tuple<Leaves...>, Last>
+{
+	using type = typename std::conditional<bobl::utility::IsOptions<Last>::value, std::tuple<Leaves...>, std::tuple<Leaves..., Last>>::type;
+	using Options = typename std::conditional<bobl::utility::IsOptions<Last>::value, Last, bobl::options::None>::type;
+};
+
+template<typename ...Leaves, typename T, typename Next, typename ...Args>
+struct Parameters<std::tuple<Leaves...>, T, Next, Args...> : Parameters<std::tuple<Leaves..., T>, Next, Args...> {};
+
+template<typename T, typename Paths, typename Options>
+struct PathsTraits;
+
+template<typename T, typename ...Paths, typename Options>
+struct PathsTraits<T, std::tuple<Paths...>, Options>
+{
+	using type = std::tuple<typename PathTraits<T, Paths, Options>::type...>;
+
+	static std::vector<Segments> const& paths()
+	{
+		static auto const res = std::vector<Segments>{ segments<Paths>()... };
+		return res;
+	}
+private:
+	template<typename Path>
+	static Segments segments()
+	{
+		auto res = Segments{};
+		PathTraits<T, Path, Options>::segments(res);
+		return res;
+	}
+};
+
+// Collects projected leaves. Format specific walker matches document against the paths and
+// calls decode(n, decoder) for every found leaf, decoder.decode<T>() decodes the leaf value.
+template<typename Result>
+class Projection;
+
+template<typename ...Leaves>
+class Projection<std::tuple<Leaves...>>
+{
+	static constexpr std::size_t Size = sizeof...(Leaves);
+	using Values = std::tuple<diversion::optional<Leaves>...>;
+public:
+	using type = std::tuple<Leaves...>;
+
+	explicit Projection(std::vector<Segments> const& paths) : paths_( paths )
+	{
+		if (paths_.size() != Size)
+			throw bobl::InvalidObject{ str(boost::format("%1% paths provided to project %2% values") % paths_.size() % sizeof...(Leaves)) };
+	}
+
+	std::size_t size() const { return Size; }
+	Segments const& path(std::size_t n) const { return paths_[n]; }
+
+	template<typename Decoder>
+	void decode(std::size_t n, Decoder const& decoder) { decode<0>(n, decoder); }
+
+	type value() && { return values<0>(); }
+private:
+	template<std::size_t N, typename Decoder>
+	auto decode(std::size_t n, Decoder const& decoder) -> typename std::enable_if<N != Size>::type
+	{
+		using Type = typename std::tuple_element<N, type>::type;
+		if (n == N)
+			std::get<N>(values_) = decoder.template decode<Type>();
+		else
+			decode<N + 1>(n, decoder);
+	}
+
+	template<std::size_t N, typename Decoder>
+	auto decode(std::size_t /*n*/, Decoder const& /*decoder*/) -> typename std::enable_if<N == Size>::type {}
+
+	template<std::size_t N>
+	auto leaf(diversion::optional<typename std::tuple_element<N, type>::type>&& value) const -> typename std::tuple_element<N, type>::type
+	{
+		using Type = typename std::tuple_element<N, type>::type;
+		if (!value)
+		{
+			if (!bobl::utility::IsOptional<Type>::value)
+				throw bobl::InvalidObject{ str(boost::format("\"%1%\" not found") % join(paths_[N])) };
+			return Type{};
+		}
+		return std::move(*value);
+	}
+
+	template<std::size_t N, typename ...Args>
+	auto values(Args&&... args) -> typename std::enable_if<N != Size, type>::type
+	{
+		return values<N + 1>(std::forward<Args>(args)..., leaf<N>(std::move(std::get<N>(values_))));
+	}
+
+	template<std::size_t N, typename ...Args>
+	auto values(Args&&... args) -> typename std::enable_if<N == Size, type>::type { return type{ std::forward<Args>(args)... }; }
+private:
+	std::vector<Segments> const& paths_;
+	Values values_;
+};
+
+} /*namespace projection*/ }/*namespace utility*/} /*namespace bobl*/
@@ -0,0 +1,251 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/utility/type_name.hpp"
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// Opt-in decoder instrumentation, compiled in only when BOBL_ENABLE_STATS is defined, otherwise every hook is an empty inline function.
+// Counters are kept per thread:
+//	auto before = bobl::stats::snapshot();
+//	auto value = bobl::cbor::decode<T>(begin, end);
+//	auto stats = bobl::stats::snapshot() - before;
+// Heap allocations are counted by Allocator<T> and, when BOBL_STATS_COUNT_ALLOCATIONS() is placed in one translation unit,
+// by replaced global operator new, which is what standard containers filled by decoders use.
+namespace bobl{ namespace stats {
+
+#ifdef BOBL_ENABLE_STATS
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+struct Snapshot
+{
+	std::uint64_t allocations = 0;
+	std::uint64_t allocated_bytes = 0;
+	// exceptions thrown and caught internally, i.e. while probing optional or variant alternatives
+	std::uint64_t exceptions = 0;
+	// bytes consumed by top level decode calls and bytes of unknown members skipped on the way
+	std::uint64_t bytes_scanned = 0;
+	std::uint64_t bytes_skipped = 0;
+	// structure members and array elements decoded, in total and per type
+	std::uint64_t elements = 0;
+	std::map<std::string, std::uint64_t> types;
+};
+
+inline Snapshot operator-(Snapshot x, Snapshot const& y)
+{
+	x.allocations -= y.allocations;
+	x.allocated_bytes -= y.allocated_bytes;
+	x.exceptions -= y.exceptions;
+	x.bytes_scanned -= y.bytes_scanned;
+	x.bytes_skipped -= y.bytes_skipped;
+	x.elements -= y.elements;
+	for (auto const& type : y.types)
+	{
+		auto i = x.types.find(type.first);
+		if (i != x.types.end() && (i->second -= type.second) == 0)
+			x.types.erase(i);
+	}
+	return x;
+}
+
+#ifdef BOBL_ENABLE_STATS
+
+namespace details {
+
+// trivial, so it is safe to use from operator new at any point of thread life time
+struct Totals
+{
+	std::uint64_t allocations;
+	std::uint64_t allocated_bytes;
+	std::uint64_t exceptions;
+	std::uint64_t bytes_scanned;
+	std::uint64_t bytes_skipped;
+	std::uint64_t elements;
+};
+
+inline Totals& totals()
+{
+	static thread_local Totals totals;
+	return totals;
+}
+
+inline std::vector<std::uint64_t>& types()
+{
+	static thread_local std::vector<std::uint64_t> types;
+	return types;
+}
+
+// names of types indexed by type id shared by all threads
+class Registry
+{
+public:
+	std::size_t add(std::string name)
+	{
+		std::lock_guard<std::mutex> lock{ mutex_ };
+		names_.push_back(std::move(name));
+		return names_.size() - 1;
+	}
+
+	std::string name(std::size_t id)
+	{
+		std::lock_guard<std::mutex> lock{ mutex_ };
+		return names_[id];
+	}
+private:
+	std::mutex mutex_;
+	std::vector<std::string> names_;
+};
+
+inline Registry& registry()
+{
+	static Registry registry;
+	return registry;
+}
+
+template<typename T>
+std::size_t type_id()
+{
+	static std::size_t const id = registry().add(bobl::utility::type_name<T>());
+	return id;
+}
+
+template<typename Iterator>
+std::uint64_t distance(Iterator first, Iterator last, std::forward_iterator_tag) { return std::uint64_t(std::distance(first, last)); }
+template<typename Iterator>
+std::uint64_t distance(Iterator /*first*/, Iterator /*last*/, std::input_iterator_tag) { return 0; }
+
+} /*namespace details*/
+
+inline void allocation(std::size_t size)
+{
+	auto& totals = details::totals();
+	++totals.allocations;
+	totals.allocated_bytes += size;
+}
+
+inline void exception() { ++details::totals().exceptions; }
+
+// position(begin) taken before decoding and begin after it delimit consumed bytes, which are counted only for forward iterators
+template<typename Iterator>
+Iterator position(Iterator const& i) { return i; }
+template<typename Iterator>
+void scanned(Iterator first, Iterator last) { details::totals().bytes_scanned += details::distance(first, last, typename std::iterator_traits<Iterator>::iterator_category{}); }
+template<typename Iterator>
+void skipped(Iterator first, Iterator last) { details::totals().bytes_skipped += details::distance(first, last, typename std::iterator_traits<Iterator>::iterator_category{}); }
+
+template<typename T>
+void elements(std::size_t n = 1)
+{
+	details::totals().elements += n;
+	auto& types = details::types();
+	auto id = details::type_id<T>();
+	if (types.size() <= id)
+		types.resize(id + 1);
+	types[id] += n;
+}
+
+inline Snapshot snapshot()
+{
+	auto& totals = details::totals();
+	auto const before = totals;
+	auto res = Snapshot{};
+	res.allocations = totals.allocations;
+	res.allocated_bytes = totals.allocated_bytes;
+	res.exceptions = totals.exceptions;
+	res.bytes_scanned = totals.bytes_scanned;
+	res.bytes_skipped = totals.bytes_skipped;
+	res.elements = totals.elements;
+	auto const& types = details::types();
+	for (std::size_t id = 0; id != types.size(); ++id)
+	{
+		if (types[id] != 0)
+			res.types.emplace(details::registry().name(id), types[id]);
+	}
+	// allocations made by snapshot itself aren't counted
+	totals.allocations = before.allocations;
+	totals.allocated_bytes = before.allocated_bytes;
+	return res;
+}
+
+#else
+
+inline void allocation(std::size_t /*size*/) {}
+inline void exception() {}
+// iterators aren't even copied
+struct Position {};
+template<typename Iterator>
+Position position(Iterator const& /*i*/) { return {}; }
+template<typename Iterator>
+void scanned(Position /*first*/, Iterator const& /*last*/) {}
+template<typename Iterator>
+void skipped(Position /*first*/, Iterator const& /*last*/) {}
+template<typename T>
+void elements(std::size_t /*n*/ = 1) {}
+inline Snapshot snapshot() { return {}; }
+
+#endif
+
+// std::allocator counting its allocations
+template<typename T>
+class Allocator : public std::allocator<T>
+{
+public:
+	template<typename U>
+	struct rebind { using other = Allocator<U>; };
+
+	Allocator() = default;
+	template<typename U>
+	Allocator(Allocator<U> const& other) : std::allocator<T>{ other } {}
+
+	T* allocate(std::size_t n)
+	{
+		allocation(n * sizeof(T));
+		return std::allocator<T>::allocate(n);
+	}
+};
+
+}/*namespace stats*/} /*namespace bobl*/
+
+#ifdef BOBL_ENABLE_STATS
+// replaces global operator new to count allocations, has to be placed in exactly one translation unit at namespace scope
+#define BOBL_STATS_COUNT_ALLOCATIONS() \
+	void* operator new(std::size_t size) \
+	{ \
+		bobl::stats::allocation(size); \
+		if (auto res = std::malloc(size == 0 ? 1 : size)) \
+			return res; \
+		throw std::bad_alloc{}; \
+	} \
+	BOBL_STATS_DELETE_BEGIN_ \
+	void operator delete(void* p) noexcept { std::free(p); } \
+	BOBL_STATS_SIZED_DELETE_ \
+	BOBL_STATS_DELETE_END_
+// gcc inlines replaced delete into callers of new and takes free of the pointer new returned for mismatch,
+// it can't see that replaced new got it from malloc
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#define BOBL_STATS_DELETE_BEGIN_ _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wmismatched-new-delete\"")
+#define BOBL_STATS_DELETE_END_ _Pragma("GCC diagnostic pop")
+#else
+#define BOBL_STATS_DELETE_BEGIN_
+#define BOBL_STATS_DELETE_END_
+#endif
+#if defined(__cpp_sized_deallocation)
+#define BOBL_STATS_SIZED_DELETE_ void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#else
+#define BOBL_STATS_SIZED_DELETE_
+#endif
+#else
+#define BOBL_STATS_COUNT_ALLOCATIONS()
+#endif
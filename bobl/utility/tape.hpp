@@ -0,0 +1,151 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/utility/any.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <cassert>
+
+namespace bobl{ namespace utility{ namespace tape {
+
+// one structural element (value, object key) of an encoded buffer
+struct Entry
+{
+	std::size_t begin;	  // offset of the first byte
+	std::size_t end;	  // offset past the last byte
+	std::size_t next;	  // index of the entry following this entry subtree
+	std::size_t children; // position of the first direct child in Tape::children
+	std::size_t size;	  // number of direct children (keys are counted for objects)
+};
+
+static constexpr std::size_t npos = (std::numeric_limits<std::size_t>::max)();
+
+template<typename Iterator>
+class Tape
+{
+public:
+	using iterator = Iterator;
+
+	Tape(Iterator begin, std::vector<Entry>&& entries, std::vector<std::size_t>&& children)
+		: begin_{ std::move(begin) }, entries_{ std::move(entries) }, children_{ std::move(children) } {}
+
+	std::size_t size() const { return entries_.size(); }
+	bool empty() const { return entries_.empty(); }
+	Entry const& operator[](std::size_t index) const { return entries_[index]; }
+
+	std::size_t next(std::size_t index) const { return entries_[index].next; }
+	std::size_t children(std::size_t index) const { return entries_[index].size; }
+	std::size_t child(std::size_t index, std::size_t n) const
+	{
+		assert(n < entries_[index].size);
+		return children_[entries_[index].children + n];
+	}
+
+	Iterator begin(std::size_t index) const { return std::next(begin_, entries_[index].begin); }
+	Iterator end(std::size_t index) const { return std::next(begin_, entries_[index].end); }
+	boost::iterator_range<Iterator> range(std::size_t index) const { return { begin(index), end(index) }; }
+
+	template<typename AnyType>
+	AnyType as(std::size_t index) const { return AnyType{ begin(index), end(index) }; }
+
+	// index of the entry starting at position, or npos
+	std::size_t find(Iterator position) const
+	{
+		auto offset = std::size_t(std::distance(begin_, position));
+		auto i = std::lower_bound(std::begin(entries_), std::end(entries_), offset, [](Entry const& entry, std::size_t offset) { return entry.begin < offset; });
+		//  object key and its value never share an offset, nested values might (BSON/CBOR), first one is the outermost
+		return i == std::end(entries_) || i->begin != offset ? npos : std::size_t(std::distance(std::begin(entries_), i));
+	}
+private:
+	Iterator begin_;
+	std::vector<Entry> entries_;
+	std::vector<std::size_t> children_;
+};
+
+class Builder
+{
+public:
+	std::size_t value(std::size_t begin, std::size_t end)
+	{
+		auto index = entries_.size();
+		entries_.push_back(Entry{ begin, end, index + 1, 0, 0 });
+		pending_.push_back(index);
+		return index;
+	}
+
+	std::size_t open(std::size_t begin)
+	{
+		auto index = value(begin, begin);
+		stack_.push_back(pending_.size());
+		return index;
+	}
+
+	std::size_t close(std::size_t end)
+	{
+		if(stack_.empty())
+			throw bobl::InvalidObject{ "unbalanced structure, nothing to close" };
+		auto mark = stack_.back();
+		stack_.pop_back();
+		auto index = pending_[mark - 1];
+		auto& entry = entries_[index];
+		entry.end = end;
+		entry.next = entries_.size();
+		entry.children = children_.size();
+		entry.size = pending_.size() - mark;
+		children_.insert(std::end(children_), std::next(std::begin(pending_), mark), std::end(pending_));
+		pending_.resize(mark);
+		return index;
+	}
+
+	std::size_t depth() const { return stack_.size(); }
+	std::size_t children() const { return stack_.empty() ? pending_.size() : pending_.size() - stack_.back(); }
+
+	template<typename Iterator>
+	Tape<Iterator> tape(Iterator begin) &&
+	{
+		if (!stack_.empty())
+			throw bobl::InvalidObject{ "unbalanced structure, not all objects are closed" };
+		return { std::move(begin), std::move(entries_), std::move(children_) };
+	}
+private:
+	std::vector<Entry> entries_;
+	std::vector<std::size_t> children_;
+	std::vector<std::size_t> stack_;
+	std::vector<std::size_t> pending_;
+};
+
+// iterates over direct children of container entry, Stride is 2 for objects (key, value)
+template<typename T, typename Options, typename Decoder, typename RawIterator, std::size_t Stride>
+class Iterator : public boost::iterator_facade<Iterator<T, Options, Decoder, RawIterator, Stride>, T, boost::forward_traversal_tag, T>
+{
+public:
+	Iterator(Tape<RawIterator> const& tape, std::size_t parent, std::size_t position) : tape_{ &tape }, parent_{ parent }, position_{ position } {}
+
+	void increment() { position_ += Stride; }
+	T dereference() const { return Decoder::template decode<T, Options>(*tape_, parent_, position_); }
+	bool equal(Iterator const& other) const { return position_ == other.position_ && parent_ == other.parent_ && tape_ == other.tape_; }
+private:
+	Tape<RawIterator> const* tape_;
+	std::size_t parent_;
+	std::size_t position_;
+};
+
+template<typename T, typename Options, typename Decoder, std::size_t Stride, typename RawIterator>
+boost::iterator_range<Iterator<T, Options, Decoder, RawIterator, Stride>> make_iterator_range(Tape<RawIterator> const& tape, std::size_t parent)
+{
+	if (parent >= tape.size())
+		throw bobl::InvalidObject{ "tape has no such entry" };
+	auto n = tape.children(parent);
+	if(n % Stride != 0)
+		throw bobl::InvalidObject{ "tape entry has unexpected number of children" };
+	return boost::make_iterator_range(Iterator<T, Options, Decoder, RawIterator, Stride>{tape, parent, 0},
+										Iterator<T, Options, Decoder, RawIterator, Stride>{tape, parent, n});
+}
+
+}/*namespace tape*/}/*namespace utility*/} /*namespace bobl*/
@@ -0,0 +1,52 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/utility/diversion.hpp"
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+
+namespace bobl{ namespace transcoder{
+
+// Reader<NsTag>::read(begin, end, writer) walks encoded value and reports it to the writer as a sequence of events:
+//	null(), boolean(bool), integer(std::int64_t), unsigned_integer(std::uint64_t), floating_point(double),
+//	string(string_view), binary(std::uint8_t const* begin, std::uint8_t const* end), uuid(std::uint8_t const* data /*16 bytes*/),
+//	time_point(std::int64_t milliseconds since epoch),
+//	begin_array(std::size_t size), end_array(), begin_object(std::size_t size), name(string_view), end_object()
+// size is UnknownSize if reader can't tell it upfront.
+// string/name views are valid only till the next event.
+template<typename NsTag> class Reader;
+
+// Writer<NsTag, Sink> encodes events into the Sink, a contiguous byte container (std::vector<std::uint8_t>, std::string...)
+template<typename NsTag, typename Sink> class Writer;
+
+static constexpr std::size_t UnknownSize = (std::numeric_limits<std::size_t>::max)();
+
+namespace details {
+
+// writes decimal representation of value ending at end, returns its beginning
+inline char* to_chars(char* end, std::uint64_t value)
+{
+	do
+	{
+		*--end = char('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	return end;
+}
+
+class Decimal
+{
+public:
+	explicit Decimal(std::uint64_t value) : begin_{ to_chars(buffer_ + sizeof(buffer_), value) } {}
+	Decimal(Decimal const&) = delete;
+	Decimal& operator=(Decimal const&) = delete;
+	diversion::string_view view() const { return { begin_, std::size_t(buffer_ + sizeof(buffer_) - begin_) }; }
+private:
+	char buffer_[std::numeric_limits<std::uint64_t>::digits10 + 1];
+	char* begin_;
+};
+
+} /*namespace details*/
+
+}/*namespace transcoder*/} /*namespace bobl*/
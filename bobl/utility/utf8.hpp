@@ -0,0 +1,119 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(BOBL_UTF8_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define BOBL_UTF8_SSE2_
+#endif
+
+// UTF-8 validation as required by RFC 3629: no overlong forms, no surrogates, nothing above U+10FFFF.
+// Runs of ASCII are skipped 16 bytes at a time with SSE2 (8 at a time elsewhere),
+// multi byte sequences are checked one by one.
+namespace bobl{ namespace utility{ namespace utf8 {
+
+namespace details {
+
+// 8 bytes at a time while all of them are ASCII
+inline std::uint8_t const* skip_ascii_swar(std::uint8_t const* begin, std::uint8_t const* end)
+{
+	for (; end - begin >= 8; begin += 8)
+	{
+		std::uint64_t chunk;
+		std::memcpy(&chunk, begin, sizeof(chunk));
+		if ((chunk & 0x8080808080808080ull) != 0)
+			break;
+	}
+	return begin;
+}
+
+inline std::uint8_t const* skip_ascii(std::uint8_t const* begin, std::uint8_t const* end)
+{
+#ifdef BOBL_UTF8_SSE2_
+	for (; end - begin >= 16; begin += 16)
+	{
+		if (auto mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(begin))))
+		{
+			// first non ASCII byte
+			while ((mask & 1) == 0)
+			{
+				mask >>= 1;
+				++begin;
+			}
+			return begin;
+		}
+	}
+#endif
+	begin = skip_ascii_swar(begin, end);
+	while (begin != end && *begin < 0x80)
+		++begin;
+	return begin;
+}
+
+// validates sequence starting with non ASCII lead byte, returns its end or nullptr if it is invalid
+inline std::uint8_t const* sequence(std::uint8_t const* begin, std::uint8_t const* end)
+{
+	auto lead = *begin;
+	auto size = std::ptrdiff_t{ 0 };
+	// allowed range of the second byte, it rules out overlong forms, surrogates and values above U+10FFFF
+	auto low = std::uint8_t{ 0x80 };
+	auto high = std::uint8_t{ 0xbf };
+	if (lead >= 0xc2 && lead <= 0xdf)
+		size = 2;
+	else if (lead >= 0xe0 && lead <= 0xef)
+	{
+		size = 3;
+		if (lead == 0xe0)
+			low = 0xa0;
+		else if (lead == 0xed)
+			high = 0x9f;
+	}
+	else if (lead >= 0xf0 && lead <= 0xf4)
+	{
+		size = 4;
+		if (lead == 0xf0)
+			low = 0x90;
+		else if (lead == 0xf4)
+			high = 0x8f;
+	}
+	else
+		return nullptr;
+	if (end - begin < size || begin[1] < low || begin[1] > high)
+		return nullptr;
+	for (auto i = std::ptrdiff_t{ 2 }; i < size; ++i)
+	{
+		if ((begin[i] & 0xc0) != 0x80)
+			return nullptr;
+	}
+	return begin + size;
+}
+
+} /*namespace details*/
+
+// the first byte of invalid sequence or end if [begin, end) is valid UTF-8
+inline std::uint8_t const* find_invalid(std::uint8_t const* begin, std::uint8_t const* end)
+{
+	for (;;)
+	{
+		begin = details::skip_ascii(begin, end);
+		if (begin == end)
+			break;
+		auto next = details::sequence(begin, end);
+		if (next == nullptr)
+			break;
+		begin = next;
+	}
+	return begin;
+}
+
+inline bool valid(std::uint8_t const* begin, std::uint8_t const* end) { return find_invalid(begin, end) == end; }
+inline bool valid(char const* begin, std::size_t size)
+{
+	auto first = reinterpret_cast<std::uint8_t const*>(begin);
+	return valid(first, first + size);
+}
+
+}/*namespace utf8*/} /*namespace utility*/} /*namespace bobl*/
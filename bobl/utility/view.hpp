@@ -0,0 +1,196 @@
+// Copyright (c) 2015-2018 Serge Klimov serge.klim@outlook.com
+
+#pragma once
+#include "bobl/utility/decoders.hpp"
+#include "bobl/utility/names.hpp"
+#include "bobl/utility/options.hpp"
+#include "bobl/utility/type_name.hpp"
+#include "bobl/utility/diversion.hpp"
+#include "bobl/names.hpp"
+#include "bobl/options.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/fusion/include/at.hpp>
+#include <boost/fusion/include/size.hpp>
+#include <boost/fusion/include/value_at.hpp>
+#include <boost/format.hpp>
+#include <functional>
+#include <bitset>
+#include <array>
+#include <type_traits>
+#include <cstddef>
+
+namespace bobl{ namespace utility{
+
+namespace details {
+
+template<typename Sequence, typename T, std::size_t N>
+auto member_index(Sequence const& /*probe*/, void const* /*member*/) -> typename std::enable_if<N == boost::fusion::result_of::size<Sequence>::value, std::size_t>::type
+{
+	return N;
+}
+
+template<typename Sequence, typename T, std::size_t N>
+auto member_index(Sequence const& probe, void const* member) -> typename std::enable_if<N != boost::fusion::result_of::size<Sequence>::value, std::size_t>::type;
+
+// only members of type T are compared, address of the others is never taken
+template<typename Sequence, typename T, std::size_t N>
+std::size_t member_index(Sequence const& probe, void const* member, std::true_type /*same type*/)
+{
+	return static_cast<void const*>(&boost::fusion::at_c<N>(probe)) == member ? N : member_index<Sequence, T, N + 1>(probe, member);
+}
+
+template<typename Sequence, typename T, std::size_t N>
+std::size_t member_index(Sequence const& probe, void const* member, std::false_type /*same type*/)
+{
+	return member_index<Sequence, T, N + 1>(probe, member);
+}
+
+template<typename Sequence, typename T, std::size_t N>
+auto member_index(Sequence const& probe, void const* member) -> typename std::enable_if<N != boost::fusion::result_of::size<Sequence>::value, std::size_t>::type
+{
+	return member_index<Sequence, T, N>(probe, member, std::is_same<T, typename boost::fusion::result_of::value_at_c<Sequence, N>::type>{});
+}
+
+// members of the same object are told apart by their addresses, Sequence is default constructible (see LazyDictionary),
+// so one instance per Sequence serves all the lookups
+template<typename Sequence>
+Sequence const& probe()
+{
+	static Sequence const res{};
+	return res;
+}
+
+template<typename T> struct MemberPointer;
+template<typename Sequence, typename T> struct MemberPointer<T Sequence::*> { using type = T; };
+
+} /*namespace details*/
+
+// position of the adapted member pointed by member in the Sequence or size of the Sequence if member is not adapted
+template<typename Sequence, typename T>
+std::size_t member_index(T Sequence::*member)
+{
+	auto const& probe = details::probe<Sequence>();
+	return details::member_index<Sequence, T, 0>(probe, &(probe.*member));
+}
+
+// Lazily decodes members of the named Sequence encoded as a dictionary.
+// Dictionary is scanned only as far as needed to locate requested member, positions of all members met on the way are cached,
+// so every dictionary entry is visited by the scan at most once and following access to found members costs only their decoding.
+// If dictionary contains the same key more than once the first one wins.
+// Not thread safe, every thread should use its own copy.
+template<typename Sequence, typename Iterator, typename ObjectDecoder, typename EndOfObject, typename ...Options>
+class LazyDictionary
+{
+	static_assert(DictionaryDecoderCompatible<Sequence, bobl::Options<Options...>>::value, "bobl::utility::LazyDictionary expects Sequence to be default constructible,"
+																	"a boost::fusion sequence with named members");
+	static constexpr std::size_t Size = boost::fusion::result_of::size<Sequence>::value;
+	template<std::size_t N>
+	using Type = typename boost::fusion::result_of::value_at_c<Sequence, N>::type;
+	template<std::size_t N>
+	using MemberName = typename bobl::utility::GetNameType<bobl::MemberName<Sequence, Type<N>, N, bobl::Options<Options...>>>::type;
+	using Skipper = typename ObjectDecoder::Skipper;
+public:
+	LazyDictionary(Iterator begin, Iterator end, EndOfObject eoo = EndOfObject{}) : current_{ begin }, end_{ end }, eoo_( std::move(eoo) ) {}
+
+	template<std::size_t N>
+	Type<N> get() const
+	{
+		static_assert(N < Size, "member index is out of range");
+		if (!contains(N))
+			return missing<N>();
+		auto begin = positions_[N];
+		auto key = decoder_.decode_name(begin, end_);
+		return decoder_.template decode<Type<N>>(std::move(key), begin, end_);
+	}
+
+	template<typename T>
+	T get(T Sequence::*member) const { return get_<T, 0>(member_index(member)); }
+
+#if __cplusplus >= 201703L
+	template<auto Member>
+	auto get() const -> typename details::MemberPointer<decltype(Member)>::type
+	{
+		static auto const index = member_index(Member);
+		return get_<typename details::MemberPointer<decltype(Member)>::type, 0>(index);
+	}
+#endif
+
+	bool contains(std::size_t n) const { return found_.test(n) || find(n); }
+private:
+	bool find(std::size_t n) const
+	{
+		while (!complete_)
+		{
+			if (eoo_(current_, end_))
+			{
+				complete_ = true;
+				break;
+			}
+			auto position = current_;
+			auto key = decoder_.decode_name(current_, end_);
+			auto index = lookup<0>(ObjectDecoder::name(key));
+			if (index != Size && !found_.test(index))
+			{
+				positions_[index] = position;
+				found_.set(index);
+			}
+			decoder_.template decode<Skipper>(std::move(key), current_, end_);
+			if (index == n)
+				return true;
+		}
+		return false;
+	}
+
+	template<std::size_t N>
+	static auto lookup(diversion::string_view name) -> typename std::enable_if<N != Size, std::size_t>::type
+	{
+		return MemberName<N>{}.compare(name) ? N : lookup<N + 1>(name);
+	}
+
+	template<std::size_t N>
+	static auto lookup(diversion::string_view /*name*/) -> typename std::enable_if<N == Size, std::size_t>::type { return N; }
+
+	template<std::size_t N>
+	static Type<N> missing() { return missing<N>(std::integral_constant<bool, bobl::utility::options::Contains<bobl::Options<Options...>, bobl::options::ExacMatch>::value>{}); }
+
+	template<std::size_t N>
+	static Type<N> missing(std::true_type /*exact match*/)
+	{
+		throw bobl::InvalidObject{ str(boost::format("dictionary %1% has no \"%2%\" key") % bobl::utility::type_name<Sequence>() % MemberName<N>::name()) };
+	}
+
+	template<std::size_t N>
+	static Type<N> missing(std::false_type /*exact match*/)
+	{
+		auto res = Type<N>{};
+		bobl::utility::DefaultValue<Sequence, Type<N>>{}(res);
+		return res;
+	}
+
+	template<typename T, std::size_t N>
+	auto get_(std::size_t index) const -> typename std::enable_if<N != Size, T>::type
+	{
+		return get_as<T, N>(index, std::is_same<T, Type<N>>{});
+	}
+
+	template<typename T, std::size_t N>
+	auto get_(std::size_t /*index*/) const -> typename std::enable_if<N == Size, T>::type
+	{
+		throw bobl::InvalidObject{ str(boost::format("member pointer doesn't point to adapted member of %1%") % bobl::utility::type_name<Sequence>()) };
+	}
+
+	template<typename T, std::size_t N>
+	T get_as(std::size_t index, std::true_type) const { return index == N ? get<N>() : get_<T, N + 1>(index); }
+	template<typename T, std::size_t N>
+	T get_as(std::size_t index, std::false_type) const { return get_<T, N + 1>(index); }
+private:
+	mutable std::array<Iterator, Size> positions_;
+	mutable std::bitset<Size> found_;
+	mutable bool complete_ = false;
+	mutable Iterator current_;
+	Iterator end_;
+	mutable EndOfObject eoo_;
+	mutable ObjectDecoder decoder_;
+};
+
+}/*namespace utility*/} /*namespace bobl*/
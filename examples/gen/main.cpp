@@ -2,6 +2,7 @@
 #include "bobl/bson/flyweight.hpp"
 #include "bobl/bson/cast.hpp"
 #include "bobl/bson/decode.hpp"
+#include "bobl/bson/stream.hpp"
 #include "bobl/bobl.hpp"
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/format.hpp>
@@ -187,8 +188,14 @@ int main(int argc, char *argv[])
 		}
 
 		boost::iostreams::mapped_file_source mmap{ argv[1] };
-		auto begin = mmap.begin();
-		auto doc = bobl::bson::flyweight::Document::decode(begin,mmap.end());
+		// files may contain back to back documents (mongodump), the first one describes the layout
+		auto stream = bobl::bson::DocumentStream{ mmap.begin(), mmap.end() };
+		auto doc = stream.next();
+		if (!doc)
+		{
+			std::cerr << "BSON encoded file is empty" << std::endl;
+			return 1;
+		}
 		auto& out = std::cout;
 		out << "#include <vector>\n"
 		<< "#include <string>\n"
@@ -196,7 +203,7 @@ int main(int argc, char *argv[])
 		<< "#include <cstdint>\n"
 		<< "#include <boost/fusion/include/adapt_struct.hpp>\n"
 		<< "#include <boost/uuid/uuid.hpp>\n\n";
-		dump(out, "Top", bobl::bson::make_iterator_range<NameValue>(doc));
+		dump(out, "Top", bobl::bson::make_iterator_range<NameValue>(*doc));
 	}
 	catch (std::exception& e)
 	{
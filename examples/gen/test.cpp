@@ -1,12 +1,11 @@
 #include "struct.hpp"
+#include "bench/bench.hpp"
 #include "bobl/bson/encode.hpp"
 #include "bobl/cbor/encode.hpp"
 #include "bobl/bson/decode.hpp"
 #include "bobl/cbor/decode.hpp"
 #include <boost/format.hpp>
 #include <boost/program_options.hpp>
-#include <boost/chrono/thread_clock.hpp>
-#include <boost/chrono/chrono_io.hpp>
 #include <boost/spirit/include/qi.hpp>
 #include <boost/spirit/include/qi_parse.hpp>
 #include <string>
@@ -49,7 +48,8 @@ int main(int argc, char *argv[])
 					("help,h", "print usage message")
 					("input-type,t", boost::program_options::value<InputType>(), "input file type (bson, cbor)")
 					("filename", boost::program_options::value<std::string>(), "encoded file")
-					("repeat,n", boost::program_options::value<size_t>()->default_value(10000), "repeat tests")
+					("samples,n", boost::program_options::value<size_t>()->default_value(15), "timed samples per benchmark")
+					("json", boost::program_options::value<std::string>(), "write results as JSON to file")
 					;
 
 		boost::program_options::positional_options_description positional;
@@ -90,79 +90,42 @@ int main(int argc, char *argv[])
 		auto begin = bson_in.data();
 		auto data = bobl::bson::decode<struct_Top>(begin, begin + bson_in.size());
 
-		size_t n = vm["repeat"].as<size_t>();
+		using Relaxed = bobl::Options<bobl::options::StructAsDictionary, bobl::options::RelaxedIntegers, bobl::options::RelaxedFloats>;
+		auto suite = bench::Suite{};
+		suite.add("bson/decode", bson_in.size(), 1, [&bson_in]()
 		{
-			auto start = boost::chrono::thread_clock::now();
-			for (size_t i = 0; i != n; ++i)
-			{
-				auto begin = bson_in.data();
-				bobl::bson::decode<struct_Top>(begin, begin + bson_in.size());
-			}
-			auto elapsed = boost::chrono::thread_clock::now() - start;
-			std::cout << "bson decode (" << n << " times) :" << boost::chrono::duration_cast<boost::chrono::milliseconds>(elapsed) << " (" << elapsed <<')' << std::endl;;
-		}
+			auto begin = static_cast<std::uint8_t const*>(bson_in.data());
+			bench::do_not_optimize(bobl::bson::decode<struct_Top>(begin, begin + bson_in.size()));
+		});
+		suite.add("bson/decode/relaxed", bson_in.size(), 1, [&bson_in]()
 		{
-			auto start = boost::chrono::thread_clock::now();
-			for (size_t i = 0; i != n; ++i)
-			{
-				auto begin = bson_in.data();
-				bobl::bson::decode<struct_Top, bobl::Options<bobl::options::StructAsDictionary, bobl::options::RelaxedIntegers, bobl::options::RelaxedFloats>>(begin, begin + bson_in.size());
-			}
-			auto elapsed = boost::chrono::thread_clock::now() - start;
-			std::cout << "bson decode <bobl::options::StructAsDictionary, bobl::options::RelaxedIntegers, bobl::options::RelaxedFloats> (" << n << " times) :" << boost::chrono::duration_cast<boost::chrono::milliseconds>(elapsed) << " (" << elapsed << ')' << std::endl;;
-		}
-
+			auto begin = static_cast<std::uint8_t const*>(bson_in.data());
+			bench::do_not_optimize(bobl::bson::decode<struct_Top, Relaxed>(begin, begin + bson_in.size()));
+		});
+		suite.add("bson/encode", bson_in.size(), 1, [&data]() { bench::do_not_optimize(bobl::bson::encode(data)); });
+		suite.add("bson/encode/optimize_size", bson_in.size(), 1, [&data]() { bench::do_not_optimize(bobl::bson::encode<bobl::options::IntegerOptimizeSize>(data)); });
+		suite.add("cbor/decode", cbor_in.size(), 1, [&cbor_in]()
 		{
-			auto start = boost::chrono::thread_clock::now();
-			for (size_t i = 0; i != n; ++i)
-				bobl::bson::encode(data);
-			auto elapsed = boost::chrono::thread_clock::now() - start;
-			std::cout << "bson encode (" << n << " times) :" << boost::chrono::duration_cast<boost::chrono::milliseconds>(elapsed) << " (" << elapsed << ')' << std::endl;;
-		}
-
+			auto begin = static_cast<std::uint8_t const*>(cbor_in.data());
+			bench::do_not_optimize(bobl::cbor::decode<struct_Top>(begin, begin + cbor_in.size()));
+		});
+		suite.add("cbor/decode/relaxed", cbor_in.size(), 1, [&cbor_in]()
 		{
-			auto start = boost::chrono::thread_clock::now();
-			for (size_t i = 0; i != n; ++i)
-				bobl::bson::encode<bobl::options::IntegerOptimizeSize>(data);
-			auto elapsed = boost::chrono::thread_clock::now() - start;
-			std::cout << "bson encode <bobl::options::IntegerOptimizeSize> (" << n << " times) :" << boost::chrono::duration_cast<boost::chrono::milliseconds>(elapsed) << " (" << elapsed << ')' << std::endl;;
-		}
-		{
-			auto start = boost::chrono::thread_clock::now();
-			for (size_t i = 0; i != n; ++i)
-			{
-				auto const* begin = cbor_in.data();
-				bobl::cbor::decode<struct_Top, bobl::Options<bobl::options::StructAsDictionary, bobl::options::RelaxedIntegers, bobl::options::RelaxedFloats>>(begin, begin + cbor_in.size());
-			}
-			auto elapsed = boost::chrono::thread_clock::now() - start;
-			std::cout << "cbor decode <bobl::options::StructAsDictionary, bobl::options::RelaxedIntegers, bobl::options::RelaxedFloats> (" << n << " times) :" << boost::chrono::duration_cast<boost::chrono::milliseconds>(elapsed) << " (" << elapsed << ')' << std::endl;;
-		}
+			auto begin = static_cast<std::uint8_t const*>(cbor_in.data());
+			bench::do_not_optimize(bobl::cbor::decode<struct_Top, Relaxed>(begin, begin + cbor_in.size()));
+		});
+		suite.add("cbor/encode", cbor_in.size(), 1, [&data]() { bench::do_not_optimize(bobl::cbor::encode(data)); });
+		suite.add("cbor/encode/optimize_size", cbor_in.size(), 1, [&data]() { bench::do_not_optimize(bobl::cbor::encode<bobl::options::IntegerOptimizeSize>(data)); });
 
+		auto config = bench::Config{};
+		config.samples = vm["samples"].as<size_t>();
+		auto results = suite.run(config);
+		bench::report_text(std::cout, results);
+		if (vm.count("json"))
 		{
-			auto start = boost::chrono::thread_clock::now();
-			for (size_t i = 0; i != n; ++i)
-			{
-				auto const* begin = cbor_in.data();
-				bobl::cbor::decode<struct_Top>(begin, begin + cbor_in.size());
-			}
-			auto elapsed = boost::chrono::thread_clock::now() - start;
-			std::cout << "cbor decode (" << n << " times) :" << boost::chrono::duration_cast<boost::chrono::milliseconds>(elapsed) << " (" << elapsed << ')' << std::endl;;
+			std::ofstream out{ vm["json"].as<std::string>() };
+			bench::report_json(out, results);
 		}
-		{
-			auto start = boost::chrono::thread_clock::now();
-			for (size_t i = 0; i != n; ++i)
-				bobl::cbor::encode(data);
-			auto elapsed = boost::chrono::thread_clock::now() - start;
-			std::cout << "cbor encode (" << n <<" times) :" << boost::chrono::duration_cast<boost::chrono::milliseconds>(elapsed) << " (" << elapsed << ')' << std::endl;;
-		}
-		{
-			auto start = boost::chrono::thread_clock::now();
-			for (size_t i = 0; i != n; ++i)
-				bobl::cbor::encode<bobl::options::IntegerOptimizeSize>(data);
-			auto elapsed = boost::chrono::thread_clock::now() - start;
-			std::cout << "cbor encode <bobl::options::IntegerOptimizeSize> (" << n << " times) :" << boost::chrono::duration_cast<boost::chrono::milliseconds>(elapsed) << " (" << elapsed << ')' << std::endl;;
-		}
-
 	}
 	catch (std::exception& e)
 	{
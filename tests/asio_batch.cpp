@@ -0,0 +1,107 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/asio/batch.hpp"
+#include "bobl/bson/batch.hpp"
+#include "bobl/bobl.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+BOOST_AUTO_TEST_SUITE(BOBL_Asio_Batch_TestSuite)
+
+Simple message(int i)
+{
+	return Simple{ i % 2 == 0, i, std::string(std::size_t(i % 200), 'a' + char(i % 26)), Enum::One };
+}
+
+template<typename Protocol>
+void batches()
+{
+	auto const n = 1000;
+	auto batches = std::vector<std::vector<std::uint8_t>>{};
+	auto offsets = std::vector<std::vector<std::size_t>>{};
+	auto encoder = bobl::asio::make_batch_encoder<Protocol>([&batches, &offsets](std::uint8_t const* data, std::size_t size, std::vector<std::size_t> const& frames)
+	{
+		batches.emplace_back(data, data + size);
+		offsets.push_back(frames);
+	}, 4096, 50);
+	for (auto i = 0; i != n; ++i)
+		encoder.write(message(i));
+	BOOST_CHECK_NE(encoder.size(), 0);
+	encoder.flush();
+	BOOST_CHECK_EQUAL(encoder.size(), 0);
+	BOOST_CHECK_EQUAL(encoder.buffered(), 0);
+	BOOST_CHECK_GT(batches.size(), n / 50);
+
+	auto i = 0;
+	for (std::size_t b = 0; b != batches.size(); ++b)
+	{
+		BOOST_CHECK_LE(offsets[b].size(), 50);
+		auto reader = bobl::asio::BatchReader<Protocol>{ batches[b].data(), batches[b].data() + batches[b].size() };
+		for (auto offset : offsets[b])
+		{
+			BOOST_CHECK_EQUAL(reader.offset(), offset);
+			auto value = reader.template next<Simple>();
+			BOOST_REQUIRE(!!value);
+			BOOST_CHECK_EQUAL(value->id, i);
+			BOOST_CHECK_EQUAL(value->name, message(i).name);
+			++i;
+		}
+		BOOST_CHECK(!reader.next());
+		reader.seek(offsets[b].back());
+		BOOST_CHECK_EQUAL(reader.template next<Simple>()->id, i - 1);
+	}
+	BOOST_CHECK_EQUAL(i, n);
+
+	auto const& last = batches.back();
+	auto truncated = bobl::asio::BatchReader<Protocol>{ last.data(), last.data() + last.size() - 1 };
+	for (auto j = std::size_t{ 1 }; j != offsets.back().size(); ++j)
+		truncated.next();
+	BOOST_CHECK_THROW(truncated.next(), bobl::InputToShort);
+}
+
+BOOST_AUTO_TEST_CASE(CborBatchTest)
+{
+	batches<bobl::asio::Cbor>();
+	auto const wrapped = std::vector<std::uint8_t>{ 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01, 0xf6 };
+	auto reader = bobl::asio::BatchReader<bobl::asio::Cbor>{ wrapped.data(), wrapped.data() + wrapped.size() };
+	BOOST_CHECK_THROW(reader.next(), bobl::InvalidObject);
+	// appended frames are the same as separately encoded ones
+	for (auto size : { std::size_t{ 0 }, std::size_t{ 120 }, std::size_t{ 200 }, std::size_t{ 20000 } })
+	{
+		auto const value = std::string(size, 'z');
+		auto buffer = std::vector<std::uint8_t>{};
+		auto offset = bobl::asio::Cbor::encode(buffer, value);
+		auto appended = std::vector<std::uint8_t>{ 0x42 };
+		bobl::asio::Cbor::append(appended, value);
+		BOOST_CHECK_EQUAL(appended.front(), 0x42);
+		BOOST_CHECK_EQUAL_COLLECTIONS(appended.begin() + 1, appended.end(), buffer.begin() + offset, buffer.end());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(BsonBatchTest)
+{
+	batches<bobl::asio::Bson>();
+	// messages of received batch decoded in parallel
+	auto data = std::vector<std::uint8_t>{};
+	auto encoder = bobl::asio::make_batch_encoder<bobl::asio::Bson>([&data](std::uint8_t const* begin, std::size_t size, std::vector<std::size_t> const&)
+	{
+		data.assign(begin, begin + size);
+	});
+	for (auto i = 0; i != 100; ++i)
+		encoder.write(message(i));
+	encoder.flush();
+	auto reader = bobl::asio::BatchReader<bobl::asio::Bson>{ data.data(), data.data() + data.size() };
+	auto spans = std::vector<boost::iterator_range<std::uint8_t const*>>{};
+	while (auto span = reader.next())
+		spans.push_back(*span);
+	bobl::utility::ThreadPool pool{ 2 };
+	auto results = bobl::bson::decode_batch<Simple>(spans, pool);
+	BOOST_REQUIRE_EQUAL(results.size(), 100);
+	for (auto i = 0; i != 100; ++i)
+		BOOST_CHECK_EQUAL(results[i].value().id, i);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,234 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/asio/channel.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/local/connect_pair.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/use_future.hpp>
+#include <boost/asio/write.hpp>
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#endif
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+
+namespace {
+
+// completion token starting operation only once returned function is called, the way deferred and use_awaitable do
+struct Lazy {};
+
+} /*namespace*/
+
+namespace boost { namespace asio {
+
+template<>
+class async_result<Lazy, void(boost::system::error_code, std::size_t)>
+{
+public:
+	using Handler = std::function<void(boost::system::error_code, std::size_t)>;
+	using return_type = std::function<void(Handler)>;
+
+	template<typename Initiation>
+	static return_type initiate(Initiation&& initiation, Lazy)
+	{
+		auto operation = std::make_shared<typename std::decay<Initiation>::type>(std::forward<Initiation>(initiation));
+		return [operation](Handler handler) { std::move(*operation)(std::move(handler)); };
+	}
+};
+
+}/*namespace asio*/}/*namespace boost*/
+
+
+BOOST_AUTO_TEST_SUITE(BOBL_Asio_Channel_TestSuite)
+
+using Socket = boost::asio::local::stream_protocol::socket;
+
+template<typename Protocol>
+void exchange(std::size_t capacity)
+{
+	boost::asio::io_context io;
+	Socket left{ io };
+	Socket right{ io };
+	boost::asio::local::connect_pair(left, right);
+	bobl::asio::Channel<Protocol, Socket> sender{ std::move(left) };
+	bobl::asio::Channel<Protocol, Socket> receiver{ std::move(right), capacity };
+
+	auto const n = 200;
+	auto received = std::vector<Simple>{};
+	auto read_error = boost::system::error_code{};
+	std::function<void()> read = [&]()
+	{
+		receiver.template async_read<Simple>([&](boost::system::error_code error, Simple value)
+		{
+			if (error)
+			{
+				read_error = error;
+				return;
+			}
+			received.push_back(std::move(value));
+			if (received.size() != n)
+				read();
+		});
+	};
+	read();
+	auto written = 0;
+	auto write_errors = 0;
+	// writes queued from several threads concurrently
+	auto writers = std::vector<std::thread>{};
+	for (auto w = 0; w != 4; ++w)
+	{
+		writers.emplace_back([&, w]()
+		{
+			for (auto i = w; i < n; i += 4)
+				sender.async_write(Simple{ i % 2 == 0, i, std::string(std::size_t(i * 3), 'a' + char(i % 26)), Enum::Two }, [&written, &write_errors](boost::system::error_code error, std::size_t size)
+				{
+					if (error || size == 0)
+						++write_errors;
+					++written;
+				});
+		});
+	}
+	for (auto& writer : writers)
+		writer.join();
+	io.run();
+	BOOST_CHECK(!read_error);
+	BOOST_CHECK_EQUAL(write_errors, 0);
+	BOOST_CHECK_EQUAL(written, n);
+	BOOST_REQUIRE_EQUAL(received.size(), std::size_t(n));
+	std::sort(received.begin(), received.end(), [](Simple const& x, Simple const& y) { return x.id < y.id; });
+	for (auto i = 0; i != n; ++i)
+	{
+		BOOST_CHECK_EQUAL(received[i].id, i);
+		BOOST_CHECK_EQUAL(received[i].enabled, i % 2 == 0);
+		BOOST_CHECK_EQUAL(received[i].name, std::string(std::size_t(i * 3), 'a' + char(i % 26)));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(CborChannelTest)
+{
+	exchange<bobl::asio::Cbor>(64 * 1024);
+	// messages larger than receive buffer
+	exchange<bobl::asio::Cbor>(16);
+}
+
+BOOST_AUTO_TEST_CASE(BsonChannelTest)
+{
+	exchange<bobl::asio::Bson>(64 * 1024);
+	exchange<bobl::asio::Bson>(16);
+}
+
+BOOST_AUTO_TEST_CASE(CborFrameTest)
+{
+	auto buffer = std::vector<std::uint8_t>{};
+	auto offset = bobl::asio::Cbor::encode(buffer, std::string(300, 'x'));
+	auto header = std::size_t{ 0 };
+	auto size = bobl::asio::Cbor::frame(buffer.data() + offset, buffer.data() + buffer.size(), header);
+	BOOST_CHECK_EQUAL(header, 2);
+	BOOST_CHECK_EQUAL(size, buffer.size() - offset);
+	BOOST_CHECK_EQUAL((bobl::asio::Cbor::decode<std::string, bobl::options::None>(buffer.data() + offset + header, buffer.data() + offset + size)), std::string(300, 'x'));
+	BOOST_CHECK_EQUAL(bobl::asio::Cbor::frame(buffer.data() + offset, buffer.data() + offset + 1, header), 0);
+	auto const invalid = std::vector<std::uint8_t>(11, 0xff);
+	BOOST_CHECK_THROW(bobl::asio::Cbor::frame(invalid.data(), invalid.data() + invalid.size(), header), bobl::InvalidObject);
+	// size beyond 64 bits would wrap around to a frame shorter than its header
+	auto const wrapped = std::vector<std::uint8_t>{ 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01 };
+	BOOST_CHECK_THROW(bobl::asio::Cbor::frame(wrapped.data(), wrapped.data() + wrapped.size(), header), bobl::InvalidObject);
+	auto const beyond = std::vector<std::uint8_t>{ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x02 };
+	BOOST_CHECK_THROW(bobl::asio::Cbor::frame(beyond.data(), beyond.data() + beyond.size(), header), bobl::InvalidObject);
+}
+
+BOOST_AUTO_TEST_CASE(ChannelErrorsTest)
+{
+	boost::asio::io_context io;
+	Socket left{ io };
+	Socket right{ io };
+	boost::asio::local::connect_pair(left, right);
+	bobl::asio::Channel<bobl::asio::Cbor, Socket> receiver{ std::move(right), 1024, 128 };
+	auto errors = std::vector<boost::system::error_code>{};
+	auto const message = std::vector<std::uint8_t>{ 0x01, 0xf6 /*null*/, 0x80, 0x02 /*too large*/ };
+	boost::asio::write(left, boost::asio::buffer(message));
+	receiver.async_read<int>([&errors, &receiver](boost::system::error_code error, int /*value*/)
+	{
+		errors.push_back(error);
+		receiver.async_read<int>([&errors](boost::system::error_code error, int /*value*/) { errors.push_back(error); });
+	});
+	io.run();
+	BOOST_REQUIRE_EQUAL(errors.size(), 2);
+	BOOST_CHECK(errors[0] == boost::system::errc::bad_message);
+	BOOST_CHECK(errors[1] == boost::asio::error::message_size);
+
+	// size prefix wrapping around
+	io.restart();
+	Socket peer{ io };
+	Socket local{ io };
+	boost::asio::local::connect_pair(peer, local);
+	bobl::asio::Channel<bobl::asio::Cbor, Socket> victim{ std::move(local) };
+	auto const wrapped = std::vector<std::uint8_t>{ 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01 };
+	boost::asio::write(peer, boost::asio::buffer(wrapped));
+	errors.clear();
+	victim.async_read<int>([&errors](boost::system::error_code error, int /*value*/) { errors.push_back(error); });
+	io.run();
+	BOOST_REQUIRE_EQUAL(errors.size(), 1);
+	BOOST_CHECK(errors[0] == boost::system::errc::bad_message);
+
+	// completion token other than callback
+	io.restart();
+	bobl::asio::Channel<bobl::asio::Bson, Socket> sender{ std::move(left) };
+	auto future = sender.async_write(Simple{ true, 7, "seven", Enum::One }, boost::asio::use_future);
+	io.run();
+	BOOST_CHECK_GT(future.get(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ChannelLazyWriteTest)
+{
+	boost::asio::io_context io;
+	Socket left{ io };
+	Socket right{ io };
+	boost::asio::local::connect_pair(left, right);
+	bobl::asio::Channel<bobl::asio::Cbor, Socket> sender{ std::move(left) };
+	bobl::asio::Channel<bobl::asio::Cbor, Socket> receiver{ std::move(right) };
+	// message is initiated after async_write has returned
+	auto write = sender.async_write(Simple{ true, 42, std::string(200, 'x'), Enum::Two }, Lazy{});
+	auto written = std::size_t{ 0 };
+	write([&written](boost::system::error_code error, std::size_t size) { written = error ? 0 : size; });
+	auto received = Simple{};
+	receiver.async_read<Simple>([&received](boost::system::error_code error, Simple value) { if (!error) received = std::move(value); });
+	io.run();
+	BOOST_CHECK_GT(written, 0);
+	BOOST_CHECK_EQUAL(received.id, 42);
+	BOOST_CHECK_EQUAL(received.name, std::string(200, 'x'));
+}
+
+#if defined(BOOST_ASIO_HAS_CO_AWAIT)
+BOOST_AUTO_TEST_CASE(ChannelAwaitableTest)
+{
+	boost::asio::io_context io;
+	Socket left{ io };
+	Socket right{ io };
+	boost::asio::local::connect_pair(left, right);
+	bobl::asio::Channel<bobl::asio::Cbor, Socket> sender{ std::move(left) };
+	bobl::asio::Channel<bobl::asio::Cbor, Socket> receiver{ std::move(right) };
+	auto written = std::size_t{ 0 };
+	auto received = Simple{};
+	boost::asio::co_spawn(io, [&]() -> boost::asio::awaitable<void>
+	{
+		auto write = sender.async_write(Simple{ true, 42, std::string(200, 'x'), Enum::Two }, boost::asio::use_awaitable);
+		written = co_await std::move(write);
+		received = co_await receiver.async_read<Simple>(boost::asio::use_awaitable);
+	}, boost::asio::detached);
+	io.run();
+	BOOST_CHECK_GT(written, 0);
+	BOOST_CHECK_EQUAL(received.id, 42);
+	BOOST_CHECK_EQUAL(received.name, std::string(200, 'x'));
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
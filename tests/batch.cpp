@@ -0,0 +1,150 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/cbor/batch.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/bson/batch.hpp"
+#include "bobl/bson/encode.hpp"
+#include "bobl/json/batch.hpp"
+#include "bobl/utility/parallel.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
+
+
+BOOST_AUTO_TEST_SUITE(BOBL_Batch_TestSuite)
+
+std::vector<Simple> items()
+{
+	auto res = std::vector<Simple>{};
+	for (auto i = 0; i != 1000; ++i)
+		res.push_back(Simple{ i % 2 == 0, i, std::to_string(i), Enum::Two });
+	return res;
+}
+
+BOOST_AUTO_TEST_CASE(ThreadPoolTest)
+{
+	bobl::utility::ThreadPool pool{ 4 };
+	BOOST_CHECK_EQUAL(pool.size(), 4);
+	for (auto round = 0; round != 10; ++round)
+	{
+		auto visited = std::vector<std::atomic<int>>(1000);
+		pool.parallel_for(visited.size(), 7, [&visited](std::size_t worker, std::size_t /*batch*/, std::size_t first, std::size_t last)
+		{
+			// uneven batches make workers steal from each other
+			if (worker == 0)
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			for (auto i = first; i != last; ++i)
+				++visited[i];
+		});
+		for (auto const& v : visited)
+			BOOST_REQUIRE_EQUAL(v.load(), 1);
+	}
+	BOOST_CHECK_THROW(pool.parallel_for(100, 1, [](std::size_t, std::size_t batch, std::size_t, std::size_t)
+	{
+		if (batch == 42)
+			throw std::runtime_error{ "42" };
+	}), std::runtime_error);
+	std::atomic<std::size_t> n{ 0 };
+	pool.parallel_for(3, 1, [&n](std::size_t, std::size_t, std::size_t, std::size_t) { ++n; });
+	BOOST_CHECK_EQUAL(n.load(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(BusyThreadPoolTest)
+{
+	bobl::utility::ThreadPool pool{ 2 };
+	std::atomic<bool> started{ false };
+	std::atomic<bool> done{ false };
+	// first job holds the pool until the second one (from another thread) is finished
+	auto first = std::thread{ [&pool, &started, &done]()
+	{
+		pool.parallel_for(1, 1, [&started, &done](std::size_t, std::size_t, std::size_t, std::size_t)
+		{
+			started = true;
+			auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+			while (!done && std::chrono::steady_clock::now() < deadline)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		});
+	} };
+	while (!started)
+		std::this_thread::yield();
+	auto workers = std::vector<std::size_t>{};
+	pool.parallel_for(100, 10, [&workers](std::size_t worker, std::size_t, std::size_t, std::size_t) { workers.push_back(worker); });
+	done = true;
+	first.join();
+	BOOST_CHECK_EQUAL(workers.size(), 10);
+	BOOST_CHECK(std::all_of(workers.begin(), workers.end(), [](std::size_t worker) { return worker == 0; }));
+}
+
+BOOST_AUTO_TEST_CASE(CborBatchTest)
+{
+	auto const values = items();
+	auto encoded = std::vector<std::vector<std::uint8_t>>{};
+	for (auto const& value : values)
+		encoded.push_back(bobl::cbor::encode(value));
+	encoded[10].push_back(0); // trailing garbage
+	encoded[20].resize(encoded[20].size() / 2);
+	auto spans = std::vector<boost::iterator_range<std::uint8_t const*>>{};
+	for (auto const& data : encoded)
+		spans.emplace_back(data.data(), data.data() + data.size());
+	bobl::utility::ThreadPool pool{ 3 };
+	auto results = bobl::cbor::decode_batch<Simple>(spans, pool, 16);
+	BOOST_REQUIRE_EQUAL(results.size(), values.size());
+	for (std::size_t i = 0; i != results.size(); ++i)
+	{
+		if (i == 10 || i == 20)
+		{
+			BOOST_CHECK(!results[i]);
+			BOOST_CHECK(!results[i].what().empty());
+			BOOST_CHECK_THROW(results[i].value(), std::exception);
+			continue;
+		}
+		BOOST_REQUIRE(results[i]);
+		BOOST_CHECK_EQUAL(results[i].value().id, values[i].id);
+		BOOST_CHECK_EQUAL(results[i].value().name, values[i].name);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(BsonBatchTest)
+{
+	auto const values = items();
+	auto encoded = std::vector<std::vector<std::uint8_t>>{};
+	for (auto const& value : values)
+		encoded.push_back(bobl::bson::encode(value));
+	encoded[999].back() = 1;
+	auto spans = std::vector<std::pair<std::uint8_t const*, std::uint8_t const*>>{};
+	for (auto const& data : encoded)
+		spans.emplace_back(data.data(), data.data() + data.size());
+	auto results = std::vector<bobl::utility::Result<Simple>>(spans.size());
+	bobl::utility::ThreadPool pool{ 2 };
+	bobl::bson::decode_batch<Simple>(spans, results.begin(), pool);
+	for (std::size_t i = 0; i != results.size() - 1; ++i)
+		BOOST_CHECK_EQUAL(std::move(results[i]).value().enabled, values[i].enabled);
+	BOOST_CHECK(!results.back());
+}
+
+BOOST_AUTO_TEST_CASE(JsonBatchTest)
+{
+	auto const json = std::vector<std::string>{
+		R"({"enabled" : true, "id" : 1, "name" : "one", "theEnum" : 1})",
+		R"( {"enabled" : false, "id" : 2, "name" : "two", "theEnum" : 2} )",
+		R"({"enabled" : false, "id" : 3, "name" : "three", "theEnum" : 2} 4)"
+	};
+	auto spans = std::vector<boost::iterator_range<char const*>>{};
+	for (auto const& data : json)
+		spans.emplace_back(data.data(), data.data() + data.size());
+	bobl::utility::ThreadPool pool{ 2 };
+	auto results = bobl::json::decode_batch<Simple>(spans, pool, 1);
+	BOOST_REQUIRE_EQUAL(results.size(), 3);
+	BOOST_CHECK_EQUAL(results[0].value().name, "one");
+	BOOST_CHECK_EQUAL(results[1].value().id, 2);
+	BOOST_CHECK(!results[2]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 #include "bobl/bson/cast.hpp"
 #include "bobl/bson/flyweight.hpp"
 #include "bobl/bson/decode.hpp"
+#include "bobl/bson/encode.hpp"
 #include "bobl/utility/decoders.hpp"
 #include "tests.hpp"
 #include <boost/uuid/uuid_io.hpp>
@@ -1156,4 +1157,57 @@ BOOST_AUTO_TEST_CASE(UUIDVectorTest2)
 	BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(res.vector), std::end(res.vector), std::begin(expected), std::end(expected));
 }
 
+BOOST_AUTO_TEST_CASE(ParallelArraysTest)
+{
+	auto value = Vector<Simple>{};
+	for (auto i = 0; i != 5000; ++i)
+		value.vector.push_back(Simple{ i % 2 == 0, i, "n" + std::to_string(i), Enum::Two });
+	auto data = bobl::bson::encode(value);
+	using Parallel = bobl::Options<bobl::options::ParallelArrays<1>>;
+	auto begin = data.data();
+	auto res = bobl::bson::decode<Vector<Simple>, Parallel>(begin, data.data() + data.size());
+	BOOST_CHECK(begin == data.data() + data.size());
+	BOOST_REQUIRE_EQUAL(res.vector.size(), value.vector.size());
+	for (std::size_t i = 0; i != res.vector.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(res.vector[i].enabled, value.vector[i].enabled);
+		BOOST_CHECK_EQUAL(res.vector[i].id, value.vector[i].id);
+		BOOST_CHECK_EQUAL(res.vector[i].name, value.vector[i].name);
+	}
+	// below threshold arrays are decoded sequentially
+	begin = data.data();
+	auto small = bobl::bson::decode<Vector<Simple>, bobl::Options<bobl::options::ParallelArrays<(1 << 30)>>>(begin, data.data() + data.size());
+	BOOST_CHECK_EQUAL(small.vector.size(), value.vector.size());
+
+	// make name of element 3000 a symbol, element layout is the same but it can't be decoded as std::string
+	auto const name = std::string{ "n3000" };
+	auto i = std::search(data.begin(), data.end(), name.begin(), name.end());
+	BOOST_REQUIRE(i != data.end());
+	auto type = i - sizeof(std::uint32_t) - sizeof("name") - 1;
+	BOOST_REQUIRE_EQUAL(int(*type), int(bobl::bson::Utf8String));
+	*type = bobl::bson::Symbol;
+	auto error = [&data](bool parallel)
+	{
+		auto begin = data.data();
+		try
+		{
+			if (parallel)
+				bobl::bson::decode<Vector<Simple>, Parallel>(begin, data.data() + data.size());
+			else
+				bobl::bson::decode<Vector<Simple>>(begin, data.data() + data.size());
+		}
+		catch (std::exception const& e)
+		{
+			return std::string{ e.what() };
+		}
+		return std::string{};
+	};
+	BOOST_CHECK(!error(false).empty());
+	BOOST_CHECK_EQUAL(error(true), error(false));
+	// and now element 3000 can't be even skipped
+	*type = 0x42;
+	BOOST_CHECK(!error(false).empty());
+	BOOST_CHECK_EQUAL(error(true), error(false));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
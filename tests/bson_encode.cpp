@@ -715,4 +715,17 @@ BOOST_AUTO_TEST_CASE(OptionalTest)
 	BOOST_CHECK_THROW((bobl::bson::decode<diversion::optional<EnumClass>, int>(begin, end)), bobl::InvalidObject);
 }
 
+BOOST_AUTO_TEST_CASE(ParallelArraysTest)
+{
+	auto value = Vector<Simple>{};
+	for (auto i = 0; i != 5000; ++i)
+		value.vector.push_back(Simple{ i % 3 == 0, i, std::string(std::size_t(i % 17), 'a' + char(i % 26)), Enum::One });
+	auto const expected = bobl::bson::encode(value);
+	BOOST_CHECK(bobl::bson::encode<bobl::options::ParallelArrays<1>>(value) == expected);
+	// nested vectors are encoded inline by the worker encoding outer one
+	auto nested = Vector<std::vector<int>>{ std::vector<std::vector<int>>(300, std::vector<int>{ 1, 2, 3, 4 }) };
+	BOOST_CHECK(bobl::bson::encode<bobl::options::ParallelArrays<1>>(nested) == bobl::bson::encode(nested));
+	BOOST_CHECK(bobl::bson::encode<bobl::options::ParallelArrays<>>(Vector<Simple>{}) == bobl::bson::encode(Vector<Simple>{}));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,109 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/bson/stream.hpp"
+#include "bobl/bson/encode.hpp"
+#include "bobl/bson/cast.hpp"
+#include "bobl/bobl.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+BOOST_AUTO_TEST_SUITE(BOBL_BSON_Stream_TestSuite)
+
+std::vector<Simple> documents()
+{
+	auto res = std::vector<Simple>{};
+	for (auto i = 0; i != 10; ++i)
+		res.push_back(Simple{ i % 2 == 0, i, std::string(std::size_t(i * 7), 'a' + char(i)), Enum::Two });
+	return res;
+}
+
+std::vector<std::uint8_t> encoded(std::vector<Simple> const& values)
+{
+	auto res = std::vector<std::uint8_t>{};
+	for (auto const& value : values)
+	{
+		auto data = bobl::bson::encode(value);
+		res.insert(res.end(), data.begin(), data.end());
+	}
+	return res;
+}
+
+BOOST_AUTO_TEST_CASE(DocumentStreamTest)
+{
+	auto const values = documents();
+	auto const data = encoded(values);
+	auto stream = bobl::bson::DocumentStream{ data.data(), data.data() + data.size() };
+	auto n = std::size_t{ 0 };
+	while (auto document = stream.next())
+	{
+		BOOST_REQUIRE_LT(n, values.size());
+		auto value = bobl::bson::cast<Simple>(*document);
+		BOOST_CHECK_EQUAL(value.id, values[n].id);
+		BOOST_CHECK_EQUAL(value.name, values[n].name);
+		++n;
+	}
+	BOOST_CHECK_EQUAL(n, values.size());
+	BOOST_CHECK(stream.empty());
+
+	auto truncated = bobl::bson::DocumentStream{ data.data(), data.data() + data.size() - 1 };
+	for (auto i = std::size_t{ 1 }; i != values.size(); ++i)
+		truncated.next();
+	BOOST_CHECK_THROW(truncated.next(), bobl::InputToShort);
+}
+
+BOOST_AUTO_TEST_CASE(DocumentReaderTest)
+{
+	auto const values = documents();
+	auto const data = encoded(values);
+	auto position = std::size_t{ 0 };
+	// small reads and a buffer smaller than most of the documents
+	auto reader = bobl::bson::make_document_reader([&data, &position](std::uint8_t* buffer, std::size_t size)
+	{
+		auto n = std::min(std::min(size, std::size_t{ 13 }), data.size() - position);
+		std::copy(data.data() + position, data.data() + position + n, buffer);
+		position += n;
+		return n;
+	}, 16);
+	auto n = std::size_t{ 0 };
+	while (auto document = reader.next())
+	{
+		BOOST_REQUIRE_LT(n, values.size());
+		auto value = bobl::bson::cast<Simple>(*document);
+		BOOST_CHECK_EQUAL(value.enabled, values[n].enabled);
+		BOOST_CHECK_EQUAL(value.name, values[n].name);
+		++n;
+	}
+	BOOST_CHECK_EQUAL(n, values.size());
+}
+
+BOOST_AUTO_TEST_CASE(DocumentWriterTest)
+{
+	auto const values = documents();
+	auto const expected = encoded(values);
+	auto res = std::vector<std::uint8_t>{};
+	auto writes = std::size_t{ 0 };
+	auto writer = bobl::bson::make_document_writer([&res, &writes](std::uint8_t const* data, std::size_t size)
+	{
+		res.insert(res.end(), data, data + size);
+		++writes;
+	}, 128);
+	for (auto const& value : values)
+		writer.write(value);
+	writer.flush();
+	BOOST_CHECK_EQUAL(writer.buffered(), 0);
+	BOOST_CHECK_LT(writes, values.size());
+	BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), expected.begin(), expected.end());
+
+	// documents from the stream are copied as is
+	res.clear();
+	auto stream = bobl::bson::DocumentStream{ expected.data(), expected.data() + expected.size() };
+	while (auto document = stream.next())
+		writer.write(*document);
+	writer.flush();
+	BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
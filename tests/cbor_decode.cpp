@@ -839,6 +839,36 @@ BOOST_AUTO_TEST_CASE(UUIDVectorTest2)
 	BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(res.vector), std::end(res.vector), std::begin(expected), std::end(expected));
 }
 
+BOOST_AUTO_TEST_CASE(InitialByteTableTest)
+{
+	static_assert(bobl::cbor::utility::decode::initial_byte(bobl::cbor::Float32).is_float, "initial byte table has to be usable at compile time");
+	for (auto i = 0; i != 256; ++i)
+	{
+		auto const& initial = bobl::cbor::utility::decode::initial_byte(std::uint8_t(i));
+		auto info = i & bobl::cbor::AditionalInfoMask;
+		BOOST_CHECK(initial.major_type == bobl::cbor::utility::decode::major_type(std::uint8_t(i)));
+		BOOST_CHECK_EQUAL(int(initial.width), info < 24 || info > 27 ? 0 : 1 << (info - 24));
+		BOOST_CHECK_EQUAL(initial.is_break, i == bobl::cbor::Break);
+	}
+	BOOST_CHECK(bobl::cbor::utility::decode::initial_byte(bobl::cbor::Float16).is_float);
+	BOOST_CHECK(bobl::cbor::utility::decode::initial_byte(bobl::cbor::Float64).is_float);
+	BOOST_CHECK(!bobl::cbor::utility::decode::initial_byte(bobl::cbor::Break).is_float);
+	BOOST_CHECK(!bobl::cbor::utility::decode::initial_byte(bobl::cbor::UnsignedInt64).is_float);
+	BOOST_CHECK(bobl::cbor::utility::decode::initial_byte(bobl::cbor::Array | 31).is_indefinite);
+	BOOST_CHECK(!bobl::cbor::utility::decode::initial_byte(bobl::cbor::Tag | 31).is_indefinite);
+	BOOST_CHECK(bobl::cbor::utility::decode::initial_byte(bobl::cbor::Tag | 31).is_malformed);
+	BOOST_CHECK(bobl::cbor::utility::decode::initial_byte(bobl::cbor::UnsignedInt | 28).is_malformed);
+	BOOST_CHECK(!bobl::cbor::utility::decode::initial_byte(bobl::cbor::Break).is_malformed);
+}
 
+BOOST_AUTO_TEST_CASE(ReservedAdditionalInfoTest)
+{
+	std::uint8_t data[] = { bobl::cbor::UnsignedInt | 28, 0, 0, 0, 0, 0, 0, 0, 0 };
+	uint8_t const* begin = data;
+	uint8_t const* end = begin + sizeof(data) / sizeof(data[0]);
+	BOOST_CHECK_THROW(bobl::cbor::decode<int>(begin, end), bobl::InvalidObject);
+	begin = data;
+	BOOST_CHECK_THROW(bobl::cbor::decode<bobl::flyweight::lite::Any<std::uint8_t const*>>(begin, end), bobl::InvalidObject);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
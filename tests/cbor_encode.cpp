@@ -808,4 +808,63 @@ BOOST_AUTO_TEST_CASE(OptionalTest)
 }
 
 
+BOOST_AUTO_TEST_CASE(ParallelArraysTest)
+{
+	auto value = Vector<Simple>{};
+	for (auto i = 0; i != 5000; ++i)
+		value.vector.push_back(Simple{ i % 3 == 0, i, std::string(std::size_t(i % 17), 'a' + char(i % 26)), Enum::One });
+	auto const expected = bobl::cbor::encode(value);
+	BOOST_CHECK(bobl::cbor::encode<bobl::options::ParallelArrays<1>>(value) == expected);
+	// nested vectors are encoded inline by the worker encoding outer one
+	auto nested = Vector<std::vector<int>>{ std::vector<std::vector<int>>(300, std::vector<int>{ 1, 2, 3, 4 }) };
+	BOOST_CHECK(bobl::cbor::encode<bobl::options::ParallelArrays<1>>(nested) == bobl::cbor::encode(nested));
+	BOOST_CHECK(bobl::cbor::encode<bobl::options::ParallelArrays<>>(Vector<Simple>{}) == bobl::cbor::encode(Vector<Simple>{}));
+}
+
+BOOST_AUTO_TEST_CASE(IndexKeysTest)
+{
+	auto const value = Simple{ true, 7, "x", Two };
+	auto const data = bobl::cbor::encode<bobl::options::IndexKeys>(value);
+	// {0: true, 1: 7, 2: "x", 3: 2}
+	auto const expected = std::vector<std::uint8_t>{ 0xa4, 0x00, 0xf5, 0x01, 0x1a, 0x00, 0x00, 0x00, 0x07, 0x02, 0x61, 0x78, 0x03, 0x1a, 0x00, 0x00, 0x00, 0x02 };
+	BOOST_CHECK_EQUAL_COLLECTIONS(data.begin(), data.end(), expected.begin(), expected.end());
+	BOOST_CHECK_LT(data.size(), bobl::cbor::encode(value).size());
+	auto begin = data.data();
+	auto end = begin + data.size();
+	auto simple = bobl::cbor::decode<Simple>(begin, end);
+	BOOST_CHECK_EQUAL(begin, end);
+	BOOST_CHECK_EQUAL(simple.id, 7);
+	BOOST_CHECK_EQUAL(simple.name, "x");
+	begin = data.data();
+	simple = bobl::cbor::decode<Simple, bobl::Options<bobl::options::StructAsDictionary, bobl::options::ExacMatch>>(begin, end);
+	BOOST_CHECK_EQUAL(begin, end);
+	BOOST_CHECK(simple.enabled);
+	BOOST_CHECK_EQUAL(int(simple.theEnum), 2);
+}
+
+BOOST_AUTO_TEST_CASE(MemberIdTest)
+{
+	auto const data = bobl::cbor::encode<bobl::options::IndexKeys, bobl::options::IntegerOptimizeSize>(Keyed{ 5, "x", 1 });
+	// {10: 5, 20: "x", 300: 1}
+	auto const expected = std::vector<std::uint8_t>{ 0xa3, 0x0a, 0x05, 0x14, 0x61, 0x78, 0x19, 0x01, 0x2c, 0x01 };
+	BOOST_CHECK_EQUAL_COLLECTIONS(data.begin(), data.end(), expected.begin(), expected.end());
+	auto begin = data.data();
+	auto keyed = bobl::cbor::decode<Keyed, bobl::Options<bobl::options::RelaxedIntegers>>(begin, data.data() + data.size());
+	BOOST_CHECK_EQUAL(keyed.price, 5);
+	BOOST_CHECK_EQUAL(*keyed.size, 1);
+	// {20: "y", "price": 6, 7: 0} text and integer keys mixed, unknown key is skipped
+	std::uint8_t const mixed[] = { 0xa3, 0x14, 0x61, 0x79, 0x65, 0x70, 0x72, 0x69, 0x63, 0x65, 0x06, 0x07, 0x00 };
+	auto first = std::begin(mixed);
+	keyed = bobl::cbor::decode<Keyed, bobl::Options<bobl::options::StructAsDictionary, bobl::options::RelaxedIntegers>>(first, std::end(mixed));
+	BOOST_CHECK(first == std::end(mixed));
+	BOOST_CHECK_EQUAL(keyed.price, 6);
+	BOOST_CHECK_EQUAL(keyed.symbol, "y");
+	BOOST_CHECK(!keyed.size);
+	first = std::begin(mixed);
+	BOOST_CHECK_THROW((bobl::cbor::decode<Keyed, bobl::Options<bobl::options::StructAsDictionary, bobl::options::RelaxedIntegers, bobl::options::ExacMatch>>(first, std::end(mixed))), bobl::InvalidObject);
+	// members are expected in order
+	first = std::begin(mixed);
+	BOOST_CHECK_THROW((bobl::cbor::decode<Keyed, bobl::Options<bobl::options::RelaxedIntegers>>(first, std::end(mixed))), bobl::IncorrectObjectName);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
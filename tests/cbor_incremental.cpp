@@ -0,0 +1,120 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/cbor/incremental.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/bobl.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+BOOST_AUTO_TEST_SUITE(BOBL_CBOR_Incremental_TestSuite)
+
+struct Events : bobl::cbor::incremental::Callbacks
+{
+	void unsigned_int(std::uint64_t value) { log += std::to_string(value) + ' '; }
+	void negative_int(std::uint64_t n) { log += '-' + std::to_string(n + 1) + ' '; }
+	void tag(std::uint64_t tag) { log += std::to_string(tag) + '('; }
+	void boolean(bool value) { log += value ? "true " : "false "; }
+	void null() { log += "null "; }
+	void floating_point(double value) { log += std::to_string(value) + ' '; }
+	void begin_string(bobl::cbor::MajorType /*type*/, std::uint64_t /*length*/) { log += '"'; }
+	void string(std::uint8_t const* begin, std::uint8_t const* end) { log.append(begin, end); }
+	void end_string() { log += "\" "; }
+	void begin_array(std::uint64_t /*length*/) { log += "[ "; }
+	void end_array() { log += "] "; }
+	void begin_map(std::uint64_t /*length*/) { log += "{ "; }
+	void end_map() { log += "} "; }
+
+	std::string log;
+};
+
+BOOST_AUTO_TEST_CASE(ParserTest)
+{
+	// {"a": [1, -2, 1.5], "bc": "x"_y, "t": 1(100000), "e": [_ ], "z": true} null
+	std::uint8_t const data[] = {
+		0xa5,
+			0x61, 'a', 0x83, 0x01, 0x21, 0xf9, 0x3e, 0x00,
+			0x62, 'b', 'c', 0x7f, 0x61, 'x', 0x61, 'y', 0xff,
+			0x61, 't', 0xc1, 0x1a, 0x00, 0x01, 0x86, 0xa0,
+			0x61, 'e', 0x9f, 0xff,
+			0x61, 'z', 0xf5,
+		0xf6
+	};
+	auto const expected = std::string{ "{ \"a\" [ 1 -2 1.500000 ] \"bc\" \"xy\" \"t\" 1(100000 \"e\" [ ] \"z\" true } " };
+	// every possible split into chunks of the same size must give the same result
+	for (auto chunk = std::size_t{ 1 }; chunk <= sizeof(data); ++chunk)
+	{
+		auto events = Events{};
+		bobl::cbor::incremental::Parser<Events> parser{ events };
+		std::uint8_t const* begin = data;
+		auto status = bobl::cbor::incremental::Status::NeedMore;
+		for (std::uint8_t const* end = begin; status == bobl::cbor::incremental::Status::NeedMore;)
+		{
+			BOOST_REQUIRE(end != data + sizeof(data));
+			end = std::min(end + chunk, data + sizeof(data));
+			status = parser.feed(begin, end);
+		}
+		BOOST_CHECK(status == bobl::cbor::incremental::Status::ValueReady);
+		BOOST_CHECK_EQUAL(events.log, expected);
+		BOOST_CHECK_EQUAL(parser.depth(), 0);
+		BOOST_CHECK(parser.idle());
+		BOOST_CHECK(begin == data + sizeof(data) - 1);
+		events.log.clear();
+		std::uint8_t const* end = data + sizeof(data);
+		BOOST_CHECK(parser.feed(begin, end) == bobl::cbor::incremental::Status::ValueReady);
+		BOOST_CHECK_EQUAL(events.log, "null ");
+	}
+}
+
+BOOST_AUTO_TEST_CASE(DecoderTest)
+{
+	auto const first = Simple{ true, 7, "seven", Enum::Two };
+	auto const second = Simple{ false, -1, std::string(300, 'x'), Enum::One };
+	auto data = bobl::cbor::encode(first);
+	auto const tail = bobl::cbor::encode(second);
+	data.insert(data.end(), tail.begin(), tail.end());
+	bobl::cbor::incremental::Decoder<Simple> decoder;
+	auto values = std::vector<Simple>{};
+	std::uint8_t const* begin = data.data();
+	for (auto end = begin; begin != data.data() + data.size();)
+	{
+		end = std::min<std::uint8_t const*>(end + 5, data.data() + data.size());
+		while (begin != end)
+		{
+			if (decoder.feed(begin, end) == bobl::cbor::incremental::Status::ValueReady)
+				values.push_back(decoder.value());
+		}
+	}
+	BOOST_REQUIRE_EQUAL(values.size(), 2);
+	BOOST_CHECK_EQUAL(values[0].id, first.id);
+	BOOST_CHECK_EQUAL(values[0].name, first.name);
+	BOOST_CHECK_EQUAL(values[1].enabled, second.enabled);
+	BOOST_CHECK_EQUAL(values[1].name, second.name);
+	BOOST_CHECK_THROW(decoder.value(), bobl::InputToShort);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidTest)
+{
+	auto events = Events{};
+	bobl::cbor::incremental::Parser<Events> parser{ events };
+	std::uint8_t unexpected_break[] = { 0x82, 0x01, 0xff };
+	std::uint8_t const* begin = unexpected_break;
+	BOOST_CHECK(parser.feed(begin, begin + sizeof(unexpected_break)) == bobl::cbor::incremental::Status::Error);
+	BOOST_CHECK(!parser.error().empty());
+	BOOST_CHECK(parser.feed(begin, begin + 1) == bobl::cbor::incremental::Status::Error);
+	parser.reset();
+	std::uint8_t reserved[] = { 0x1c };
+	begin = reserved;
+	BOOST_CHECK(parser.feed(begin, begin + sizeof(reserved)) == bobl::cbor::incremental::Status::Error);
+	parser.reset();
+	std::uint8_t mixed_chunks[] = { 0x7f, 0x41, 0x00, 0xff };
+	begin = mixed_chunks;
+	BOOST_CHECK(parser.feed(begin, begin + sizeof(mixed_chunks)) == bobl::cbor::incremental::Status::Error);
+	parser.reset();
+	std::uint8_t odd_map[] = { 0xbf, 0x01, 0xff };
+	begin = odd_map;
+	BOOST_CHECK(parser.feed(begin, begin + sizeof(odd_map)) == bobl::cbor::incremental::Status::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,127 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/cbor/sequence.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/bobl.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+BOOST_AUTO_TEST_SUITE(BOBL_CBOR_Sequence_TestSuite)
+
+std::vector<Simple> items()
+{
+	auto res = std::vector<Simple>{};
+	for (auto i = 0; i != 25; ++i)
+		res.push_back(Simple{ i % 3 == 0, i, std::string(std::size_t(i * 5), 'a' + char(i)), Enum::One });
+	return res;
+}
+
+std::vector<std::uint8_t> encoded(std::vector<Simple> const& values)
+{
+	auto res = std::vector<std::uint8_t>{};
+	for (auto const& value : values)
+		bobl::cbor::encode(std::back_inserter(res), value);
+	return res;
+}
+
+BOOST_AUTO_TEST_CASE(SequenceReaderTest)
+{
+	auto const values = items();
+	auto const data = encoded(values);
+	auto reader = bobl::cbor::make_sequence_reader(data.data(), data.data() + data.size());
+	auto n = std::size_t{ 0 };
+	auto resume = std::size_t{ 0 };
+	while (auto value = reader.next<Simple>())
+	{
+		BOOST_REQUIRE_LT(n, values.size());
+		BOOST_CHECK_EQUAL(value->id, values[n].id);
+		BOOST_CHECK_EQUAL(value->name, values[n].name);
+		if (++n == 10)
+			resume = reader.offset();
+	}
+	BOOST_CHECK_EQUAL(n, values.size());
+	BOOST_CHECK(!reader.next());
+
+	reader.seek(resume);
+	BOOST_CHECK_EQUAL(reader.next<Simple>()->id, 10);
+
+	auto index = reader.index(4);
+	BOOST_CHECK_EQUAL(index.size, values.size());
+	BOOST_CHECK_EQUAL(index.offsets.size(), 7);
+	for (auto i : { std::size_t{ 0 }, std::size_t{ 3 }, std::size_t{ 4 }, std::size_t{ 17 }, std::size_t{ 24 } })
+	{
+		reader.seek(index, i);
+		BOOST_CHECK_EQUAL(reader.next<Simple>()->id, int(i));
+	}
+	reader.seek(index, values.size());
+	BOOST_CHECK(!reader.next());
+	BOOST_CHECK_THROW(reader.seek(index, values.size() + 1), bobl::RangeError);
+}
+
+BOOST_AUTO_TEST_CASE(SequenceStreamReaderTest)
+{
+	auto const values = items();
+	auto const data = encoded(values);
+	auto position = std::size_t{ 0 };
+	auto source = [&data, &position](std::uint8_t* buffer, std::size_t size)
+	{
+		auto n = std::min(std::min(size, std::size_t{ 7 }), data.size() - position);
+		std::copy(data.data() + position, data.data() + position + n, buffer);
+		position += n;
+		return n;
+	};
+	auto reader = bobl::cbor::make_sequence_stream_reader(source, 8);
+	auto n = std::size_t{ 0 };
+	while (auto value = reader.next<Simple>())
+	{
+		BOOST_REQUIRE_LT(n, values.size());
+		BOOST_CHECK_EQUAL(value->enabled, values[n].enabled);
+		BOOST_CHECK_EQUAL(value->name, values[n].name);
+		++n;
+	}
+	BOOST_CHECK_EQUAL(n, values.size());
+
+	auto const truncated = std::vector<std::uint8_t>(data.begin(), data.end() - 1);
+	position = 0;
+	auto treader = bobl::cbor::make_sequence_stream_reader([&truncated, &position](std::uint8_t* buffer, std::size_t size)
+	{
+		auto n = std::min(size, truncated.size() - position);
+		std::copy(truncated.data() + position, truncated.data() + position + n, buffer);
+		position += n;
+		return n;
+	});
+	for (auto i = std::size_t{ 1 }; i != values.size(); ++i)
+		treader.next();
+	BOOST_CHECK_THROW(treader.next(), bobl::InputToShort);
+}
+
+BOOST_AUTO_TEST_CASE(SequenceWriterTest)
+{
+	auto const values = items();
+	auto const expected = encoded(values);
+	auto res = std::vector<std::uint8_t>{};
+	auto writes = std::size_t{ 0 };
+	auto writer = bobl::cbor::make_sequence_writer([&res, &writes](std::uint8_t const* data, std::size_t size)
+	{
+		res.insert(res.end(), data, data + size);
+		++writes;
+	}, 256);
+	for (auto const& value : values)
+		writer.write(value);
+	writer.flush();
+	BOOST_CHECK_EQUAL(writer.buffered(), 0);
+	BOOST_CHECK_LT(writes, values.size());
+	BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), expected.begin(), expected.end());
+
+	res.clear();
+	auto reader = bobl::cbor::make_sequence_reader(expected.data(), expected.data() + expected.size());
+	while (auto any = reader.next())
+		writer.append(*any);
+	writer.flush();
+	BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
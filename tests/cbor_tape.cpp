@@ -0,0 +1,139 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/cbor/tape.hpp"
+#include "bobl/cbor/iterator.hpp"
+#include "bobl/cbor/cast.hpp"
+#include "bobl/bobl.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+BOOST_AUTO_TEST_SUITE(BOBL_CBOR_Tape_TestSuite)
+
+BOOST_AUTO_TEST_CASE(TapeStructureTest)
+{
+	// {"name": "abc", "array": [1, [2, 3], {"x": null}], "empty": {}, "last": true}
+	std::uint8_t data[] = {
+		0xa4,
+			0x64, 'n', 'a', 'm', 'e', 0x63, 'a', 'b', 'c',
+			0x65, 'a', 'r', 'r', 'a', 'y', 0x83, 0x01, 0x82, 0x02, 0x03, 0xa1, 0x61, 'x', 0xf6,
+			0x65, 'e', 'm', 'p', 't', 'y', 0xa0,
+			0x64, 'l', 'a', 's', 't', 0xf5
+	};
+	std::uint8_t const* begin = data;
+	auto tape = bobl::cbor::make_tape(begin, begin + sizeof(data));
+	// map, 4 names, "abc", array, 1, [2, 3], 2, 3, {"x": null}, "x", null, {}, true
+	BOOST_CHECK_EQUAL(tape.size(), 16);
+	BOOST_CHECK_EQUAL(tape.children(0), 8);
+	BOOST_CHECK_EQUAL(tape.next(0), tape.size());
+	BOOST_CHECK(tape.end(0) == begin + sizeof(data));
+	auto array = tape.child(0, 3);
+	BOOST_CHECK(tape.begin(array) == begin + 16);
+	BOOST_CHECK(tape.end(array) == begin + 25);
+	BOOST_CHECK_EQUAL(tape.children(array), 3);
+	BOOST_CHECK_EQUAL(tape.next(array), tape.child(0, 4));
+	auto nested = tape.child(array, 1);
+	BOOST_CHECK_EQUAL(tape.children(nested), 2);
+	BOOST_CHECK_EQUAL(tape.next(nested), tape.child(array, 2));
+	auto empty = tape.child(0, 5);
+	BOOST_CHECK_EQUAL(tape.children(empty), 0);
+	BOOST_CHECK(tape.end(empty) == tape.begin(empty) + 1);
+	BOOST_CHECK(bobl::cbor::skip(tape, tape.begin(array)) == tape.end(array));
+}
+
+BOOST_AUTO_TEST_CASE(TapeIndefiniteLengthTest)
+{
+	// 1(["ab" "c"_, {_ "k": [_ 1, 2]}, h'0102'])
+	std::uint8_t data[] = {
+		0xc1, 0x83,
+			0x7f, 0x62, 'a', 'b', 0x61, 'c', 0xff,
+			0xbf, 0x61, 'k', 0x9f, 0x01, 0x02, 0xff, 0xff,
+			0x42, 0x01, 0x02
+	};
+	std::uint8_t const* begin = data;
+	auto tape = bobl::cbor::make_tape(begin, begin + sizeof(data));
+	// tagged array, "abc", map, "k", [1, 2], 1, 2, bytes
+	BOOST_CHECK_EQUAL(tape.size(), 8);
+	BOOST_CHECK(tape.begin(0) == begin);
+	BOOST_CHECK(tape.end(0) == begin + sizeof(data));
+	BOOST_CHECK_EQUAL(tape.children(0), 3);
+	auto text = tape.child(0, 0);
+	BOOST_CHECK(tape.end(text) == begin + 9);
+	auto map = tape.child(0, 1);
+	BOOST_CHECK_EQUAL(tape.children(map), 2);
+	BOOST_CHECK(tape.end(map) == begin + 17);
+	BOOST_CHECK_EQUAL(tape.children(tape.child(map, 1)), 2);
+	BOOST_CHECK_EQUAL(tape.next(map), tape.child(0, 2));
+}
+
+BOOST_AUTO_TEST_CASE(TapeStringChunksTest)
+{
+	// [(_ h'ff'), 1], chunk payload is skipped rather than parsed
+	std::uint8_t const data[] = { 0x82, 0x5f, 0x41, 0xff, 0xff, 0x01 };
+	auto tape = bobl::cbor::make_tape(data, data + sizeof(data));
+	BOOST_CHECK_EQUAL(tape.size(), 3);
+	BOOST_CHECK(tape.end(tape.child(0, 0)) == data + 5);
+	// chunks must be definite length strings of the same type
+	std::uint8_t const nested[] = { 0x5f, 0x5f, 0x41, 0x01, 0xff, 0xff };
+	BOOST_CHECK_THROW(bobl::cbor::make_tape(nested, nested + sizeof(nested)), bobl::InvalidObject);
+	std::uint8_t const mixed[] = { 0x7f, 0x41, 0x61, 0xff };
+	BOOST_CHECK_THROW(bobl::cbor::make_tape(mixed, mixed + sizeof(mixed)), bobl::InvalidObject);
+	std::uint8_t const truncated[] = { 0x5f, 0x43, 0x01 };
+	BOOST_CHECK_THROW(bobl::cbor::make_tape(truncated, truncated + sizeof(truncated)), bobl::InputToShort);
+}
+
+BOOST_AUTO_TEST_CASE(TapeIteratorTest)
+{
+	// {"id": 7, "values": [1, 2, 3, 4], "nested": {"a": [5, 6], "b": "text"}}
+	std::uint8_t data[] = {
+		0xa3,
+			0x62, 'i', 'd', 0x07,
+			0x66, 'v', 'a', 'l', 'u', 'e', 's', 0x84, 0x01, 0x02, 0x03, 0x04,
+			0x66, 'n', 'e', 's', 't', 'e', 'd', 0xa2, 0x61, 'a', 0x82, 0x05, 0x06, 0x61, 'b', 0x64, 't', 'e', 'x', 't'
+	};
+	std::uint8_t const* begin = data;
+	std::uint8_t const* end = begin + sizeof(data);
+	auto tape = bobl::cbor::make_tape(begin, end);
+	auto object = tape.as<bobl::flyweight::lite::Object<std::uint8_t const*>>(0);
+	auto names = std::vector<std::string>{};
+	for (auto const& nv : bobl::cbor::make_iterator_range<bobl::flyweight::NameValue<bobl::flyweight::lite::Any<std::uint8_t const*>>>(tape, object))
+		names.emplace_back(nv.name().data(), nv.name().size());
+	BOOST_CHECK_EQUAL(names.size(), 3);
+	BOOST_CHECK_EQUAL(names[0], "id");
+	BOOST_CHECK_EQUAL(names[1], "values");
+	BOOST_CHECK_EQUAL(names[2], "nested");
+
+	auto range = bobl::cbor::make_iterator_range<bobl::flyweight::NameValue<bobl::flyweight::lite::Array<std::uint8_t const*>>>(tape, object);
+	auto array = std::next(range.begin())->value();
+	auto values = std::vector<int>{};
+	for (auto value : bobl::cbor::make_iterator_range<int>(tape, array))
+		values.push_back(value);
+	BOOST_CHECK_EQUAL(values.size(), 4);
+	BOOST_CHECK_EQUAL(values[3], 4);
+	BOOST_CHECK_EQUAL(bobl::cbor::size(tape, array), 4);
+	BOOST_CHECK_EQUAL(bobl::cbor::at<int>(tape, array, 2), 3);
+	BOOST_CHECK_EQUAL(bobl::cbor::cast<int>(bobl::cbor::at<bobl::flyweight::lite::Any<std::uint8_t const*>>(tape, array, 1)), 2);
+	BOOST_CHECK_THROW(bobl::cbor::at<int>(tape, array, 4), bobl::RangeError);
+
+	auto nested = bobl::cbor::make_iterator_range<bobl::flyweight::lite::Object<std::uint8_t const*>>(tape, object).begin();
+	std::advance(nested, 2);
+	auto b = std::next(bobl::cbor::make_iterator_range<std::string>(tape, *nested).begin());
+	BOOST_CHECK_EQUAL(*b, "text");
+	BOOST_CHECK_THROW(bobl::cbor::make_iterator_range<int>(tape, bobl::flyweight::lite::Array<std::uint8_t const*>{begin, end}), bobl::IncorrectObjectType);
+	BOOST_CHECK_THROW(bobl::cbor::size(tape, bobl::flyweight::lite::Array<std::uint8_t const*>{begin + 2, end}), bobl::InvalidObject);
+}
+
+BOOST_AUTO_TEST_CASE(TapeInvalidTest)
+{
+	std::uint8_t truncated[] = { 0x83, 0x01, 0x02 };
+	BOOST_CHECK_THROW(bobl::cbor::make_tape(truncated, truncated + sizeof(truncated)), bobl::InputToShort);
+	std::uint8_t short_string[] = { 0x82, 0x01, 0x63, 'a', 'b' };
+	BOOST_CHECK_THROW(bobl::cbor::make_tape(short_string, short_string + sizeof(short_string)), bobl::InputToShort);
+	std::uint8_t unexpected_break[] = { 0x82, 0x01, 0xff };
+	BOOST_CHECK_THROW(bobl::cbor::make_tape(unexpected_break, unexpected_break + sizeof(unexpected_break)), bobl::InvalidObject);
+	std::uint8_t missing_break[] = { 0x9f, 0x01, 0x02 };
+	BOOST_CHECK_THROW(bobl::cbor::make_tape(missing_break, missing_break + sizeof(missing_break)), bobl::InputToShort);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
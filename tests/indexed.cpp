@@ -0,0 +1,90 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/bson/indexed.hpp"
+#include "bobl/bson/encode.hpp"
+#include "bobl/bson/decode.hpp"
+#include "bobl/bson/cast.hpp"
+#include "bobl/utility/arena.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/uuid/uuid_io.hpp>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <new>
+#include <cstdint>
+
+
+BOOST_AUTO_TEST_SUITE(BOBL_BSON_Indexed_TestSuite)
+
+BOOST_AUTO_TEST_CASE(TopLevelTest)
+{
+	auto const types = supported_types();
+	auto const data = bobl::bson::encode(types);
+	auto begin = data.data();
+	auto document = bobl::bson::flyweight::Document::decode(begin, begin + data.size());
+	bobl::utility::StaticArena<1024> arena;
+	auto index = bobl::bson::IndexedDocument{ document, arena };
+	BOOST_CHECK_EQUAL(index.size(), 11);
+	auto name = index.find("name");
+	BOOST_REQUIRE(name);
+	BOOST_CHECK_EQUAL(bobl::bson::cast<std::string>(*name), types.name);
+	auto uuid = index.find("uuid");
+	BOOST_REQUIRE(uuid);
+	BOOST_CHECK_EQUAL(bobl::bson::cast<boost::uuids::uuid>(*uuid), types.uuid);
+	BOOST_CHECK(!index.find("simple.name"));
+	BOOST_CHECK(!index.find("nothing"));
+	BOOST_CHECK(!index.find(""));
+
+	auto simple = index.find("simple");
+	BOOST_REQUIRE(simple);
+	auto object = bobl::bson::cast<bobl::flyweight::lite::Object<bobl::bson::flyweight::Iterator>>(*simple);
+	auto nested = bobl::bson::IndexedDocument{ object, arena };
+	BOOST_CHECK_EQUAL(nested.size(), 4);
+	auto id = nested.find("id");
+	BOOST_REQUIRE(id);
+	BOOST_CHECK_EQUAL(bobl::bson::cast<int>(*id), types.simple.id);
+}
+
+BOOST_AUTO_TEST_CASE(RecursiveTest)
+{
+	auto const types = supported_types();
+	auto const data = bobl::bson::encode(types);
+	auto begin = data.data();
+	auto document = bobl::bson::flyweight::Document::decode(begin, begin + data.size());
+	bobl::utility::StaticArena<2048> arena;
+	auto index = bobl::bson::IndexedDocument{ document, arena, bobl::bson::IndexedDocument::Mode::Recursive };
+	BOOST_CHECK_EQUAL(index.size(), 11 + 4 + 3 + 2 + 4 * 2);
+	auto id = index.find("simple.id");
+	BOOST_REQUIRE(id);
+	BOOST_CHECK_EQUAL(bobl::bson::cast<int>(*id), types.simple.id);
+	auto name = index.find("simples.1.name");
+	BOOST_REQUIRE(name);
+	BOOST_CHECK_EQUAL(bobl::bson::cast<std::string>(*name), types.simples[1].name);
+	auto i = index.find("ints.2");
+	BOOST_REQUIRE(i);
+	BOOST_CHECK_EQUAL(bobl::bson::cast<int>(*i), types.ints[2]);
+	BOOST_CHECK(index.find("enabled"));
+	BOOST_CHECK(!index.find("id.simple"));
+	BOOST_CHECK(!index.find("simples.2.name"));
+	BOOST_CHECK(!index.find(".id"));
+}
+
+BOOST_AUTO_TEST_CASE(ArenaTest)
+{
+	auto const data = bobl::bson::encode(supported_types());
+	auto begin = data.data();
+	auto document = bobl::bson::flyweight::Document::decode(begin, begin + data.size());
+	bobl::utility::StaticArena<128> arena;
+	BOOST_CHECK_THROW((bobl::bson::IndexedDocument{ document, arena }), std::bad_alloc);
+	arena.reset();
+	auto simple = Simple{ true, 1, "one", Enum::One };
+	auto small = bobl::bson::encode(simple);
+	begin = small.data();
+	document = bobl::bson::flyweight::Document::decode(begin, begin + small.size());
+	auto index = bobl::bson::IndexedDocument{ document, arena };
+	BOOST_CHECK_EQUAL(index.size(), 4);
+	BOOST_CHECK(arena.used() <= arena.capacity());
+	BOOST_CHECK(index.find("theEnum"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+#include <boost/test/unit_test.hpp>
+#include "bobl/utility/intern.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/cbor/decode.hpp"
+#include "bobl/bson/encode.hpp"
+#include "bobl/bson/decode.hpp"
+#include <boost/fusion/include/adapt_struct.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace {
+
+struct Quote
+{
+	bobl::utility::InternedString symbol;
+	bobl::utility::InternedString venue;
+	int price;
+};
+
+struct RawQuote
+{
+	std::string symbol;
+	std::string venue;
+	int price;
+};
+
+} /*namespace*/
+
+BOOST_FUSION_ADAPT_STRUCT(
+	Quote,
+	symbol,
+	venue,
+	price)
+
+BOOST_FUSION_ADAPT_STRUCT(
+	RawQuote,
+	symbol,
+	venue,
+	price)
+
+BOOST_AUTO_TEST_SUITE(BOBL_Intern_TestSuite)
+
+BOOST_AUTO_TEST_CASE(InternPoolTest)
+{
+	bobl::utility::InternPool pool;
+	auto x = pool.intern("EURUSD");
+	auto y = pool.intern(std::string{ "EUR" } + "USD");
+	BOOST_CHECK(x.data() == y.data());
+	BOOST_CHECK(x == y);
+	BOOST_CHECK_EQUAL(x.str(), "EURUSD");
+	BOOST_CHECK(pool.intern("GBPUSD") != x);
+	BOOST_CHECK_EQUAL(pool.size(), 2);
+	BOOST_CHECK(pool.intern("").empty());
+	BOOST_CHECK(pool.intern("") == bobl::utility::InternedString{});
+	BOOST_CHECK_EQUAL(pool.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(InternPoolEvictionTest)
+{
+	bobl::utility::InternPool pool{ 4, 1 };
+	auto kept = pool.intern("kept");
+	for (auto i = 0; i != 100; ++i)
+		pool.intern(std::to_string(i));
+	BOOST_CHECK_LE(pool.size(), pool.capacity());
+	// string in use is never evicted, so it is still unique
+	BOOST_CHECK(pool.intern("kept").data() == kept.data());
+	auto held = std::vector<bobl::utility::InternedString>{};
+	for (auto i = 0; i != 10; ++i)
+		held.push_back(pool.intern(std::to_string(i)));
+	BOOST_CHECK_EQUAL(pool.size(), pool.capacity());
+	// too many strings in use to pool one more, it is still equal by value
+	auto extra = pool.intern("9");
+	BOOST_CHECK(extra == held.back());
+	BOOST_CHECK(!(extra != held.back()));
+	held.clear();
+	pool.shrink();
+	BOOST_CHECK_EQUAL(pool.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(InternPoolThreadsTest)
+{
+	bobl::utility::InternPool pool;
+	auto interned = std::vector<std::vector<bobl::utility::InternedString>>(4);
+	auto threads = std::vector<std::thread>{};
+	for (auto& strings : interned)
+	{
+		threads.emplace_back([&pool, &strings]()
+		{
+			for (auto i = 0; i != 1000; ++i)
+				strings.push_back(pool.intern(std::to_string(i % 50)));
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	BOOST_CHECK_EQUAL(pool.size(), 50);
+	for (auto const& strings : interned)
+	{
+		for (std::size_t i = 0; i != strings.size(); ++i)
+			BOOST_CHECK(strings[i].data() == interned.front()[i].data());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(CborInternedStringTest)
+{
+	auto const data = bobl::cbor::encode(RawQuote{ "EURUSD", "LMAX", 1 });
+	auto begin = data.data();
+	auto x = bobl::cbor::decode<Quote>(begin, data.data() + data.size());
+	BOOST_CHECK(begin == data.data() + data.size());
+	BOOST_CHECK_EQUAL(x.symbol, bobl::utility::intern("EURUSD"));
+	BOOST_CHECK_EQUAL(x.venue.str(), "LMAX");
+	BOOST_CHECK_EQUAL(x.price, 1);
+	begin = data.data();
+	auto y = bobl::cbor::decode<Quote>(begin, data.data() + data.size());
+	BOOST_CHECK(x.symbol.data() == y.symbol.data());
+	BOOST_CHECK(bobl::cbor::encode(x) == data);
+}
+
+BOOST_AUTO_TEST_CASE(BsonInternedStringTest)
+{
+	auto const data = bobl::bson::encode(RawQuote{ "EURUSD", "", 1 });
+	auto begin = data.data();
+	auto x = bobl::bson::decode<Quote>(begin, data.data() + data.size());
+	BOOST_CHECK(begin == data.data() + data.size());
+	BOOST_CHECK_EQUAL(x.symbol.str(), "EURUSD");
+	BOOST_CHECK(x.venue.empty());
+	begin = data.data();
+	auto y = bobl::bson::decode<Quote>(begin, data.data() + data.size());
+	BOOST_CHECK(x.symbol.data() == y.symbol.data());
+	BOOST_CHECK(bobl::bson::encode(x) == data);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
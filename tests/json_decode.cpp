@@ -0,0 +1,101 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/json/lines.hpp"
+#include "bobl/json/decode.hpp"
+#include "bobl/bobl.hpp"
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <cstdint>
+
+namespace {
+
+struct Record
+{
+	int id;
+	std::string name;
+};
+
+} // namespace
+
+BOOST_FUSION_ADAPT_STRUCT(
+	Record,
+	id,
+	name)
+
+BOOST_AUTO_TEST_SUITE(BOBL_JSON_TestSuite)
+
+BOOST_AUTO_TEST_CASE(DecodeSimpleTest)
+{
+	auto const json = std::string{ R"({"enabled" : true, "id" : 100, "name" : "the name", "theEnum" : 2})" };
+	auto begin = json.data();
+	auto simple = bobl::json::decode<Simple>(begin, json.data() + json.size());
+	BOOST_CHECK_EQUAL(simple.enabled, true);
+	BOOST_CHECK_EQUAL(simple.id, 100);
+	BOOST_CHECK_EQUAL(simple.name, "the name");
+	BOOST_CHECK_EQUAL(simple.theEnum, Two);
+	BOOST_CHECK(begin == json.data() + json.size());
+}
+
+std::string make_lines(std::size_t n)
+{
+	auto out = std::ostringstream{};
+	for (std::size_t i = 0; i != n; ++i)
+	{
+		out << R"({"id" : )" << i << R"(, "name" : "record )" << i << "\"}" << (i % 3 == 0 ? "\r\n" : "\n");
+		if (i % 10 == 0)
+			out << "  \n";
+	}
+	return out.str();
+}
+
+BOOST_AUTO_TEST_CASE(LinesOrderedTest)
+{
+	auto const n = 1000;
+	auto const lines = make_lines(n);
+	auto records = bobl::json::decode_lines<Record>(lines.data(), lines.data() + lines.size(), 4);
+	BOOST_REQUIRE_EQUAL(records.size(), n);
+	for (auto i = 0; i != n; ++i)
+	{
+		BOOST_CHECK_EQUAL(records[i].id, i);
+		BOOST_CHECK_EQUAL(records[i].name, "record " + std::to_string(i));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(LinesUnorderedTest)
+{
+	auto const n = 3000;
+	auto const lines = make_lines(n) + R"({"id" : 3000, "name" : "no newline"})";
+	auto records = std::map<std::size_t, int>{};
+	auto count = bobl::json::decode_lines<Record>(lines.data(), lines.data() + lines.size(), [&records](std::size_t index, Record&& record)
+	{
+		records.emplace(index, record.id);
+	}, bobl::json::Order::Unordered, 3);
+	BOOST_CHECK_EQUAL(count, n + 1);
+	BOOST_REQUIRE_EQUAL(records.size(), n + 1);
+	for (auto const& record : records)
+		BOOST_CHECK_EQUAL(int(record.first), record.second);
+}
+
+BOOST_AUTO_TEST_CASE(LinesStreamTest)
+{
+	auto const n = 500;
+	auto in = std::istringstream{ make_lines(n) };
+	auto ids = std::vector<int>{};
+	// chunk is smaller than a record, so records span chunks and buffer has to grow
+	auto count = bobl::json::decode_lines<Record>(in, [&ids](std::size_t, Record&& record) { ids.push_back(record.id); }, bobl::json::Order::Ordered, 2, 7);
+	BOOST_CHECK_EQUAL(count, n);
+	BOOST_REQUIRE_EQUAL(ids.size(), n);
+	for (auto i = 0; i != n; ++i)
+		BOOST_CHECK_EQUAL(ids[i], i);
+}
+
+BOOST_AUTO_TEST_CASE(LinesInvalidTest)
+{
+	auto const lines = make_lines(100) + "{\"id\" : 1, \"name\" : \"x\"} garbage\n" + make_lines(100);
+	BOOST_CHECK_THROW(bobl::json::decode_lines<Record>(lines.data(), lines.data() + lines.size(), 2), bobl::InvalidObject);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
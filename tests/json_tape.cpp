@@ -0,0 +1,80 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/json/tape.hpp"
+#include "bobl/json/iterator.hpp"
+#include "bobl/json/cast.hpp"
+#include "bobl/bobl.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+BOOST_AUTO_TEST_SUITE(BOBL_JSON_Tape_TestSuite)
+
+BOOST_AUTO_TEST_CASE(TapeStructureTest)
+{
+	auto const json = std::string{ R"( {"name" : "a \"quoted\" {name}", "array" : [1, [2, 3], {"x" : null}], "empty" : {}, "last" : true } )" };
+	auto tape = bobl::json::make_tape(json.data(), json.data() + json.size());
+	// object, 4 names, string, array, 1, [2, 3], 2, 3, {"x" : null}, "x", null, {}, true
+	BOOST_CHECK_EQUAL(tape.size(), 16);
+	BOOST_CHECK_EQUAL(tape.children(0), 8);
+	BOOST_CHECK_EQUAL(tape.next(0), tape.size());
+	auto array = tape.child(0, 3);
+	BOOST_CHECK_EQUAL(std::string(tape.begin(array), tape.end(array)), R"([1, [2, 3], {"x" : null}])");
+	BOOST_CHECK_EQUAL(tape.children(array), 3);
+	BOOST_CHECK_EQUAL(tape.next(array), tape.child(0, 4));
+	auto nested = tape.child(array, 1);
+	BOOST_CHECK_EQUAL(std::string(tape.begin(nested), tape.end(nested)), "[2, 3]");
+	BOOST_CHECK_EQUAL(tape.next(nested), tape.child(array, 2));
+	auto name = tape.child(0, 1);
+	BOOST_CHECK_EQUAL(std::string(tape.begin(name), tape.end(name)), R"("a \"quoted\" {name}")");
+	auto empty = tape.child(0, 5);
+	BOOST_CHECK_EQUAL(tape.children(empty), 0);
+	BOOST_CHECK_EQUAL(std::string(tape.begin(empty), tape.end(empty)), "{}");
+}
+
+BOOST_AUTO_TEST_CASE(TapeIteratorTest)
+{
+	auto const json = std::string{ R"({"id" : 7, "values" : [1, 2, 3, 4], "nested" : {"a" : [5, 6], "b" : "text"}})" };
+	char const* begin = json.data();
+	char const* end = begin + json.size();
+	auto tape = bobl::json::make_tape(begin, end);
+	auto object = tape.as<bobl::flyweight::lite::Object<char const*>>(0);
+	auto names = std::vector<std::string>{};
+	for (auto const& nv : bobl::json::make_iterator_range<bobl::flyweight::NameValue<bobl::flyweight::lite::Any<char const*>>>(tape, object))
+		names.push_back(nv.name());
+	BOOST_CHECK_EQUAL(names.size(), 3);
+	BOOST_CHECK_EQUAL(names[0], "id");
+	BOOST_CHECK_EQUAL(names[1], "values");
+	BOOST_CHECK_EQUAL(names[2], "nested");
+
+	auto range = bobl::json::make_iterator_range<bobl::flyweight::NameValue<bobl::flyweight::lite::Array<char const*>>>(tape, object);
+	auto i = std::next(range.begin());
+	auto values = std::vector<int>{};
+	for (auto value : bobl::json::make_iterator_range<int>(tape, i->value()))
+		values.push_back(value);
+	BOOST_CHECK_EQUAL(values.size(), 4);
+	BOOST_CHECK_EQUAL(values[3], 4);
+
+	auto nested = bobl::json::make_iterator_range<bobl::flyweight::lite::Object<char const*>>(tape, object).begin();
+	std::advance(nested, 2);
+	auto b = std::next(bobl::json::make_iterator_range<std::string>(tape, *nested).begin());
+	BOOST_CHECK_EQUAL(*b, "text");
+	BOOST_CHECK_THROW(bobl::json::make_iterator_range<int>(tape, bobl::flyweight::lite::Array<char const*>{begin, end}), bobl::IncorrectObjectType);
+}
+
+BOOST_AUTO_TEST_CASE(TapeInvalidTest)
+{
+	auto const unbalanced = std::string{ R"({"a" : [1, 2})" };
+	BOOST_CHECK_THROW(bobl::json::make_tape(unbalanced.data(), unbalanced.data() + unbalanced.size()), bobl::InvalidObject);
+	auto const incomplete = std::string{ R"({"a" : [1, 2])" };
+	BOOST_CHECK_THROW(bobl::json::make_tape(incomplete.data(), incomplete.data() + incomplete.size()), bobl::InputToShort);
+	auto const trailing = std::string{ R"([1, 2] 3)" };
+	BOOST_CHECK_THROW(bobl::json::make_tape(trailing.data(), trailing.data() + trailing.size()), bobl::InvalidObject);
+	auto const no_colon = std::string{ R"({"a" 1})" };
+	BOOST_CHECK_THROW(bobl::json::make_tape(no_colon.data(), no_colon.data() + no_colon.size()), bobl::InvalidObject);
+	auto const comma = std::string{ R"([1, ])" };
+	BOOST_CHECK_THROW(bobl::json::make_tape(comma.data(), comma.data() + comma.size()), bobl::InvalidObject);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,155 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/utility/profile.hpp"
+#include "bobl/utility/type_name.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/cbor/decode.hpp"
+#include "bobl/bson/encode.hpp"
+#include "bobl/bson/decode.hpp"
+#include "bobl/bson/cast.hpp"
+#include "bobl/json/decode.hpp"
+#include <boost/fusion/include/adapt_struct.hpp>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// built as a separate test with BOBL_ENABLE_PROFILE defined
+
+namespace {
+
+struct Profiled
+{
+	std::string text;
+	int number;
+	std::vector<int> ints;
+};
+
+} /*namespace*/
+
+BOOST_FUSION_ADAPT_STRUCT(
+	Profiled,
+	text,
+	number,
+	ints)
+
+BOOST_AUTO_TEST_SUITE(BOBL_Profile_TestSuite)
+
+template<typename T>
+bobl::profile::Summary const* find(std::vector<bobl::profile::Summary> const& summaries, bobl::profile::Operation operation)
+{
+	auto type = bobl::utility::type_name<T>();
+	auto i = std::find_if(summaries.begin(), summaries.end(), [&type, operation](bobl::profile::Summary const& summary) { return summary.type == type && summary.operation == operation; });
+	return i == summaries.end() ? nullptr : &*i;
+}
+
+void check(bobl::profile::Summary const* summary, std::uint64_t count)
+{
+	BOOST_REQUIRE(summary != nullptr);
+	BOOST_CHECK_EQUAL(summary->count, count);
+	BOOST_CHECK_LE(summary->p50, summary->p90);
+	BOOST_CHECK_LE(summary->p90, summary->p99);
+	BOOST_CHECK_LE(summary->p99, summary->max);
+}
+
+BOOST_AUTO_TEST_CASE(CborProfileTest)
+{
+	BOOST_CHECK(bobl::profile::enabled);
+	bobl::profile::sample_rate(1);
+	bobl::profile::reset();
+	auto const value = Profiled{ "text", 7, { 1, 2, 3 } };
+	auto const data = bobl::cbor::encode(value);
+	auto begin = data.data();
+	auto res = bobl::cbor::decode<Profiled>(begin, data.data() + data.size());
+	BOOST_CHECK_EQUAL(res.number, 7);
+	auto summaries = bobl::profile::snapshot();
+	using bobl::profile::Operation;
+	check(find<Profiled>(summaries, Operation::Decode), 1);
+	check(find<std::string>(summaries, Operation::Decode), 1);
+	check(find<int>(summaries, Operation::Decode), 1);
+	check(find<std::vector<int>>(summaries, Operation::Decode), 1);
+	check(find<Profiled>(summaries, Operation::Encode), 1);
+	// number and array elements
+	check(find<int>(summaries, Operation::Encode), 4);
+	bobl::profile::reset();
+	BOOST_CHECK(bobl::profile::snapshot().empty());
+}
+
+BOOST_AUTO_TEST_CASE(BsonProfileTest)
+{
+	bobl::profile::sample_rate(1);
+	bobl::profile::reset();
+	auto const value = Profiled{ "text", 7, { 1, 2, 3 } };
+	auto const data = bobl::bson::encode(value);
+	auto begin = data.data();
+	auto res = bobl::bson::decode<Profiled>(begin, data.data() + data.size());
+	BOOST_CHECK_EQUAL(res.text, "text");
+	auto summaries = bobl::profile::snapshot();
+	using bobl::profile::Operation;
+	check(find<Profiled>(summaries, Operation::Decode), 1);
+	check(find<std::vector<int>>(summaries, Operation::Decode), 1);
+	check(find<Profiled>(summaries, Operation::Encode), 1);
+	check(find<std::string>(summaries, Operation::Encode), 1);
+}
+
+BOOST_AUTO_TEST_CASE(JsonProfileTest)
+{
+	bobl::profile::sample_rate(1);
+	bobl::profile::reset();
+	auto const data = std::string{ R"({"text":"abc","number":1,"ints":[1,2]})" };
+	auto begin = data.begin();
+	bobl::json::decode<Profiled>(begin, data.end());
+	bobl::json::decode<Profiled>(begin = data.begin(), data.end());
+	auto summaries = bobl::profile::snapshot();
+	check(find<Profiled>(summaries, bobl::profile::Operation::Decode), 2);
+	check(find<int>(summaries, bobl::profile::Operation::Decode), 2);
+	std::ostringstream json;
+	bobl::profile::report_json(json, summaries);
+	BOOST_CHECK_NE(json.str().find("\"type\": \"int\", \"operation\": \"decode\", \"samples\": 2"), std::string::npos);
+	std::ostringstream text;
+	bobl::profile::report_text(text, summaries);
+	BOOST_CHECK_NE(text.str().find(bobl::utility::type_name<Profiled>()), std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(SamplingProfileTest)
+{
+	auto const data = bobl::cbor::encode(Profiled{ "text", 7, { 1, 2, 3 } });
+	bobl::profile::sample_rate(4);
+	bobl::profile::reset();
+	for (auto i = 0; i != 16; ++i)
+	{
+		auto begin = data.data();
+		bobl::cbor::decode<Profiled>(begin, data.data() + data.size());
+	}
+	auto total = std::uint64_t{ 0 };
+	for (auto const& summary : bobl::profile::snapshot())
+		total += summary.count;
+	// 4 probes (document and 3 members) per decode
+	BOOST_CHECK_EQUAL(total, 16 * 4 / 4);
+	bobl::profile::sample_rate(1);
+}
+
+BOOST_AUTO_TEST_CASE(HistogramTest)
+{
+	using bobl::profile::Histogram;
+	auto const size = Histogram::Size;
+	for (auto value : { std::uint64_t{ 0 }, std::uint64_t{ 3 }, std::uint64_t{ 4 }, std::uint64_t{ 7 }, std::uint64_t{ 8 }, std::uint64_t{ 1000 }, std::uint64_t{ 123456789 }, ~std::uint64_t{ 0 } })
+	{
+		auto bucket = Histogram::bucket(value);
+		BOOST_CHECK_LT(bucket, size);
+		BOOST_CHECK_LE(value, Histogram::upper_bound(bucket));
+		if (bucket != 0)
+			BOOST_CHECK_GT(value, Histogram::upper_bound(bucket - 1));
+	}
+	BOOST_CHECK_EQUAL(Histogram::bucket(~std::uint64_t{ 0 }), size - 1);
+	Histogram histogram;
+	histogram.record(5);
+	histogram.record(100);
+	BOOST_CHECK_EQUAL(histogram.count(), 2);
+	BOOST_CHECK_EQUAL(histogram.sum(), 105);
+	BOOST_CHECK_EQUAL(histogram.max(), 100);
+	BOOST_CHECK_EQUAL(histogram.bucket_count(Histogram::bucket(100)), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
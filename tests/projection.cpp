@@ -0,0 +1,78 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/bson/projection.hpp"
+#include "bobl/bson/encode.hpp"
+#include "bobl/cbor/projection.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/uuid/uuid_io.hpp>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <chrono>
+#include <cstdint>
+
+
+BOOST_AUTO_TEST_SUITE(BOBL_Projection_TestSuite)
+
+BOOST_AUTO_TEST_CASE(BsonPathTest)
+{
+	auto const types = supported_types();
+	auto const data = bobl::bson::encode(types);
+	auto begin = data.data();
+	auto end = begin + data.size();
+	auto res = bobl::bson::project<SupportedTypes, bobl::Path<10>, bobl::Path<3, 1>, bobl::Path<3, 2>, bobl::Path<7>>(begin, end);
+	BOOST_CHECK_EQUAL(begin, end);
+	BOOST_CHECK(std::get<0>(res) == types.tp);
+	BOOST_CHECK_EQUAL(std::get<1>(res), types.simple.id);
+	BOOST_CHECK_EQUAL(std::get<2>(res), types.simple.name);
+	BOOST_CHECK_EQUAL(std::get<3>(res), types.uuid);
+}
+
+BOOST_AUTO_TEST_CASE(BsonStringPathTest)
+{
+	auto const types = supported_types();
+	auto const data = bobl::bson::encode(types);
+	auto begin = data.data();
+	auto res = bobl::bson::project<std::string, int, diversion::optional<int>, std::vector<int>, int>(begin, begin + data.size(), 
+											{ "simples.1.name", "simple.id", "simple.nothing", "ints", "ints.2" });
+	BOOST_CHECK_EQUAL(std::get<0>(res), types.simples[1].name);
+	BOOST_CHECK_EQUAL(std::get<1>(res), types.simple.id);
+	BOOST_CHECK(!std::get<2>(res));
+	BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(std::get<3>(res)), std::end(std::get<3>(res)), std::begin(types.ints), std::end(types.ints));
+	BOOST_CHECK_EQUAL(std::get<4>(res), types.ints[2]);
+	begin = data.data();
+	BOOST_CHECK_THROW(bobl::bson::project<int>(begin, begin + data.size(), { "simple.nothing" }), bobl::InvalidObject);
+}
+
+BOOST_AUTO_TEST_CASE(CborPathTest)
+{
+	auto const types = supported_types();
+	auto const data = bobl::cbor::encode(types);
+	auto begin = data.data();
+	auto end = begin + data.size();
+	auto res = bobl::cbor::project<SupportedTypes, bobl::Path<10>, bobl::Path<3, 1>, bobl::Path<3, 2>, bobl::Path<7>>(begin, end);
+	BOOST_CHECK(std::get<0>(res) == types.tp);
+	BOOST_CHECK_EQUAL(std::get<1>(res), types.simple.id);
+	BOOST_CHECK_EQUAL(std::get<2>(res), types.simple.name);
+	BOOST_CHECK_EQUAL(std::get<3>(res), types.uuid);
+}
+
+BOOST_AUTO_TEST_CASE(CborStringPathTest)
+{
+	auto const types = supported_types();
+	auto const data = bobl::cbor::encode(types);
+	auto begin = data.data();
+	auto end = begin + data.size();
+	auto res = bobl::cbor::project<std::string, int, diversion::optional<int>, std::vector<int>, int, bool>(begin, end,
+											{ "simples.1.name", "simple.id", "simple.nothing", "ints", "ints.2", "enabled" });
+	BOOST_CHECK_EQUAL(std::get<0>(res), types.simples[1].name);
+	BOOST_CHECK_EQUAL(std::get<1>(res), types.simple.id);
+	BOOST_CHECK(!std::get<2>(res));
+	BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(std::get<3>(res)), std::end(std::get<3>(res)), std::begin(types.ints), std::end(types.ints));
+	BOOST_CHECK_EQUAL(std::get<4>(res), types.ints[2]);
+	BOOST_CHECK_EQUAL(std::get<5>(res), types.enabled);
+	BOOST_CHECK_THROW(bobl::cbor::project<int>(begin, end, { "simples.2.id" }), bobl::InvalidObject);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,191 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/utility/stats.hpp"
+#include "bobl/utility/type_name.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/cbor/decode.hpp"
+#include "bobl/bson/encode.hpp"
+#include "bobl/bson/decode.hpp"
+#include "bobl/bson/cast.hpp"
+#include "bobl/json/decode.hpp"
+#include "bobl/utility/diversion.hpp"
+#include <boost/fusion/include/adapt_struct.hpp>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+// built as a separate test with BOBL_ENABLE_STATS defined
+BOBL_STATS_COUNT_ALLOCATIONS()
+
+namespace {
+
+using Milliseconds = std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds>;
+
+struct Encoded
+{
+	std::string text;
+	int number;
+	std::vector<int> ints;
+	int last;
+	std::string extra;
+};
+
+// text and number are probed, the first alternative of both fails to decode and is caught internally
+struct Probed
+{
+	diversion::variant<Simple, std::string> text;
+	diversion::variant<Milliseconds, int> number;
+	std::vector<int> ints;
+	int last;
+};
+
+// JSON has no time points
+struct ProbedText
+{
+	diversion::variant<Simple, std::string> text;
+	std::vector<int> ints;
+	int last;
+};
+
+} /*namespace*/
+
+BOOST_FUSION_ADAPT_STRUCT(
+	Encoded,
+	text,
+	number,
+	ints,
+	last,
+	extra)
+
+BOOST_FUSION_ADAPT_STRUCT(
+	Probed,
+	text,
+	number,
+	ints,
+	last)
+
+BOOST_FUSION_ADAPT_STRUCT(
+	ProbedText,
+	text,
+	ints,
+	last)
+
+BOOST_AUTO_TEST_SUITE(BOBL_Stats_TestSuite)
+
+Encoded encoded()
+{
+	return Encoded{ std::string(64, 't'), 7, { 1, 2, 3 }, 100, std::string(32, 'x') };
+}
+
+template<typename T>
+std::uint64_t elements(bobl::stats::Snapshot const& stats)
+{
+	auto i = stats.types.find(bobl::utility::type_name<T>());
+	return i == stats.types.end() ? 0 : i->second;
+}
+
+void check(bobl::stats::Snapshot const& stats, Probed const& value)
+{
+	BOOST_CHECK_EQUAL(diversion::get<std::string>(value.text), std::string(64, 't'));
+	BOOST_CHECK_EQUAL(diversion::get<int>(value.number), 7);
+	BOOST_CHECK_EQUAL(value.last, 100);
+	BOOST_CHECK_EQUAL(stats.exceptions, 2);
+	// 4 members and 3 array elements
+	BOOST_CHECK_EQUAL(stats.elements, 7);
+	BOOST_CHECK_EQUAL(elements<int>(stats), 4);
+	BOOST_CHECK_EQUAL(elements<std::vector<int>>(stats), 1);
+	BOOST_CHECK_EQUAL((elements<diversion::variant<Milliseconds, int>>(stats)), 1);
+	BOOST_CHECK_GT(stats.allocations, 0);
+	BOOST_CHECK_GE(stats.allocated_bytes, 64);
+}
+
+BOOST_AUTO_TEST_CASE(CborStatsTest)
+{
+	BOOST_CHECK(bobl::stats::enabled);
+	auto const data = bobl::cbor::encode(encoded());
+	auto before = bobl::stats::snapshot();
+	auto begin = data.data();
+	auto value = bobl::cbor::decode<Probed>(begin, data.data() + data.size());
+	auto stats = bobl::stats::snapshot() - before;
+	check(stats, value);
+	BOOST_CHECK_EQUAL(stats.bytes_scanned, data.size());
+	// "extra" member isn't a part of Probed
+	BOOST_CHECK_EQUAL(stats.bytes_skipped, 1 + 5 + 2 + 32);
+}
+
+BOOST_AUTO_TEST_CASE(CborDictionaryStatsTest)
+{
+	auto const data = bobl::cbor::encode(encoded());
+	auto before = bobl::stats::snapshot();
+	auto begin = data.data();
+	auto value = bobl::cbor::decode<Probed, bobl::Options<bobl::options::StructAsDictionary>>(begin, data.data() + data.size());
+	auto stats = bobl::stats::snapshot() - before;
+	check(stats, value);
+	BOOST_CHECK_EQUAL(stats.bytes_scanned, data.size());
+	// key is decoded before it is known to be unexpected, only the value is skipped
+	BOOST_CHECK_EQUAL(stats.bytes_skipped, 2 + 32);
+}
+
+BOOST_AUTO_TEST_CASE(BsonStatsTest)
+{
+	auto const data = bobl::bson::encode(encoded());
+	auto before = bobl::stats::snapshot();
+	auto begin = data.data();
+	auto value = bobl::bson::decode<Probed>(begin, data.data() + data.size());
+	auto stats = bobl::stats::snapshot() - before;
+	BOOST_CHECK_EQUAL(diversion::get<std::string>(value.text), std::string(64, 't'));
+	BOOST_CHECK_EQUAL(stats.bytes_scanned, data.size());
+	BOOST_CHECK_EQUAL(stats.bytes_skipped, 1 + 6 + 4 + 33);
+	BOOST_CHECK_EQUAL(stats.elements, 7);
+	BOOST_CHECK_EQUAL(elements<int>(stats), 4);
+	// BSON time point is checked by its type, only Simple probing throws
+	BOOST_CHECK_EQUAL(stats.exceptions, 1);
+}
+
+BOOST_AUTO_TEST_CASE(JsonStatsTest)
+{
+	auto const data = std::string{ R"({"text":"abc","ints":[1,2],"last":3})" };
+	auto before = bobl::stats::snapshot();
+	auto begin = data.begin();
+	auto value = bobl::json::decode<ProbedText>(begin, data.end());
+	auto stats = bobl::stats::snapshot() - before;
+	BOOST_CHECK_EQUAL(value.last, 3);
+	BOOST_CHECK_EQUAL(stats.bytes_scanned, data.size());
+	BOOST_CHECK_EQUAL(stats.elements, 5);
+	BOOST_CHECK_EQUAL(elements<int>(stats), 3);
+	BOOST_CHECK_EQUAL(stats.exceptions, 1);
+}
+
+BOOST_AUTO_TEST_CASE(PerThreadStatsTest)
+{
+	auto const data = bobl::cbor::encode(encoded());
+	auto before = bobl::stats::snapshot();
+	auto stats = bobl::stats::Snapshot{};
+	std::thread{ [&data, &stats]()
+	{
+		auto begin = data.data();
+		bobl::cbor::decode<Probed>(begin, data.data() + data.size());
+		stats = bobl::stats::snapshot();
+	} }.join();
+	BOOST_CHECK_EQUAL(stats.elements, 7);
+	BOOST_CHECK_EQUAL(stats.bytes_scanned, data.size());
+	auto after = bobl::stats::snapshot() - before;
+	BOOST_CHECK_EQUAL(after.elements, 0);
+	BOOST_CHECK_EQUAL(after.bytes_scanned, 0);
+	BOOST_CHECK_EQUAL(after.exceptions, 0);
+}
+
+BOOST_AUTO_TEST_CASE(AllocatorStatsTest)
+{
+	auto before = bobl::stats::snapshot();
+	auto values = std::vector<std::int64_t, bobl::stats::Allocator<std::int64_t>>{};
+	values.reserve(100);
+	auto stats = bobl::stats::snapshot() - before;
+	// counted by the allocator and by operator new it calls
+	BOOST_CHECK_EQUAL(stats.allocations, 2);
+	BOOST_CHECK_EQUAL(stats.allocated_bytes, 2 * 100 * sizeof(std::int64_t));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,150 @@
+#include <boost/test/unit_test.hpp>
+#include "bobl/cbor/encode.hpp"
+#include "bobl/cbor/decode.hpp"
+#include "bobl/utility/intern.hpp"
+#include "bobl/utility/diversion.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/fusion/include/adapt_struct.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace {
+
+struct Trade
+{
+	std::string symbol;
+	std::string venue;
+	int price;
+	std::vector<std::uint8_t> flags;
+};
+
+bool operator==(Trade const& x, Trade const& y) { return x.symbol == y.symbol && x.venue == y.venue && x.price == y.price && x.flags == y.flags; }
+
+struct TradePrice
+{
+	std::string symbol;
+	int price;
+};
+
+std::vector<Trade> trades(std::size_t n)
+{
+	static char const* const symbols[] = { "EURUSD", "GBPUSD", "USDJPY", "AUDUSD" };
+	auto res = std::vector<Trade>{};
+	for (std::size_t i = 0; i != n; ++i)
+		res.push_back(Trade{ symbols[i % 4], i % 3 == 0 ? "LMAX" : "EBS", int(i), { 1, 2, 3 } });
+	return res;
+}
+
+template<typename T, typename ...Options>
+T decode(std::vector<std::uint8_t> const& data)
+{
+	auto begin = data.data();
+	auto res = bobl::cbor::decode<T, bobl::Options<bobl::options::StringRefs, Options...>>(begin, data.data() + data.size());
+	BOOST_CHECK(begin == data.data() + data.size());
+	return res;
+}
+
+} /*namespace*/
+
+BOOST_FUSION_ADAPT_STRUCT(
+	Trade,
+	symbol,
+	venue,
+	price,
+	flags)
+
+BOOST_FUSION_ADAPT_STRUCT(
+	TradePrice,
+	symbol,
+	price)
+
+BOOST_AUTO_TEST_SUITE(BOBL_StringRef_TestSuite)
+
+BOOST_AUTO_TEST_CASE(StringRefsEncodeTest)
+{
+	auto const value = std::vector<std::string>{ "abc", "abc", "ab", "ab", "abcd", "abcd" };
+	auto const data = bobl::cbor::encode<bobl::options::StringRefs>(value);
+	auto const expected = std::vector<std::uint8_t>{ 0xd9, 0x01, 0x00, 0x86, 0x63, 'a', 'b', 'c', 0xd8, 0x19, 0x00, 0x62, 'a', 'b', 0x62, 'a', 'b',
+														0x64, 'a', 'b', 'c', 'd', 0xd8, 0x19, 0x01 };
+	BOOST_CHECK_EQUAL_COLLECTIONS(data.begin(), data.end(), expected.begin(), expected.end());
+	BOOST_CHECK(decode<std::vector<std::string>>(data) == value);
+	// strings not in namespace are left as they are
+	auto const plain = bobl::cbor::encode(value);
+	BOOST_CHECK(decode<std::vector<std::string>>(plain) == value);
+	// references are resolved only if decoding is asked to
+	auto begin = data.data();
+	BOOST_CHECK_THROW(bobl::cbor::decode<std::vector<std::string>>(begin, data.data() + data.size()), bobl::IncorrectObjectType);
+	static_assert(bobl::cbor::decoder::details::Handler<std::string, bobl::options::None>::is(bobl::cbor::Type(0x60)), "string type check is expected to be constexpr");
+}
+
+BOOST_AUTO_TEST_CASE(StringRefsNumberingTest)
+{
+	// example of stringref specification, strings shorter than reference to them aren't numbered
+	auto const value = std::vector<std::string>{ "1", "222", "333", "4", "555", "666", "777", "888", "999", "aaa", "bbb", "ccc", "ddd", "eee", "fff", "ggg",
+												"hhh", "iii", "jjj", "kkk", "lll", "mmm", "nnn", "ooo", "ppp", "qqq", "rrr", "333", "ssss", "qqq", "rrr", "ssss" };
+	auto const data = bobl::cbor::encode<bobl::options::StringRefs>(value);
+	auto const tail = std::vector<std::uint8_t>{ 0xd8, 0x19, 0x01, 0x64, 's', 's', 's', 's', 0xd8, 0x19, 0x17, 0x63, 'r', 'r', 'r', 0xd8, 0x19, 0x18, 0x18 };
+	BOOST_REQUIRE_GT(data.size(), tail.size());
+	BOOST_CHECK_EQUAL_COLLECTIONS(data.end() - tail.size(), data.end(), tail.begin(), tail.end());
+	BOOST_CHECK(decode<std::vector<std::string>>(data) == value);
+}
+
+BOOST_AUTO_TEST_CASE(StringRefsRecordsTest)
+{
+	auto const value = trades(1000);
+	auto const plain = bobl::cbor::encode(value);
+	auto const data = bobl::cbor::encode<bobl::options::StringRefs>(value);
+	BOOST_CHECK_LT(data.size() * 3, plain.size() * 2);
+	BOOST_CHECK(decode<std::vector<Trade>>(data) == value);
+	// skipped members are numbered too
+	auto const prices = decode<std::vector<TradePrice>, bobl::options::StructAsDictionary>(data);
+	BOOST_REQUIRE_EQUAL(prices.size(), value.size());
+	BOOST_CHECK_EQUAL(prices.back().symbol, value.back().symbol);
+	BOOST_CHECK_EQUAL(prices.back().price, value.back().price);
+	// array is encoded on one thread, so strings are numbered the same way
+	BOOST_CHECK((bobl::cbor::encode<bobl::options::StringRefs, bobl::options::ParallelArrays<64>>(value) == data));
+}
+
+BOOST_AUTO_TEST_CASE(StringRefsValuesTest)
+{
+	auto const symbols = std::vector<std::string>{ "EURUSD", "GBPUSD", "EURUSD", "GBPUSD" };
+	auto const interned = decode<std::vector<bobl::utility::InternedString>>(bobl::cbor::encode<bobl::options::StringRefs>(symbols));
+	BOOST_REQUIRE_EQUAL(interned.size(), symbols.size());
+	BOOST_CHECK_EQUAL(interned[2].str(), "EURUSD");
+	BOOST_CHECK(interned[0].data() == interned[2].data());
+
+	using Variant = diversion::variant<int, std::string>;
+	auto const variants = std::vector<Variant>{ std::string{ "abc" }, 1, std::string{ "abc" } };
+	BOOST_CHECK(decode<std::vector<Variant>>(bobl::cbor::encode<bobl::options::StringRefs>(variants)) == variants);
+
+	auto id = boost::uuids::uuid{};
+	for (std::size_t i = 0; i != id.size(); ++i)
+		id.data[i] = std::uint8_t(i);
+	auto const ids = std::vector<boost::uuids::uuid>{ id, id };
+	auto const data = bobl::cbor::encode<bobl::options::StringRefs>(ids);
+	BOOST_CHECK_EQUAL(data.size(), 3 + 1 + 2 + 1 + 16 + 2 + 3);
+	BOOST_CHECK(decode<std::vector<boost::uuids::uuid>>(data) == ids);
+}
+
+BOOST_AUTO_TEST_CASE(StringRefsErrorsTest)
+{
+	// there is no string 5
+	auto const missing = std::vector<std::uint8_t>{ 0xd9, 0x01, 0x00, 0xd8, 0x19, 0x05 };
+	BOOST_CHECK_THROW(decode<std::string>(missing), bobl::InvalidObject);
+	// reference out of namespace
+	auto const outside = std::vector<std::uint8_t>{ 0xd8, 0x19, 0x00 };
+	BOOST_CHECK_THROW(decode<std::string>(outside), bobl::IncorrectObjectType);
+	// text string referred as byte string
+	auto const text = bobl::cbor::encode<bobl::options::StringRefs>(Trade{ "abc", "xyz", 1, { 'a', 'b', 'c' } });
+	auto const bytes = bobl::cbor::encode<bobl::options::StringRefs>(Trade{ "abc", "abc", 1, { 'a', 'b', 'c' } });
+	BOOST_CHECK_EQUAL(text.size(), bytes.size() + 1);
+	// "symbol", "abc", "venue", "price", "flags" are numbered before flags
+	auto invalid = bytes;
+	invalid.resize(invalid.size() - 4);
+	invalid.insert(invalid.end(), { 0xd8, 0x19, 0x01 });
+	BOOST_CHECK_THROW(decode<Trade>(invalid), bobl::IncorrectObjectType);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
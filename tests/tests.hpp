@@ -3,12 +3,14 @@
 #include "bobl/names.hpp"
 #include "bobl/bobl.hpp"
 #include <boost/uuid/uuid.hpp>
+#include <boost/uuid/string_generator.hpp>
 #include <boost/fusion/adapted/struct/adapt_struct.hpp>
 #include <boost/fusion/include/adapt_struct.hpp>
 #include <boost/cstdfloat.hpp>
 #include <chrono>
 #include <vector>
 #include <string>
+#include <utility>
 #include <cstdint>
 
 enum Enum
@@ -381,3 +383,46 @@ BOOST_FUSION_ADAPT_STRUCT(
 			binary,
 			tp)
 
+// SupportedTypes filled with every kind of value, time point is whole seconds so it survives any encoding
+inline SupportedTypes supported_types(std::string name = "some name")
+{
+	return SupportedTypes
+			{
+				true,
+				1,
+				std::move(name),
+				{false, 303, "the name", Enum::One },
+				{1,2,3},
+				{
+					{true, 1, "first", Enum::One },
+					{false, 2, "second", Enum::Two },
+				},
+				101,
+				boost::uuids::string_generator{}("4E983010-FA64-4BAA-ABED-DD82FD691D18"),
+				EnumClass::Three,
+				{0x1,0x2, 0x3},
+				std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now())
+			};
+}
+
+
+struct Keyed
+{
+	int price;
+	std::string symbol;
+	diversion::optional<int> size;
+};
+
+BOOST_FUSION_ADAPT_STRUCT(
+	Keyed,
+	price,
+	symbol,
+	size)
+
+namespace bobl{
+
+template<typename MemberType, typename Options> class MemberId <Keyed, MemberType, 0, Options> : public std::integral_constant<std::uint64_t, 10> {};
+template<typename MemberType, typename Options> class MemberId <Keyed, MemberType, 1, Options> : public std::integral_constant<std::uint64_t, 20> {};
+template<typename MemberType, typename Options> class MemberId <Keyed, MemberType, 2, Options> : public std::integral_constant<std::uint64_t, 300> {};
+
+}//namespace bobl
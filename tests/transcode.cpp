@@ -0,0 +1,138 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/transcode.hpp"
+#include "bobl/bson/decode.hpp"
+#include "bobl/bson/encode.hpp"
+#include "bobl/cbor/decode.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/json/decode.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/uuid/uuid_io.hpp>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+
+BOOST_AUTO_TEST_SUITE(BOBL_Transcode_TestSuite)
+
+void check(SupportedTypes const& res, SupportedTypes const& types)
+{
+	BOOST_CHECK_EQUAL(res.enabled, types.enabled);
+	BOOST_CHECK_EQUAL(res.id, types.id);
+	BOOST_CHECK_EQUAL(res.name, types.name);
+	BOOST_CHECK_EQUAL(res.simple.id, types.simple.id);
+	BOOST_CHECK_EQUAL(res.simple.name, types.simple.name);
+	BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(res.ints), std::end(res.ints), std::begin(types.ints), std::end(types.ints));
+	BOOST_REQUIRE_EQUAL(res.simples.size(), types.simples.size());
+	BOOST_CHECK_EQUAL(res.simples[1].name, types.simples[1].name);
+	BOOST_CHECK_EQUAL(diversion::get<int>(res.var), 101);
+	BOOST_CHECK_EQUAL(res.uuid, types.uuid);
+	BOOST_CHECK(res.enm == types.enm);
+	BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(res.binary), std::end(res.binary), std::begin(types.binary), std::end(types.binary));
+	BOOST_CHECK(res.tp == types.tp);
+}
+
+BOOST_AUTO_TEST_CASE(BsonToCborTest)
+{
+	auto const types = supported_types("some \"name\"");
+	auto const bson = bobl::bson::encode(types);
+	auto begin = bson.data();
+	auto end = begin + bson.size();
+	auto cbor = bobl::transcode<bobl::bson::NsTag, bobl::cbor::NsTag>(begin, end);
+	BOOST_CHECK_EQUAL(begin, end);
+	auto cbegin = cbor.data();
+	auto res = bobl::cbor::decode<SupportedTypes>(cbegin, cbor.data() + cbor.size());
+	BOOST_CHECK_EQUAL(cbegin, cbor.data() + cbor.size());
+	check(res, types);
+
+	// and back, BSON writer picks the same representation as bson::encode
+	cbegin = cbor.data();
+	auto back = std::vector<std::uint8_t>{};
+	bobl::transcode<bobl::cbor::NsTag, bobl::bson::NsTag>(cbegin, cbor.data() + cbor.size(), back);
+	BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(back), std::end(back), std::begin(bson), std::end(bson));
+}
+
+BOOST_AUTO_TEST_CASE(CborToBsonTest)
+{
+	auto const types = supported_types("some \"name\"");
+	auto const cbor = bobl::cbor::encode(types);
+	auto begin = cbor.data();
+	auto end = begin + cbor.size();
+	auto bson = bobl::transcode<bobl::cbor::NsTag, bobl::bson::NsTag>(begin, end);
+	BOOST_CHECK_EQUAL(begin, end);
+	auto bbegin = bson.data();
+	auto res = bobl::bson::decode<SupportedTypes>(bbegin, bson.data() + bson.size());
+	check(res, types);
+}
+
+BOOST_AUTO_TEST_CASE(JsonTest)
+{
+	auto const json = std::string{ R"({"enabled" : true, "id" : -100, "name" : "the \"name\" é", "theEnum" : 2, "values" : [1.5, null, {}, []]})" };
+	auto begin = json.data();
+	auto cbor = bobl::transcode<bobl::json::NsTag, bobl::cbor::NsTag>(begin, json.data() + json.size());
+	auto cbegin = cbor.data();
+	auto simple = bobl::cbor::decode<Simple>(cbegin, cbor.data() + cbor.size());
+	BOOST_CHECK_EQUAL(simple.enabled, true);
+	BOOST_CHECK_EQUAL(simple.id, -100);
+	BOOST_CHECK_EQUAL(simple.name, "the \"name\" \xc3\xa9");
+	BOOST_CHECK_EQUAL(simple.theEnum, Two);
+	// doubles out of float range are kept in 8 bytes, the ones float holds exactly in 4
+	auto const numbers = std::string{ "[1e300, 0.5, -1e39]" };
+	begin = numbers.data();
+	auto doubles = bobl::transcode<bobl::json::NsTag, bobl::cbor::NsTag>(begin, numbers.data() + numbers.size());
+	BOOST_CHECK_EQUAL(doubles.size(), 1 + 9 + 5 + 9);
+	cbegin = doubles.data();
+	auto const values = bobl::cbor::decode<std::vector<double>>(cbegin, doubles.data() + doubles.size());
+	BOOST_REQUIRE_EQUAL(values.size(), 3);
+	BOOST_CHECK_EQUAL(values[0], 1e300);
+	BOOST_CHECK_EQUAL(values[1], 0.5);
+	BOOST_CHECK_EQUAL(values[2], -1e39);
+
+	cbegin = cbor.data();
+	auto text = std::string{};
+	bobl::transcode<bobl::cbor::NsTag, bobl::json::NsTag>(cbegin, cbor.data() + cbor.size(), text);
+	BOOST_CHECK_EQUAL(text, "{\"enabled\":true,\"id\":-100,\"name\":\"the \\\"name\\\" \xc3\xa9\",\"theEnum\":2,\"values\":[1.5,null,{},[]]}");
+
+	auto const types = supported_types("some \"name\"");
+	auto const bson = bobl::bson::encode(types);
+	auto bbegin = bson.data();
+	text.clear();
+	bobl::transcode<bobl::bson::NsTag, bobl::json::NsTag>(bbegin, bson.data() + bson.size(), text);
+	BOOST_CHECK(text.find(R"("uuid":"4e983010-fa64-4baa-abed-dd82fd691d18","enm":3,"binary":"AQID","tp":")") != std::string::npos);
+
+	auto const bsimple = bobl::bson::encode(types.simple);
+	bbegin = bsimple.data();
+	text.clear();
+	bobl::transcode<bobl::bson::NsTag, bobl::json::NsTag>(bbegin, bsimple.data() + bsimple.size(), text);
+	BOOST_CHECK_EQUAL(text, R"({"enabled":false,"id":303,"name":"the name","theEnum":1})");
+	auto tbegin = text.data();
+	simple = bobl::json::decode<Simple>(tbegin, text.data() + text.size());
+	BOOST_CHECK_EQUAL(simple.id, 303);
+	BOOST_CHECK_EQUAL(simple.name, "the name");
+}
+
+BOOST_AUTO_TEST_CASE(InvalidTest)
+{
+	using Vector = std::vector<std::uint8_t>;
+	std::uint8_t const data[] = { 0x82, 0x01 };	// array of 2 with one item
+	auto begin = data;
+	BOOST_CHECK_THROW((bobl::transcode<bobl::cbor::NsTag, bobl::cbor::NsTag>(begin, data + sizeof(data))), bobl::InputToShort);
+	// BSON document root has to be an object
+	std::uint8_t const scalar[] = { 0x01 };
+	begin = scalar;
+	auto bson = Vector{};
+	BOOST_CHECK_THROW((bobl::transcode<bobl::cbor::NsTag, bobl::bson::NsTag>(begin, scalar + sizeof(scalar), bson)), bobl::TypeNotSupported);
+	// 1(2^63 - 1) seconds can't be held in milliseconds
+	std::uint8_t const time[] = { 0xc1, 0x1b, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+	begin = time;
+	auto text = std::string{};
+	BOOST_CHECK_THROW((bobl::transcode<bobl::cbor::NsTag, bobl::json::NsTag>(begin, time + sizeof(time), text)), bobl::Overflow);
+	// undefined is transcoded as null
+	std::uint8_t const undefined[] = { 0x81, 0xf7 };
+	begin = undefined;
+	bobl::transcode<bobl::cbor::NsTag, bobl::json::NsTag>(begin, undefined + sizeof(undefined), text);
+	BOOST_CHECK_EQUAL(text, "[null]");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,111 @@
+#include <boost/test/unit_test.hpp>
+#include "bobl/utility/utf8.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/cbor/decode.hpp"
+#include "bobl/bson/encode.hpp"
+#include "bobl/bson/decode.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/fusion/include/adapt_struct.hpp>
+#include <string>
+#include <cstdint>
+
+namespace {
+
+struct Text
+{
+	std::string text;
+};
+
+} /*namespace*/
+
+BOOST_FUSION_ADAPT_STRUCT(
+	Text,
+	text)
+
+BOOST_AUTO_TEST_SUITE(BOBL_Utf8_TestSuite)
+
+bool valid(std::string const& value) { return bobl::utility::utf8::valid(value.data(), value.size()); }
+
+BOOST_AUTO_TEST_CASE(Utf8ValidTest)
+{
+	BOOST_CHECK(valid(""));
+	BOOST_CHECK(valid("plain ASCII text"));
+	BOOST_CHECK(valid("\x7f"));
+	BOOST_CHECK(valid("\xc2\x80 \xdf\xbf"));				// U+0080, U+07FF
+	BOOST_CHECK(valid("\xe0\xa0\x80 \xed\x9f\xbf \xee\x80\x80 \xef\xbf\xbf")); // U+0800, U+D7FF, U+E000, U+FFFF
+	BOOST_CHECK(valid("\xf0\x90\x80\x80 \xf4\x8f\xbf\xbf"));	// U+10000, U+10FFFF
+	BOOST_CHECK(valid("\xd0\xbf\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \xe4\xbd\xa0\xe5\xa5\xbd \xf0\x9f\x98\x80"));
+}
+
+BOOST_AUTO_TEST_CASE(Utf8InvalidTest)
+{
+	BOOST_CHECK(!valid("\x80"));					// continuation without lead
+	BOOST_CHECK(!valid("\xc0\xaf"));				// overlong '/'
+	BOOST_CHECK(!valid("\xc1\xbf"));
+	BOOST_CHECK(!valid("\xe0\x9f\xbf"));			// overlong U+07FF
+	BOOST_CHECK(!valid("\xf0\x8f\xbf\xbf"));		// overlong U+FFFF
+	BOOST_CHECK(!valid("\xed\xa0\x80"));			// surrogate U+D800
+	BOOST_CHECK(!valid("\xed\xbf\xbf"));			// surrogate U+DFFF
+	BOOST_CHECK(!valid("\xf4\x90\x80\x80"));		// U+110000
+	BOOST_CHECK(!valid("\xf5\x80\x80\x80"));
+	BOOST_CHECK(!valid("\xff"));
+	BOOST_CHECK(!valid("\xc2"));					// truncated
+	BOOST_CHECK(!valid("\xe4\xbd"));
+	BOOST_CHECK(!valid("\xf0\x9f\x98"));
+	BOOST_CHECK(!valid("\xe4\x41\xa0"));			// ASCII instead of continuation
+	BOOST_CHECK(!valid("\xf0\x9f\x28\x80"));
+}
+
+BOOST_AUTO_TEST_CASE(Utf8AsciiRunTest)
+{
+	// invalid byte at every position of ASCII runs longer than both SIMD and SWAR blocks
+	for (std::size_t size = 1; size != 40; ++size)
+	{
+		auto value = std::string(size, 'a');
+		BOOST_CHECK(valid(value));
+		for (std::size_t i = 0; i != size; ++i)
+		{
+			auto invalid = value;
+			invalid[i] = '\x80';
+			auto begin = reinterpret_cast<std::uint8_t const*>(invalid.data());
+			BOOST_CHECK_EQUAL(bobl::utility::utf8::find_invalid(begin, begin + invalid.size()) - begin, std::ptrdiff_t(i));
+			// valid sequence is skipped as a whole
+			invalid.replace(i, 1, "\xe2\x82\xac");
+			BOOST_CHECK(valid(invalid));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(CborValidateUtf8Test)
+{
+	using Options = bobl::Options<bobl::options::ValidateUtf8>;
+	auto const invalid = std::string{ "ab\xed\xa0\x80" };
+	auto const data = bobl::cbor::encode(invalid);
+	auto begin = data.data();
+	BOOST_CHECK_EQUAL(bobl::cbor::decode<std::string>(begin, data.data() + data.size()), invalid);
+	begin = data.data();
+	BOOST_CHECK_THROW((bobl::cbor::decode<std::string, Options>(begin, data.data() + data.size())), bobl::InvalidObject);
+	BOOST_CHECK_THROW(bobl::cbor::encode<Options>(invalid), bobl::InvalidObject);
+	auto const text = std::string{ "\xe2\x82\xac 10" };
+	auto const encoded = bobl::cbor::encode<Options>(text);
+	begin = encoded.data();
+	BOOST_CHECK_EQUAL((bobl::cbor::decode<std::string, Options>(begin, encoded.data() + encoded.size())), text);
+}
+
+BOOST_AUTO_TEST_CASE(BsonValidateUtf8Test)
+{
+	using Options = bobl::Options<bobl::options::ValidateUtf8>;
+	auto const invalid = Text{ "ab\xc0\xaf" };
+	auto const data = bobl::bson::encode(invalid);
+	auto begin = data.data();
+	BOOST_CHECK_EQUAL(bobl::bson::decode<Text>(begin, data.data() + data.size()).text, invalid.text);
+	begin = data.data();
+	BOOST_CHECK_THROW((bobl::bson::decode<Text, Options>(begin, data.data() + data.size())), bobl::InvalidObject);
+	BOOST_CHECK_THROW(bobl::bson::encode<Options>(invalid), bobl::InvalidObject);
+	auto const text = Text{ "\xf0\x9f\x98\x80" };
+	auto const encoded = bobl::bson::encode<Options>(text);
+	begin = encoded.data();
+	BOOST_CHECK_EQUAL((bobl::bson::decode<Text, Options>(begin, encoded.data() + encoded.size()).text), text.text);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
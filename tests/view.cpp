@@ -0,0 +1,78 @@
+#include <boost/test/unit_test.hpp>
+#include "tests.hpp"
+#include "bobl/bson/view.hpp"
+#include "bobl/bson/encode.hpp"
+#include "bobl/cbor/view.hpp"
+#include "bobl/cbor/encode.hpp"
+#include "bobl/bobl.hpp"
+#include <boost/uuid/uuid_io.hpp>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+
+BOOST_AUTO_TEST_SUITE(BOBL_View_TestSuite)
+
+template<typename View>
+void check(View const& view, SupportedTypes const& types)
+{
+	// start from the last member, everything before it gets cached on the way
+	BOOST_CHECK(view.template get<10>() == types.tp);
+	BOOST_CHECK_EQUAL(view.template get<2>(), types.name);
+	BOOST_CHECK_EQUAL(view.template get<0>(), types.enabled);
+	BOOST_CHECK_EQUAL(view.get(&SupportedTypes::uuid), types.uuid);
+	BOOST_CHECK_EQUAL(view.get(&SupportedTypes::id), types.id);
+	BOOST_CHECK(view.get(&SupportedTypes::enm) == types.enm);
+	auto simples = view.get(&SupportedTypes::simples);
+	BOOST_REQUIRE_EQUAL(simples.size(), types.simples.size());
+	BOOST_CHECK_EQUAL(simples[1].name, types.simples[1].name);
+	auto simple = view.template get<3>();
+	BOOST_CHECK_EQUAL(simple.id, types.simple.id);
+	BOOST_CHECK_EQUAL(simple.name, types.simple.name);
+	auto ints = view.get(&SupportedTypes::ints);
+	BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(ints), std::end(ints), std::begin(types.ints), std::end(types.ints));
+#if __cplusplus >= 201703L
+	BOOST_CHECK_EQUAL(view.template get<&SupportedTypes::name>(), types.name);
+	auto binary = view.template get<&SupportedTypes::binary>();
+	BOOST_CHECK_EQUAL_COLLECTIONS(std::begin(binary), std::end(binary), std::begin(types.binary), std::end(types.binary));
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(BsonViewTest)
+{
+	auto const types = supported_types();
+	auto const data = bobl::bson::encode(types);
+	auto view = bobl::bson::view<SupportedTypes>(data.data(), data.data() + data.size());
+	check(view, types);
+}
+
+BOOST_AUTO_TEST_CASE(CborViewTest)
+{
+	auto const types = supported_types();
+	auto const data = bobl::cbor::encode(types);
+	auto view = bobl::cbor::view<SupportedTypes>(data.data(), data.data() + data.size());
+	check(view, types);
+}
+
+BOOST_AUTO_TEST_CASE(MissingMemberTest)
+{
+	auto const simple = Simple{ true, 7, "seven", Enum::Two };
+	auto const bson = bobl::bson::encode(simple);
+	auto bview = bobl::bson::view<SimpleOptional>(bson.data(), bson.data() + bson.size());
+	BOOST_CHECK(!bview.get(&SimpleOptional::dummy3));
+	BOOST_CHECK(bview.get(&SimpleOptional::name) == std::string{ "seven" });
+	BOOST_CHECK(!bview.get<4>());
+	BOOST_CHECK(bview.get(&SimpleOptional::theEnum) == EnumClass::Two);
+	auto strict = bobl::bson::view<SimpleOptional, bobl::Options<bobl::options::ExacMatch>>(bson.data(), bson.data() + bson.size());
+	BOOST_CHECK(strict.get<1>() == 7);
+	BOOST_CHECK_THROW(strict.get<5>(), bobl::InvalidObject);
+
+	auto const cbor = bobl::cbor::encode(simple);
+	auto cview = bobl::cbor::view<SimpleOptional>(cbor.data(), cbor.data() + cbor.size());
+	BOOST_CHECK(!cview.get(&SimpleOptional::dummy1));
+	BOOST_CHECK(cview.get<1>() == 7);
+	BOOST_CHECK(cview.get(&SimpleOptional::enabled) == true);
+}
+
+BOOST_AUTO_TEST_SUITE_END()